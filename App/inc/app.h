@@ -11,3 +11,8 @@
 /// @brief Initializes the device application. This function will initialize all services.
 ///        This function must be called before starting the scheduler.
 void app_init();
+
+/// @brief Last words of a halted system: dumps the flight recorder over the log UART (decode it with
+///        `Tools/recorder/recorder.py`). Called by `configASSERT()` and by the HardFault handler, with interrupts
+///        disabled. Returns so the caller can halt.
+void app_fault(void);
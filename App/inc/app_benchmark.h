@@ -0,0 +1,25 @@
+#pragma once
+
+/// | Includes ------------------------------------------------------------------
+/// | Exported types ------------------------------------------------------------
+/// | Exported data -------------------------------------------------------------
+/// | Exported constants --------------------------------------------------------
+
+/// @brief Set to 1 to spawn the benchmark task during `app_init()`. Results are printed on the SWV console.
+#define APP_BENCHMARK_ENABLED 0
+
+/// | Exported macro ------------------------------------------------------------
+
+/// | Exported functions --------------------------------------------------------
+
+/// @brief Create the AOs and the kernel used by the benchmarks. Like every AO, they must exist before the scheduler
+///        starts, so this function is called from `app_init()`.
+void benchmark_init();
+
+/// @brief Compare native tasks against coroutines (SVC_coro.hpp): RAM, and cost of a switch between two of them.
+///        Implemented in app_benchmark_coro.cpp, and called by `task_benchmark()`.
+void benchmark_coroutines();
+
+/// @brief Benchmark task. It runs every benchmark once, prints the results and then deletes itself.
+/// @param parameters Unused.
+void task_benchmark(void* parameters);
@@ -0,0 +1,24 @@
+#pragma once
+
+/// | Includes ------------------------------------------------------------------
+
+#include "HAL_uart.h"
+
+/// | Exported types ------------------------------------------------------------
+/// | Exported data -------------------------------------------------------------
+/// | Exported constants --------------------------------------------------------
+
+/// @brief Set to 1 to accept single character debug commands on the RX line of the log UART (send 'h' for the list).
+///        Reports are printed on the SWV console, so they never mix with the log stream. Needs LOG_ENABLED, since the
+///        log is the one initializing the UART.
+#define APP_CONSOLE_ENABLED 1
+
+/// | Exported macro ------------------------------------------------------------
+
+/// | Exported functions --------------------------------------------------------
+
+/// @brief Start polling a UART for debug commands. Reports that are too slow for the event paths (trace histograms,
+///        AO metrics...) are only printed from here, on demand. This function must be called before starting the
+///        scheduler, once the UART is initialized.
+/// @param instance UART instance whose RX line carries the commands.
+void console_init(const UARTInstance instance);
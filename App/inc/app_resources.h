@@ -5,22 +5,22 @@
 #include <FreeRTOS.h>
 #include <task.h>
 
-#include "HAL_button.h"
+#include "SVC_button.h"
 #include "SVC_led.h"
+#include "SVC_log.h"
+#include "SVC_lz.h"
 
 /// | Exported types ------------------------------------------------------------
-
-/// @brief Struct that represents the data consumed by the button service
-typedef struct
-{
-    BoardButtons button;
-} ButtonTaskData;
-
 /// | Exported data -------------------------------------------------------------
 
-extern TaskHandle_t button_task_handle;
-extern LEDActiveObject ao_led;
+// The LED and button AOs live in SVC_led_ao.cpp and SVC_button_ao.cpp: reach them through `led_ao()` and `button_ao()`
+
+/// @brief Compression stage of the log sink. Only defined when LOG_ENABLED and LOG_COMPRESSION_ENABLED are set.
+extern LzEncoder log_compressor;
 
 /// | Exported constants --------------------------------------------------------
+
+/// @brief Set to 0 to ship the log uncompressed. When set, read the log with `log_decode.py --lz`.
+#define LOG_COMPRESSION_ENABLED 1
 /// | Exported macro ------------------------------------------------------------
 /// | Exported functions --------------------------------------------------------
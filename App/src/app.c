@@ -1,48 +1,219 @@
-#include <stdio.h>
-
 #include "app.h"
+#include "app_benchmark.h"
+#include "app_console.h"
 #include "app_resources.h"
 
+#include "HAL_cycles.h"
+#include "HAL_uart.h"
+#include "SVC_ao_qset.h"
+#include "SVC_event_pool.h"
+#include "SVC_format.h"
+#include "SVC_log.h"
 #include "SVC_led.h"
 #include "SVC_button.h"
+#include "SVC_pubsub.h"
+#include "SVC_recorder.h"
+#include "SVC_time_event.h"
 
 /// | Private typedef -----------------------------------------------------------
 /// | Private define ------------------------------------------------------------
+
+#if LOG_ENABLED
+// Log records are shipped over USART3 by the lowest priority task, so logging never competes with the services
+#define LOG_UART UART_INSTANCE_1
+#define LOG_UART_TIMEOUT_MS 100
+#define LOG_DRAIN_STACK_DEPTH (2 * configMINIMAL_STACK_SIZE)
+#define LOG_DRAIN_PERIOD_MS 50
+#endif
+
+// The coroutine debouncer runs on an executor of its own
+#define BUTTON_HOSTED (BUTTON_AO_QUEUE_SET_HOSTED && !BUTTON_CORO)
+#define SERVICE_HOST_ENABLED (LED_AO_QUEUE_SET_HOSTED || BUTTON_HOSTED)
+
+#if SERVICE_HOST_ENABLED
+// Low-rate services share a single task: its set must fit every queue of every hosted AO
+#define SERVICE_HOST_LENGTH ((LED_AO_QUEUE_SET_HOSTED ? (LED_AO_QUEUE_LENGTH + LED_AO_URGENT_QUEUE_LENGTH) : 0) + \
+                             (BUTTON_HOSTED ? BUTTON_AO_QUEUE_LENGTH : 0))
+#define SERVICE_HOST_STACK_DEPTH (2 * configMINIMAL_STACK_SIZE)
+#define SERVICE_HOST_PRIORITY (LED_AO_PRIORITY > BUTTON_AO_PRIORITY ? LED_AO_PRIORITY : BUTTON_AO_PRIORITY)
+#endif
+
 /// | Private macro -------------------------------------------------------------
 /// | Private function prototypes -----------------------------------------------
+
+#if LOG_ENABLED
+/// @brief Log sink: ship a frame over the log UART.
+static void log_sink_uart(const uint8_t* data, const size_t size);
+#endif
+
+#if LOG_ENABLED && LOG_COMPRESSION_ENABLED
+/// @brief Log sink: compress the frames on their way to `log_sink_uart()`.
+static void log_sink_compressed(const uint8_t* data, const size_t size);
+
+/// @brief End of a burst of log frames: push the compressed stream out.
+static void log_flush_compressed();
+#endif
+
 /// | Private variables ---------------------------------------------------------
-/// | Exported variables -------------------------------------------------------
 
-// Data passed to future tasks. TODO: List available tasks inside an enum so we don't hardcode the indices
-static const ButtonTaskData BUTTON_TASK_DATA_ARRAY[1] =
-{
-    [0] = {
-            .button = USER_BUTTON,
-          },
-};
+#if LOG_ENABLED && RECORDER_ENABLED
+/// @brief Set once the log UART can carry the fault dump.
+static bool fault_dump_ready = false;
+#endif
+
+#if LOG_ENABLED
+static StackType_t log_drain_stack[LOG_DRAIN_STACK_DEPTH];
+static StaticTask_t log_drain_task_buffer;
+#endif
+
+#if SERVICE_HOST_ENABLED
+static AOQueueSet service_host;
+static uint8_t service_host_storage[AO_QSET_STORAGE_SIZE(SERVICE_HOST_LENGTH)];
+static StackType_t service_host_stack[SERVICE_HOST_STACK_DEPTH];
+static StaticTask_t service_host_task_buffer;
+#endif
 
 /// | Exported variables --------------------------------------------------------
-TaskHandle_t button_task_handle;
-LEDActiveObject ao_led;
+#if LOG_ENABLED && LOG_COMPRESSION_ENABLED
+LzEncoder log_compressor;
+#endif
 
 /// | Private functions ---------------------------------------------------------
 
+#if LOG_ENABLED
+static void log_sink_uart(const uint8_t* data, const size_t size)
+{
+    uart_send_blocking(LOG_UART, data, size, LOG_UART_TIMEOUT_MS);
+}
+#endif
+
+#if LOG_ENABLED && LOG_COMPRESSION_ENABLED
+static void log_sink_compressed(const uint8_t* data, const size_t size)
+{
+    lz_encoder_write(&log_compressor, data, size);
+}
+
+static void log_flush_compressed()
+{
+    lz_encoder_flush(&log_compressor);
+}
+#endif
+
+void app_fault(void)
+{
+#if LOG_ENABLED && RECORDER_ENABLED
+    // An assertion failing within the dump lands here again
+    static bool dumping = false;
+
+    if (fault_dump_ready && !dumping) {
+        dumping = true;
+        recorder_dump_halted(LOG_UART);
+    }
+#endif
+}
+
 void app_init()
 {
-    BaseType_t ret;
+    format_printf("Main application starts here\n");
+
+    // Cycle counter used for measuring dispatch times
+    cycles_init();
 
-    printf("Main application starts here\n");
+#if LOG_ENABLED
+    UARTConfig log_uart_config =
+    {
+        .instance = LOG_UART,
+        .baudrate = BAUD_115200,
+        .data_bits = DATA_BITS_8,
+        .stop_bits = STOP_BITS_1,
+        .parity = PARITY_NONE,
+    };
+    const bool LOG_UART_READY = uart_init(&log_uart_config);
+    configASSERT(LOG_UART_READY);
+#if RECORDER_ENABLED
+    fault_dump_ready = true;
+#endif
+
+#if LOG_COMPRESSION_ENABLED
+    // Deferred records are already small, but they repeat a lot: the compressor about halves the UART time
+    lz_encoder_initialize(&log_compressor, log_sink_uart);
+#endif
+
+    const LogConfig LOG_CONFIG =
+    {
+#if LOG_COMPRESSION_ENABLED
+        .sink = log_sink_compressed,
+        .flush = log_flush_compressed,
+#else
+        .sink = log_sink_uart,
+#endif
+        .stack_depth = LOG_DRAIN_STACK_DEPTH,
+        .stack = log_drain_stack,
+        .task_buffer = &log_drain_task_buffer,
+        .priority = tskIDLE_PRIORITY,
+        .period_ms = LOG_DRAIN_PERIOD_MS,
+    };
+    log_initialize(&LOG_CONFIG);
+
+#if APP_CONSOLE_ENABLED
+    // Debug reports are requested over the RX line of the log UART, which the log leaves unused
+    console_init(LOG_UART);
+#endif
+#endif
+
+    // Initialize the event pools before any service is able to post events
+    event_pool_init();
+
+    // Timeouts for every AO are driven by a single timing wheel
+    time_event_init();
+
+    // The LED and button AOs share a single task: the host must exist before they attach to it
+#if SERVICE_HOST_ENABLED
+    const AOQueueSetConfig SERVICE_HOST_CONFIG =
+    {
+        .name = "Service Host",
+        .stack_depth = SERVICE_HOST_STACK_DEPTH,
+        .stack = service_host_stack,
+        .task_buffer = &service_host_task_buffer,
+        .priority = SERVICE_HOST_PRIORITY,
+        .policy = AO_QSET_EDF,
+        .length = SERVICE_HOST_LENGTH,
+        .storage = service_host_storage,
+    };
+    ao_qset_initialize(&service_host, &SERVICE_HOST_CONFIG);
+#endif
 
     // Initialize LED Active Object
-    led_initialize_ao(&ao_led, "ao_led");
+#if LED_AO_QUEUE_SET_HOSTED
+    AOQueueSet* const LED_HOST = &service_host;
+#else
+    AOQueueSet* const LED_HOST = NULL;
+#endif
+
+    led_initialize_ao("ao_led", LED_HOST);
+    pubsub_subscribe(TOPIC_LED, led_ao());
+
+#if BUTTON_CORO
+    // Same debouncer, written as a coroutine
+    button_coro_init(USER_BUTTON);
+#else
+    // Initialize Button Active Object. Its debounce and gesture timeouts are time events.
+#if BUTTON_HOSTED
+    button_initialize_ao("ao_button", USER_BUTTON, &service_host);
+#else
+    button_initialize_ao("ao_button", USER_BUTTON, NULL);
+#endif
+#endif
 
-    // Create button task
-    ret = xTaskCreate(
-            task_button,
-            "Task Button",
+#if APP_BENCHMARK_ENABLED
+    benchmark_init();
+    const BaseType_t ret = xTaskCreate(
+            task_benchmark,
+            "Task Benchmark",
             (2 * configMINIMAL_STACK_SIZE),
-            (void*) &BUTTON_TASK_DATA_ARRAY[0],
+            NULL,
             (tskIDLE_PRIORITY + 1UL),
-            &button_task_handle);
+            NULL);
     configASSERT(ret == pdPASS);
+#endif
 }
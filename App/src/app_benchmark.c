@@ -0,0 +1,517 @@
+#include <reent.h>
+#include <stdio.h> // newlib's snprintf(), only as the reference of the formatter benchmark
+
+#include "FreeRTOS.h"
+#include "message_buffer.h"
+#include "queue.h"
+#include "task.h"
+
+#include "app_benchmark.h"
+#include "app_resources.h"
+
+#if APP_BENCHMARK_ENABLED
+
+#include "HAL_cycles.h"
+#include "SVC_ao.h"
+#include "SVC_ao_kernel.h"
+#include "SVC_ao_metrics.h"
+#include "SVC_event_pool.h"
+#include "SVC_format.h"
+#include "SVC_led.h"
+#include "SVC_log.h"
+#include "SVC_lz.h"
+#include "SVC_msg_channel.h"
+
+/// | Private typedef -----------------------------------------------------------
+
+/// @brief Event used for measuring the post -> dispatch latency of an AO.
+typedef struct
+{
+    uint32_t posted_at; ///< Cycle counter value right before posting.
+} BenchmarkEvent;
+
+/// @brief snprintf() or one of its replacements.
+typedef int (*benchmark_formatter_t)(char* buffer, size_t size, const char* format, ...);
+
+/// @brief A formatter under test, and what was measured on it.
+typedef struct
+{
+    const char* name;                ///< Printed name.
+    benchmark_formatter_t formatter; ///< Formatter under test.
+    uint32_t cycles;                 ///< Total cycles of BENCHMARK_ITERATIONS lines.
+    size_t stack_used;               ///< Peak stack of the formatting task, in bytes.
+} BenchmarkFormatter;
+
+/// | Private define ------------------------------------------------------------
+
+#define BENCHMARK_ITERATIONS 1000
+
+#define BENCHMARK_AO_QUEUE_LENGTH 4
+#define BENCHMARK_AO_STACK_DEPTH (2 * configMINIMAL_STACK_SIZE)
+#define BENCHMARK_AO_PRIORITY (tskIDLE_PRIORITY + 2UL) // Above the benchmark task, so every post preempts it
+#define BENCHMARK_AOS_PROJECTED 16                     // Amount of AOs used for projecting the RAM usage
+
+#define BENCHMARK_MESSAGE_SIZE 256
+#define BENCHMARK_MESSAGES_IN_FLIGHT 4
+#define BENCHMARK_CHANNEL_SIZE (BENCHMARK_MESSAGE_SIZE * BENCHMARK_MESSAGES_IN_FLIGHT)
+
+#define BENCHMARK_LOG_BURSTS 32
+#define BENCHMARK_LOG_BURST_RECORDS 8 // A few records per task ring and drain period, so none is dropped
+#define BENCHMARK_LOG_SETTLE_MS 200   // Long enough for the drain task to ship a burst
+
+#define BENCHMARK_FORMAT_STACK_DEPTH 512 // Words. Room for newlib's formatter too: the stack use is measured.
+#define BENCHMARK_FORMAT_PRIORITY (tskIDLE_PRIORITY + 2UL)
+#define BENCHMARK_FORMAT_LINE_SIZE 128
+
+/// | Private macro -------------------------------------------------------------
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Compare the cycles spent on a post + dispatch of a LEDEvent when it is copied into the queue storage,
+///        when it is passed as a pointer to an event pool block, and when it is passed as a pointer to a heap block.
+///        Both ends run on the same task, so the numbers only account for the transport (no context switch).
+static void benchmark_led_event_transport();
+
+/// @brief Compare an AO that owns its task against an AO hosted by a cooperative kernel: RAM per AO, and latency
+///        from the post until the dispatch handler runs (including the context switch).
+static void benchmark_ao_kernel();
+
+/// @brief Compare the post -> dispatch latency of the queue transport against the task notification transports, for
+///        events that fit in 32 bits. Must run after `benchmark_ao_kernel()`, which initializes the queue AO.
+static void benchmark_ao_transport();
+
+/// @brief Compare the cycles spent on moving a BENCHMARK_MESSAGE_SIZE bytes message through a FreeRTOS message buffer
+///        (copied in by the producer and out by the consumer) against a message channel (built in place and read in
+///        place). Both ends run on the same task, so the numbers only account for the transport.
+static void benchmark_message_channel();
+
+/// @brief Compare the reentrant formatter against newlib's snprintf(): cycles per line and peak stack, formatting an
+///        AO metrics line (strings, widths, longs), and the RAM newlib's reentrancy takes in every task.
+static void benchmark_formatter();
+
+/// @brief Formatting task of `benchmark_formatter()`. It runs on a fresh stack, so its high-water mark only accounts
+///        for the formatter. Suspends itself when done.
+/// @param parameters BenchmarkFormatter under test.
+static void benchmark_format_task(void* parameters);
+
+/// @brief Measure the compression ratio and the cycles per byte of the log compressor on real log traffic: records
+///        like the ones of the application go through the whole pipeline (rings, drain task, compressor, UART).
+static void benchmark_log_compression();
+
+/// @brief Measure the post -> dispatch latency of an AO.
+/// @param ao AO to be measured. Its dispatch handler must be `benchmark_latency_dispatch()`.
+/// @param max Where the maximum latency will be stored.
+/// @return Average latency, in cycles.
+static uint32_t benchmark_ao_latency(ActiveObject* ao, uint32_t* const max);
+
+/// @brief Dispatch handler of the benchmark AOs. Accumulates the latency of every BenchmarkEvent.
+static void benchmark_latency_dispatch(ActiveObject* ao, const void* event);
+
+/// | Private variables ---------------------------------------------------------
+
+/// @brief Sink for the dispatched events, so the compiler can not optimize the reads away.
+static volatile uint32_t benchmark_sink;
+
+static uint32_t latency_total;
+static uint32_t latency_max;
+
+static ActiveObject task_ao;
+static uint8_t task_ao_queue_storage[AO_QUEUE_STORAGE_SIZE(sizeof(BenchmarkEvent), BENCHMARK_AO_QUEUE_LENGTH)];
+static StackType_t task_ao_stack[BENCHMARK_AO_STACK_DEPTH];
+static StaticTask_t task_ao_task_buffer;
+
+static AOKernel kernel;
+static StackType_t kernel_stack[BENCHMARK_AO_STACK_DEPTH];
+static StaticTask_t kernel_task_buffer;
+static ActiveObject hosted_ao;
+static uint8_t hosted_ao_queue_storage[AO_QUEUE_STORAGE_SIZE(sizeof(BenchmarkEvent), BENCHMARK_AO_QUEUE_LENGTH)];
+
+static uint8_t message_buffer_storage[BENCHMARK_CHANNEL_SIZE + 1];
+static StaticMessageBuffer_t message_buffer_buffer;
+
+static MsgChannel channel;
+static uint8_t channel_storage[BENCHMARK_CHANNEL_SIZE] __attribute__((aligned(MSG_CHANNEL_ALIGNMENT)));
+static uint8_t channel_descriptors_storage[MSG_CHANNEL_DESCRIPTORS_SIZE(BENCHMARK_MESSAGES_IN_FLIGHT)];
+
+/// @brief Message contents, and where the consumer copies them out of the message buffer.
+static uint8_t message_out[BENCHMARK_MESSAGE_SIZE];
+static uint8_t message_in[BENCHMARK_MESSAGE_SIZE];
+
+static ActiveObject notify_value_ao;
+static StackType_t notify_value_ao_stack[BENCHMARK_AO_STACK_DEPTH];
+static StaticTask_t notify_value_ao_task_buffer;
+
+static ActiveObject notify_bits_ao;
+static StackType_t notify_bits_ao_stack[BENCHMARK_AO_STACK_DEPTH];
+static StaticTask_t notify_bits_ao_task_buffer;
+
+static StackType_t format_stack[BENCHMARK_FORMAT_STACK_DEPTH];
+static StaticTask_t format_task_buffer;
+static TaskHandle_t benchmark_task_handle;
+
+/// | Exported variables --------------------------------------------------------
+/// | Private functions ---------------------------------------------------------
+
+static void benchmark_led_event_transport()
+{
+    const LEDEvent EVENT = {.leds = LED_MASK(LED_GREEN), .type = LED_EVENT_TOGGLE};
+    uint32_t cycles_by_value = 0;
+    uint32_t cycles_pool = 0;
+    uint32_t cycles_heap = 0;
+
+    QueueHandle_t value_queue = xQueueCreate(1, sizeof(LEDEvent));
+    QueueHandle_t pointer_queue = xQueueCreate(1, sizeof(LEDEvent*));
+    configASSERT(value_queue && pointer_queue);
+
+    for (size_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        LEDEvent received;
+        const uint32_t START = cycles_now();
+        xQueueSend(value_queue, &EVENT, 0);
+        xQueueReceive(value_queue, &received, 0);
+        benchmark_sink += received.leds;
+        cycles_by_value += cycles_now() - START;
+    }
+
+    for (size_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        LEDEvent* received = NULL;
+        const uint32_t START = cycles_now();
+        LEDEvent* const BLOCK = event_pool_get(sizeof(LEDEvent));
+        *BLOCK = EVENT;
+        xQueueSend(pointer_queue, (void*)(&BLOCK), 0);
+        xQueueReceive(pointer_queue, &received, 0);
+        benchmark_sink += received->leds;
+        event_pool_put(received);
+        cycles_pool += cycles_now() - START;
+    }
+
+    for (size_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        LEDEvent* received = NULL;
+        const uint32_t START = cycles_now();
+        LEDEvent* const BLOCK = pvPortMalloc(sizeof(LEDEvent));
+        *BLOCK = EVENT;
+        xQueueSend(pointer_queue, (void*)(&BLOCK), 0);
+        xQueueReceive(pointer_queue, &received, 0);
+        benchmark_sink += received->leds;
+        vPortFree(received);
+        cycles_heap += cycles_now() - START;
+    }
+
+    vQueueDelete(value_queue);
+    vQueueDelete(pointer_queue);
+
+    format_printf("[%s] LEDEvent post+dispatch (cycles/event):\n", pcTaskGetName(NULL));
+    format_printf("\t> By value:          %lu\n", (unsigned long)(cycles_by_value / BENCHMARK_ITERATIONS));
+    format_printf("\t> Pointer (pool):    %lu\n", (unsigned long)(cycles_pool / BENCHMARK_ITERATIONS));
+    format_printf("\t> Pointer (heap):    %lu\n", (unsigned long)(cycles_heap / BENCHMARK_ITERATIONS));
+}
+
+static void benchmark_message_channel()
+{
+    uint32_t cycles_copy = 0;
+    uint32_t cycles_in_place = 0;
+
+    MessageBufferHandle_t message_buffer = xMessageBufferCreateStatic(
+            sizeof(message_buffer_storage),
+            message_buffer_storage,
+            &message_buffer_buffer);
+    configASSERT(message_buffer);
+
+    const MsgChannelConfig CHANNEL_CONFIG =
+    {
+        .storage = channel_storage,
+        .size = sizeof(channel_storage),
+        .max_messages = BENCHMARK_MESSAGES_IN_FLIGHT,
+        .descriptors_storage = channel_descriptors_storage,
+    };
+    msg_channel_initialize(&channel, &CHANNEL_CONFIG);
+
+    for (size_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        const uint32_t START = cycles_now();
+        // The producer builds its message on a buffer of its own, which is then copied in
+        message_out[0] = (uint8_t) i;
+        xMessageBufferSend(message_buffer, message_out, sizeof(message_out), 0);
+        const size_t LENGTH = xMessageBufferReceive(message_buffer, message_in, sizeof(message_in), 0);
+        benchmark_sink += message_in[0] + LENGTH;
+        cycles_copy += cycles_now() - START;
+    }
+
+    for (size_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        size_t length = 0;
+        const uint32_t START = cycles_now();
+        uint8_t* const SPACE = msg_channel_reserve(&channel, BENCHMARK_MESSAGE_SIZE);
+        SPACE[0] = (uint8_t) i;
+        msg_channel_commit(&channel, BENCHMARK_MESSAGE_SIZE);
+        const uint8_t* const MESSAGE = msg_channel_receive(&channel, &length, 0);
+        benchmark_sink += MESSAGE[0] + length;
+        msg_channel_release(&channel);
+        cycles_in_place += cycles_now() - START;
+    }
+
+    vMessageBufferDelete(message_buffer);
+
+    format_printf("[%s] %d byte message send+receive (cycles/message):\n", pcTaskGetName(NULL), BENCHMARK_MESSAGE_SIZE);
+    format_printf("\t> Message buffer:    %lu\n", (unsigned long)(cycles_copy / BENCHMARK_ITERATIONS));
+    format_printf("\t> Message channel:   %lu\n", (unsigned long)(cycles_in_place / BENCHMARK_ITERATIONS));
+}
+
+static void benchmark_format_task(void* parameters)
+{
+    BenchmarkFormatter* const FORMATTER = parameters;
+    char line[BENCHMARK_FORMAT_LINE_SIZE];
+
+    const uint32_t START = cycles_now();
+    for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        const int LENGTH = FORMATTER->formatter(line, sizeof(line),
+                "%-2u %-16.16s %-4u %-8lu %-8lu %-8lu %2u/%-2u %lu/%lu/%lu %08lx %s\n",
+                (unsigned) (i % 16), "ao_led", 2U, (unsigned long) i, (unsigned long) (i - 1), 0UL, 1U, 4U,
+                (unsigned long) i, 230UL, 5000UL, (unsigned long) (i * 2654435761U), "LED_EVENT_TOGGLE");
+        benchmark_sink += (uint32_t) LENGTH + (uint8_t) line[0];
+    }
+    FORMATTER->cycles = cycles_now() - START;
+    FORMATTER->stack_used = (BENCHMARK_FORMAT_STACK_DEPTH - uxTaskGetStackHighWaterMark(NULL)) * sizeof(StackType_t);
+
+    xTaskNotifyGive(benchmark_task_handle);
+    vTaskSuspend(NULL);
+}
+
+static void benchmark_formatter()
+{
+    BenchmarkFormatter formatters[] =
+    {
+        {.name = "newlib snprintf", .formatter = snprintf},
+        {.name = "format_snprintf", .formatter = format_snprintf},
+    };
+
+    benchmark_task_handle = xTaskGetCurrentTaskHandle();
+
+    for (size_t i = 0; i < sizeof(formatters) / sizeof(formatters[0]); i++) {
+        // The task stays suspended until deleted from here, so its buffers can be used again right away
+        TaskHandle_t task = xTaskCreateStatic(
+                benchmark_format_task,
+                "Format Bench",
+                BENCHMARK_FORMAT_STACK_DEPTH,
+                &formatters[i],
+                BENCHMARK_FORMAT_PRIORITY,
+                format_stack,
+                &format_task_buffer);
+        configASSERT(task);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        vTaskDelete(task);
+    }
+
+    format_printf("[%s] Formatting an AO metrics line (cycles/line, peak stack bytes):\n", pcTaskGetName(NULL));
+    for (size_t i = 0; i < sizeof(formatters) / sizeof(formatters[0]); i++) {
+        format_printf("\t> %-18s %lu, %lu\n", formatters[i].name,
+                (unsigned long)(formatters[i].cycles / BENCHMARK_ITERATIONS), (unsigned long) formatters[i].stack_used);
+    }
+
+    const unsigned long TASKS = (unsigned long) uxTaskGetNumberOfTasks();
+    format_printf("\t> struct _reent:      %lu bytes per task, %lu tasks: %lu bytes %s\n",
+            (unsigned long) sizeof(struct _reent), TASKS, TASKS * (unsigned long) sizeof(struct _reent),
+            configUSE_NEWLIB_REENTRANT ? "spent (APP_NEWLIB_FREE is 0)" : "saved");
+}
+
+static void benchmark_log_compression()
+{
+#if LOG_ENABLED && LOG_COMPRESSION_ENABLED
+    static const char* const EVENTS[] = {"LED_EVENT_ON", "LED_EVENT_OFF", "LED_EVENT_TOGGLE"};
+    LogStats log_before;
+    LzStats before;
+    LogStats log_after;
+    LzStats after;
+
+    // Whatever the application logged so far goes out first, so only the benchmark records are measured
+    vTaskDelay(pdMS_TO_TICKS(BENCHMARK_LOG_SETTLE_MS));
+    log_get_stats(&log_before);
+    lz_encoder_get_stats(&log_compressor, &before);
+
+    for (uint32_t burst = 0; burst < BENCHMARK_LOG_BURSTS; burst++) {
+        for (uint32_t i = 0; i < BENCHMARK_LOG_BURST_RECORDS; i += 4) {
+            LOG_INFO("Detected %s press", (i % 8) ? "LONG" : "SHORT");
+            LOG_INFO("Event Received: %s", EVENTS[(burst + i) % 3]);
+            LOG_INFO("Button Released");
+            LOG_INFO("Burst %lu record %lu", (unsigned long) burst, (unsigned long) i);
+        }
+        vTaskDelay(pdMS_TO_TICKS(BENCHMARK_LOG_SETTLE_MS));
+    }
+
+    // The compressor belongs to the drain task, which is idle by now: its statistics can be read from here
+    log_get_stats(&log_after);
+    lz_encoder_get_stats(&log_compressor, &after);
+
+    const uint32_t BYTES_IN = after.bytes_in - before.bytes_in;
+    const uint32_t BYTES_OUT = after.bytes_out - before.bytes_out;
+    const uint32_t CYCLES = after.cycles - before.cycles;
+    const uint32_t RATIO_X100 = BYTES_OUT ? (100U * BYTES_IN) / BYTES_OUT : 0;
+
+    format_printf("[%s] Log compression, %lu records (%lu dropped):\n", pcTaskGetName(NULL),
+            (unsigned long)(log_after.written - log_before.written),
+            (unsigned long)(log_after.dropped - log_before.dropped));
+    format_printf("\t> Frames:            %lu bytes\n", (unsigned long) BYTES_IN);
+    format_printf("\t> Compressed:        %lu bytes (%lu flushes)\n", (unsigned long) BYTES_OUT,
+            (unsigned long)(after.flushes - before.flushes));
+    format_printf("\t> Ratio:             %lu.%02lu:1\n", (unsigned long)(RATIO_X100 / 100),
+            (unsigned long)(RATIO_X100 % 100));
+    format_printf("\t> Cycles/byte:       %lu\n", (unsigned long)(BYTES_IN ? CYCLES / BYTES_IN : 0));
+#else
+    format_printf("[%s] Log compression: disabled\n", pcTaskGetName(NULL));
+#endif
+}
+
+static void benchmark_latency_dispatch(ActiveObject* ao, const void* event)
+{
+    (void) ao;
+    const uint32_t LATENCY = cycles_now() - ((const BenchmarkEvent*) event)->posted_at;
+
+    latency_total += LATENCY;
+    if (LATENCY > latency_max) {
+        latency_max = LATENCY;
+    }
+}
+
+static uint32_t benchmark_ao_latency(ActiveObject* ao, uint32_t* const max)
+{
+    latency_total = 0;
+    latency_max = 0;
+
+    for (size_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        const BenchmarkEvent EVENT = {.posted_at = cycles_now()};
+        ao_post(ao, &EVENT, portMAX_DELAY);
+    }
+
+    *max = latency_max;
+    return latency_total / BENCHMARK_ITERATIONS;
+}
+
+static void benchmark_ao_kernel()
+{
+    // RAM: an AO that owns its task pays for a TCB (including the newlib reent struct) and a stack. A hosted AO only
+    // pays for its queue, while the kernel pays for a single TCB and stack shared by every hosted AO.
+    const size_t QUEUE_BYTES = sizeof(ActiveObject) + sizeof(task_ao_queue_storage);
+    const size_t TASK_BYTES = sizeof(StaticTask_t) + sizeof(task_ao_stack);
+    const size_t KERNEL_BYTES = sizeof(AOKernel) + sizeof(StaticTask_t) + sizeof(kernel_stack);
+
+    uint32_t task_max;
+    uint32_t hosted_max;
+    const uint32_t TASK_AVG = benchmark_ao_latency(&task_ao, &task_max);
+    const uint32_t HOSTED_AVG = benchmark_ao_latency(&hosted_ao, &hosted_max);
+
+    format_printf("[%s] One task per AO vs cooperative kernel:\n", pcTaskGetName(NULL));
+    format_printf("\t> RAM per AO (bytes):      task %lu, hosted %lu\n",
+            (unsigned long)(QUEUE_BYTES + TASK_BYTES), (unsigned long)QUEUE_BYTES);
+    format_printf("\t> RAM for %d AOs (bytes):  task %lu, hosted %lu\n", BENCHMARK_AOS_PROJECTED,
+            (unsigned long)(BENCHMARK_AOS_PROJECTED * (QUEUE_BYTES + TASK_BYTES)),
+            (unsigned long)(KERNEL_BYTES + BENCHMARK_AOS_PROJECTED * QUEUE_BYTES));
+    format_printf("\t> Post->dispatch (cycles): task avg %lu max %lu, hosted avg %lu max %lu\n",
+            (unsigned long)TASK_AVG, (unsigned long)task_max, (unsigned long)HOSTED_AVG, (unsigned long)hosted_max);
+}
+
+static void benchmark_ao_transport()
+{
+    uint32_t queue_max;
+    uint32_t value_max;
+    uint32_t bits_max;
+    const uint32_t QUEUE_AVG = benchmark_ao_latency(&task_ao, &queue_max);
+    const uint32_t VALUE_AVG = benchmark_ao_latency(&notify_value_ao, &value_max);
+    const uint32_t BITS_AVG = benchmark_ao_latency(&notify_bits_ao, &bits_max);
+
+    format_printf("[%s] Queue vs task notification transport, post->dispatch (cycles):\n", pcTaskGetName(NULL));
+    format_printf("\t> Queue:             avg %lu max %lu\n", (unsigned long)QUEUE_AVG, (unsigned long)queue_max);
+    format_printf("\t> Notify (value):    avg %lu max %lu\n", (unsigned long)VALUE_AVG, (unsigned long)value_max);
+    format_printf("\t> Notify (bits):     avg %lu max %lu\n", (unsigned long)BITS_AVG, (unsigned long)bits_max);
+}
+
+void benchmark_init()
+{
+    const AOConfig TASK_AO_CONFIG =
+    {
+        .name = "Bench Task AO",
+        .dispatch = benchmark_latency_dispatch,
+        .event_size = sizeof(BenchmarkEvent),
+        .queue_length = BENCHMARK_AO_QUEUE_LENGTH,
+        .queue_storage = task_ao_queue_storage,
+        .stack_depth = BENCHMARK_AO_STACK_DEPTH,
+        .stack = task_ao_stack,
+        .task_buffer = &task_ao_task_buffer,
+        .priority = BENCHMARK_AO_PRIORITY,
+        .overflow_policy = AO_OVERFLOW_BLOCK,
+        .block_timeout = portMAX_DELAY,
+    };
+
+    const AOKernelConfig KERNEL_CONFIG =
+    {
+        .name = "Bench Kernel",
+        .stack_depth = BENCHMARK_AO_STACK_DEPTH,
+        .stack = kernel_stack,
+        .task_buffer = &kernel_task_buffer,
+        .priority = BENCHMARK_AO_PRIORITY,
+    };
+
+    const AOConfig HOSTED_AO_CONFIG =
+    {
+        .name = "Bench Hosted AO",
+        .dispatch = benchmark_latency_dispatch,
+        .event_size = sizeof(BenchmarkEvent),
+        .queue_length = BENCHMARK_AO_QUEUE_LENGTH,
+        .queue_storage = hosted_ao_queue_storage,
+        .priority = 0,
+        .kernel = &kernel,
+        .overflow_policy = AO_OVERFLOW_BLOCK,
+        .block_timeout = portMAX_DELAY,
+    };
+
+    const AOConfig NOTIFY_VALUE_AO_CONFIG =
+    {
+        .name = "Bench Notify Value AO",
+        .dispatch = benchmark_latency_dispatch,
+        .transport = AO_TRANSPORT_NOTIFY_VALUE,
+        .event_size = sizeof(BenchmarkEvent),
+        .stack_depth = BENCHMARK_AO_STACK_DEPTH,
+        .stack = notify_value_ao_stack,
+        .task_buffer = &notify_value_ao_task_buffer,
+        .priority = BENCHMARK_AO_PRIORITY,
+    };
+
+    // The timestamps are not bitmasks, but every post preempts the benchmark task and gets dispatched before the
+    // next one, so no bits are ever merged
+    const AOConfig NOTIFY_BITS_AO_CONFIG =
+    {
+        .name = "Bench Notify Bits AO",
+        .dispatch = benchmark_latency_dispatch,
+        .transport = AO_TRANSPORT_NOTIFY_BITS,
+        .event_size = sizeof(BenchmarkEvent),
+        .stack_depth = BENCHMARK_AO_STACK_DEPTH,
+        .stack = notify_bits_ao_stack,
+        .task_buffer = &notify_bits_ao_task_buffer,
+        .priority = BENCHMARK_AO_PRIORITY,
+    };
+
+    // The kernel comes first, since hosted AOs attach to it
+    ao_kernel_initialize(&kernel, &KERNEL_CONFIG);
+    ao_initialize(&task_ao, &TASK_AO_CONFIG);
+    ao_initialize(&hosted_ao, &HOSTED_AO_CONFIG);
+    ao_initialize(&notify_value_ao, &NOTIFY_VALUE_AO_CONFIG);
+    ao_initialize(&notify_bits_ao, &NOTIFY_BITS_AO_CONFIG);
+}
+
+void task_benchmark(void* parameters)
+{
+    (void) parameters;
+
+    format_printf("[%s] Task Created\n", pcTaskGetName(NULL));
+    cycles_init();
+
+    benchmark_formatter();
+    benchmark_led_event_transport();
+    benchmark_message_channel();
+    benchmark_log_compression();
+    benchmark_ao_kernel();
+    benchmark_ao_transport();
+    benchmark_coroutines();
+
+    // Every AO (the application ones included) after the benchmarks, to size queues and priorities from real data
+    ao_metrics_print();
+
+    vTaskDelete(NULL);
+}
+
+#endif // APP_BENCHMARK_ENABLED
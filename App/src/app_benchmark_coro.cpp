@@ -0,0 +1,140 @@
+#include "SVC_coro.hpp"
+
+extern "C" {
+#include "app_benchmark.h"
+
+#include "HAL_cycles.h"
+#include "SVC_format.h"
+}
+
+#if APP_BENCHMARK_ENABLED
+
+/// | Private define ------------------------------------------------------------
+
+#define BENCHMARK_CORO_ROUNDS 1000
+#define BENCHMARK_CORO_STACK_DEPTH (2 * configMINIMAL_STACK_SIZE)
+#define BENCHMARK_CORO_PRIORITY (tskIDLE_PRIORITY + 2UL) // Above the benchmark task, so the ping-pong runs undisturbed
+
+/// | Private variables ---------------------------------------------------------
+
+namespace
+{
+
+/// @brief Two coroutines (ping and pong) on one task.
+using BenchmarkExecutor = svc::coro::Executor<2, BENCHMARK_CORO_STACK_DEPTH, BENCHMARK_CORO_PRIORITY>;
+
+/// @brief As many coroutines as the frame pool can hold, for the RAM projection only.
+using ProjectedExecutor = svc::coro::Executor<CORO_FRAME_SLOTS, BENCHMARK_CORO_STACK_DEPTH, BENCHMARK_CORO_PRIORITY>;
+
+/// @brief RAM of a native task: control block plus stack.
+constexpr std::size_t TASK_BYTES = sizeof(StaticTask_t) + BENCHMARK_CORO_STACK_DEPTH * sizeof(StackType_t);
+
+BenchmarkExecutor executor;
+svc::coro::Signal ping_signal;
+svc::coro::Signal pong_signal;
+
+StackType_t ping_stack[BENCHMARK_CORO_STACK_DEPTH];
+StaticTask_t ping_task_buffer;
+TaskHandle_t ping_task;
+StackType_t pong_stack[BENCHMARK_CORO_STACK_DEPTH];
+StaticTask_t pong_task_buffer;
+TaskHandle_t pong_task;
+
+TaskHandle_t benchmark_task;
+std::uint32_t ping_pong_cycles;
+
+/// | Private functions ---------------------------------------------------------
+
+svc::coro::Task coro_ping()
+{
+    const std::uint32_t START = cycles_now();
+    for (std::size_t i = 0; i < BENCHMARK_CORO_ROUNDS; i++) {
+        pong_signal.set();
+        co_await ping_signal.wait();
+    }
+    ping_pong_cycles = cycles_now() - START;
+    xTaskNotifyGive(benchmark_task);
+}
+
+svc::coro::Task coro_pong()
+{
+    for (std::size_t i = 0; i < BENCHMARK_CORO_ROUNDS; i++) {
+        co_await pong_signal.wait();
+        ping_signal.set();
+    }
+}
+
+void task_ping(void* parameters)
+{
+    (void) parameters;
+
+    const std::uint32_t START = cycles_now();
+    for (std::size_t i = 0; i < BENCHMARK_CORO_ROUNDS; i++) {
+        xTaskNotifyGive(pong_task);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    ping_pong_cycles = cycles_now() - START;
+    xTaskNotifyGive(benchmark_task);
+
+    vTaskDelete(NULL);
+}
+
+void task_pong(void* parameters)
+{
+    (void) parameters;
+
+    for (std::size_t i = 0; i < BENCHMARK_CORO_ROUNDS; i++) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        xTaskNotifyGive(ping_task);
+    }
+
+    vTaskDelete(NULL);
+}
+
+} // namespace
+
+/// | Exported functions --------------------------------------------------------
+
+void benchmark_coroutines()
+{
+    benchmark_task = xTaskGetCurrentTaskHandle();
+
+    // Native tasks: both at the same priority, so every round trip is two context switches through the scheduler.
+    // Nothing runs until both handles are known.
+    vTaskSuspendAll();
+    pong_task = xTaskCreateStatic(task_pong, "Bench Pong", BENCHMARK_CORO_STACK_DEPTH, NULL, BENCHMARK_CORO_PRIORITY,
+                                  pong_stack, &pong_task_buffer);
+    ping_task = xTaskCreateStatic(task_ping, "Bench Ping", BENCHMARK_CORO_STACK_DEPTH, NULL, BENCHMARK_CORO_PRIORITY,
+                                  ping_stack, &ping_task_buffer);
+    configASSERT(ping_task && pong_task);
+    xTaskResumeAll();
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    const std::uint32_t TASK_SWITCH = ping_pong_cycles / (2 * BENCHMARK_CORO_ROUNDS);
+
+    // Coroutines: same ping-pong, but every switch is a resume inside the executor task
+    executor.start("Bench Coro");
+    vTaskSuspendAll();
+    const bool SPAWNED = executor.spawn(coro_ping()) && executor.spawn(coro_pong());
+    configASSERT(SPAWNED && "The ping-pong frames do not fit CORO_FRAME_SIZE");
+    xTaskResumeAll();
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    const std::uint32_t CORO_SWITCH = ping_pong_cycles / (2 * BENCHMARK_CORO_ROUNDS);
+
+    const svc::coro::ExecutorStats STATS = executor.stats();
+    const svc::coro::FramePoolStats POOL = svc::coro::frame_pool.stats();
+
+    format_printf("[%s] Native tasks vs coroutines, %d round trips:\n", pcTaskGetName(NULL), BENCHMARK_CORO_ROUNDS);
+    format_printf("\t> RAM for 2 (bytes):      tasks %lu, coroutines %lu\n",
+            (unsigned long)(2 * TASK_BYTES), (unsigned long)BenchmarkExecutor::ram_bytes());
+    format_printf("\t> RAM for %d (bytes):      tasks %lu, coroutines %lu\n", CORO_FRAME_SLOTS,
+            (unsigned long)(CORO_FRAME_SLOTS * TASK_BYTES), (unsigned long)ProjectedExecutor::ram_bytes());
+    format_printf("\t> Switch (cycles):        tasks %lu, coroutines %lu\n",
+            (unsigned long)TASK_SWITCH, (unsigned long)CORO_SWITCH);
+    format_printf("\t> Resume (cycles):        min %lu avg %lu max %lu (%lu resumes)\n",
+            (unsigned long)STATS.cycles_min, (unsigned long)(STATS.cycles_total / STATS.switches),
+            (unsigned long)STATS.cycles_max, (unsigned long)STATS.switches);
+    format_printf("\t> Frame pool:             %u/%d used at most, %lu failed\n",
+            (unsigned)POOL.used_max, CORO_FRAME_SLOTS, (unsigned long)POOL.failed);
+}
+
+#endif // APP_BENCHMARK_ENABLED
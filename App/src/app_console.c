@@ -0,0 +1,95 @@
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_console.h"
+
+#include "SVC_ao_metrics.h"
+#include "SVC_format.h"
+#include "SVC_recorder.h"
+#include "SVC_trace.h"
+
+/// | Private typedef -----------------------------------------------------------
+
+/// @brief Debug command: a single character and the report it prints.
+typedef struct
+{
+    char key;              ///< Character that runs the command.
+    const char* help;      ///< Printed by the help command.
+    void (*run)();         ///< Command handler. Runs on the console task, at the lowest priority.
+} ConsoleCommand;
+
+/// | Private define ------------------------------------------------------------
+
+#define CONSOLE_STACK_DEPTH (2 * configMINIMAL_STACK_SIZE)
+#define CONSOLE_POLL_PERIOD_MS 100 // A key press, not a data stream: the UART holds the byte until the next poll
+
+/// | Private macro -------------------------------------------------------------
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Console task: poll the UART, and run the command of every received character.
+/// @param parameters UART instance, cast to a pointer.
+static void task_console(void* parameters);
+
+/// @brief Print every available command.
+static void console_help();
+
+/// | Private variables ---------------------------------------------------------
+
+static const ConsoleCommand COMMANDS[] =
+{
+    {'m', "AO metrics", ao_metrics_print},
+#if TRACE_ENABLED
+    {'t', "button -> LED trace histograms", trace_print},
+#endif
+#if RECORDER_ENABLED
+    {'r', "flight recorder dump, for Tools/recorder/recorder.py", recorder_print},
+#endif
+    {'h', "this help", console_help},
+};
+
+static StackType_t console_stack[CONSOLE_STACK_DEPTH];
+static StaticTask_t console_task_buffer;
+
+/// | Private functions ---------------------------------------------------------
+
+static void console_help()
+{
+    format_printf("[%s] Commands:\n", pcTaskGetName(NULL));
+    for (size_t i = 0; i < sizeof(COMMANDS) / sizeof(COMMANDS[0]); i++) {
+        format_printf("\t> %c: %s\n", COMMANDS[i].key, COMMANDS[i].help);
+    }
+}
+
+static void task_console(void* parameters)
+{
+    const UARTInstance INSTANCE = (UARTInstance)(uintptr_t) parameters;
+
+    while (1) {
+        uint8_t key;
+
+        while (uart_receive_poll(INSTANCE, &key)) {
+            for (size_t i = 0; i < sizeof(COMMANDS) / sizeof(COMMANDS[0]); i++) {
+                if (COMMANDS[i].key == (char) key) {
+                    COMMANDS[i].run();
+                    break;
+                }
+            }
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(CONSOLE_POLL_PERIOD_MS));
+    }
+}
+
+void console_init(const UARTInstance instance)
+{
+    // Same priority as the log drain: reports never delay the services
+    TaskHandle_t task = xTaskCreateStatic(
+            task_console,
+            "Console",
+            CONSOLE_STACK_DEPTH,
+            (void*)(uintptr_t) instance,
+            tskIDLE_PRIORITY,
+            console_stack,
+            &console_task_buffer);
+    configASSERT(task);
+}
@@ -54,6 +54,8 @@
 /* USER CODE BEGIN 0 */
   extern void configureTimerForRunTimeStats(void);
   extern unsigned long getRunTimeCounterValue(void);
+  extern void app_fault(void);
+  extern void log_task_deleted(void* task);
 /* USER CODE END 0 */
 #endif
 #ifndef CMSIS_device_header
@@ -162,7 +164,8 @@ See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 /* Normal assert() semantics without relying on the provision of an assert.h
 header file. */
 /* USER CODE BEGIN 1 */
-#define configASSERT( x ) if ((x) == 0) {taskDISABLE_INTERRUPTS(); for( ;; );}
+/* A failed assertion dumps the flight recorder before halting (see app_fault()) */
+#define configASSERT( x ) if ((x) == 0) {taskDISABLE_INTERRUPTS(); app_fault(); for( ;; );}
 /* USER CODE END 1 */
 
 /* Definitions that map the FreeRTOS port interrupt handlers to their CMSIS
@@ -182,6 +185,22 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* Needed by the queue set AO host (SVC_ao_qset.h) */
+#define configUSE_QUEUE_SETS                     1
+
+/* Newlib-free runtime: every text goes through the reentrant formatter (SVC_format.h), so the tasks can skip their
+   newlib reentrancy struct (struct _reent, in every TCB). Set to 0 to go back to newlib's stdio in every task.
+   The stats formatting functions use sprintf(), so they go away too. */
+#define APP_NEWLIB_FREE                          1
+#if APP_NEWLIB_FREE
+#undef configUSE_NEWLIB_REENTRANT
+#define configUSE_NEWLIB_REENTRANT               0
+#undef configUSE_STATS_FORMATTING_FUNCTIONS
+#define configUSE_STATS_FORMATTING_FUNCTIONS     0
+#endif
+
+/* Deleted tasks hand their log ring over to the next new task (SVC_log.h) */
+#define traceTASK_DELETE( pxTaskToDelete )       log_task_deleted( pxTaskToDelete )
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
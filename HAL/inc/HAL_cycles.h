@@ -0,0 +1,16 @@
+#pragma once
+
+#include "stdint.h"
+
+/// @brief Enable the free-running CPU cycle counter. Safe to be called more than once.
+void cycles_init();
+
+/// @brief Read the CPU cycle counter (DWT->CYCCNT). Host builds return nanoseconds of a monotonic clock instead. It
+///        wraps around every 2^32 counts, so always compute differences with unsigned arithmetic (`end - start`).
+/// @return Current value of the cycle counter.
+uint32_t cycles_now();
+
+/// @brief Convert a duration to counts of the cycle counter, e.g. for time based deadlines.
+/// @param us Duration, in microseconds.
+/// @return Counts of `cycles_now()` the duration takes.
+uint32_t cycles_from_us(const uint32_t us);
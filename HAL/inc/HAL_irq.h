@@ -0,0 +1,20 @@
+#pragma once
+
+#include "stdbool.h"
+#include "stdint.h"
+
+/// @brief Amount of interrupt priority levels (4 priority bits on the STM32F4).
+#define IRQ_LEVELS 16
+
+/// @brief Returned by `irq_active_level()` outside of any interrupt with a configurable priority.
+#define IRQ_LEVEL_NONE UINT8_MAX
+
+/// @brief Priority level of the running interrupt. Interrupts of the same level never preempt each other, so data
+///        written only at one level needs no lock against writers of that level.
+/// @return Level, from 0 (highest priority) to IRQ_LEVELS - 1. IRQ_LEVEL_NONE in thread mode, and in NMI and
+///         HardFault, whose priority is fixed.
+uint8_t irq_active_level();
+
+/// @brief Whether the caller runs in an exception handler, whatever its priority (NMI and HardFault included).
+/// @return `true` in handler mode. `false` in thread mode.
+bool irq_active();
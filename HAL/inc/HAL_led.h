@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+
 /// @brief Enum that keeps track of the available LEDs
 typedef enum
 {
@@ -32,3 +34,13 @@ void led_set(const BoardLEDs led);
 /// @brief Turn off the specified LED. It's equivalent to call `led_set(led, LED_OFF)`
 /// @param led Must be one of the defined in BoardLEDs.
 void led_clear(const BoardLEDs led);
+
+/// @brief Get the status of every LED at once.
+/// @return Bitmask of the LEDs currently on. Bit N corresponds to the BoardLEDs value N.
+uint8_t led_read_mask();
+
+/// @brief Turn on and off several LEDs with a single atomic write per GPIO port (no read-modify-write).
+/// @param on_mask LEDs to be turned on. Bit N corresponds to the BoardLEDs value N.
+/// @param off_mask LEDs to be turned off. Must not overlap with `on_mask`.
+/// @return Amount of GPIO port writes performed (at most one per port holding a LED of either mask).
+uint8_t led_write_mask(const uint8_t on_mask, const uint8_t off_mask);
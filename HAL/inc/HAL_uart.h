@@ -76,9 +76,33 @@ bool uart_init(UARTConfig* config);
 /// @param size bytes to be sent.
 void uart_send(UARTInstance instance, uint8_t* p_data, size_t size);
 
+/// @brief Send `size` bytes of a given array, polling until the last one is out. Meant for diagnostic dumps, where
+///        the caller can not rely on interrupts (e.g. a fault handler). Must not be mixed with an ongoing `uart_send()`.
+/// @param instance UART instance.
+/// @param p_data pointer to the data.
+/// @param size bytes to be sent.
+/// @param timeout_ms Maximum time to wait for the whole transmission, in ms.
+/// @return `true` if every byte was sent. `false` otherwise.
+bool uart_send_blocking(UARTInstance instance, const uint8_t* p_data, size_t size, uint32_t timeout_ms);
+
+/// @brief Send `size` bytes straight through the data register, polling, regardless of the HAL state (and its lock).
+///        Meant for the last words of a halted system (failed assertion, fault handler), where interrupts are off and
+///        the instance may have been left in the middle of another transfer. Never times out.
+/// @param instance Initialized UART instance.
+/// @param p_data pointer to the data.
+/// @param size bytes to be sent.
+void uart_send_polled(UARTInstance instance, const uint8_t* p_data, size_t size);
+
 /// @brief Receive `size` bytes from the UART RX's buffer and store them. Since the
 ///        reception is interrupt-driven, the client will be notified on the instance's `rx_done_callback`.
 /// @param instance UART instance.
 /// @param p_data Address where received data should be stored
 /// @param size Number of bytes to be read.
 void uart_receive(UARTInstance instance, uint8_t* p_data, size_t size);
+
+/// @brief Take a received byte, if there is one, without waiting and without interrupts. Meant for low rate input
+///        (e.g. debug commands) on an instance whose reception is otherwise unused.
+/// @param instance UART instance.
+/// @param p_data Where the received byte is stored.
+/// @return `true` if a byte was received. `false` otherwise.
+bool uart_receive_poll(UARTInstance instance, uint8_t* p_data);
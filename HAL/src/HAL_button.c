@@ -1,10 +1,13 @@
 #include <assert.h>
+#include <stdint.h>
+
+#include "HAL_button.h"
+
+#if defined(__arm__)
 
 #include "stm32f4xx_hal.h"
 #include "stm32f4xx_hal_gpio.h"
 
-#include "HAL_button.h"
-
 /// @brief Platform-dependant struct that wraps the vendor HAL for GPIO management (with interest on inputs).
 typedef struct
 {
@@ -30,6 +33,17 @@ ButtonStatus button_read(const BoardButtons button)
     return (BUTTON_STATE == condition_check) ? BUTTON_PRESSED : BUTTON_RELEASED;
 }
 
+#else
+
+// Host build (e.g. simulation): nobody presses the buttons
+ButtonStatus button_read(const BoardButtons button)
+{
+    assert(button < BUTTONS_TOTAL);
+    return BUTTON_RELEASED;
+}
+
+#endif
+
 ButtonStatus button_debounce(ButtonStatus button_raw_read)
 {
 	static uint16_t state = 0; // Current debounce status.
@@ -0,0 +1,37 @@
+#include "HAL_cycles.h"
+
+#if defined(__arm__)
+
+#include "stm32f4xx_hal.h"
+
+void cycles_init()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+}
+
+uint32_t cycles_now() { return DWT->CYCCNT; }
+
+uint32_t cycles_from_us(const uint32_t us) { return us * (SystemCoreClock / 1000000U); }
+
+#else
+
+// Host build (e.g. unit tests or simulation): there is no DWT, so nanoseconds of a monotonic clock are used instead
+#include <time.h>
+
+void cycles_init() {}
+
+uint32_t cycles_now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec);
+}
+
+uint32_t cycles_from_us(const uint32_t us) { return us * 1000U; }
+
+#endif
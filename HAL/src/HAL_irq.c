@@ -0,0 +1,35 @@
+#include "HAL_irq.h"
+
+#if defined(__arm__)
+
+#include "stm32f4xx_hal.h"
+
+_Static_assert(IRQ_LEVELS == (1 << __NVIC_PRIO_BITS), "IRQ_LEVELS must match the NVIC priority bits");
+
+/// @brief First exception with a configurable priority (MemManage). Lower numbers are thread mode, reset, NMI and
+///        HardFault.
+#define IRQ_FIRST_CONFIGURABLE_EXCEPTION 4
+
+uint8_t irq_active_level()
+{
+    const uint32_t EXCEPTION = __get_IPSR();
+    if (EXCEPTION < IRQ_FIRST_CONFIGURABLE_EXCEPTION) {
+        return IRQ_LEVEL_NONE;
+    }
+
+    // IRQ numbers start at exception 16. System exceptions get negative numbers, which NVIC_GetPriority() handles too
+    return (uint8_t) NVIC_GetPriority((IRQn_Type)((int32_t) EXCEPTION - 16));
+}
+
+bool irq_active()
+{
+    return __get_IPSR() != 0;
+}
+
+#else
+
+// Host build: there are no interrupts, so everything runs at the same and only level
+uint8_t irq_active_level() { return 0; }
+bool irq_active() { return false; }
+
+#endif
@@ -1,9 +1,13 @@
 #include <assert.h>
-#include "stm32f4xx_hal.h"
-#include "stm32f4xx_hal_gpio.h"
+#include <stdbool.h>
 
 #include "HAL_led.h"
 
+#if defined(__arm__)
+
+#include "stm32f4xx_hal.h"
+#include "stm32f4xx_hal_gpio.h"
+
 /// @brief Polarity of the LED.
 typedef enum
 {
@@ -54,3 +58,103 @@ void led_write(const BoardLEDs led, const LEDStatus status)
 void led_set(const BoardLEDs led) { led_write(led, LED_ON); }
 
 void led_clear(const BoardLEDs led) { led_write(led, LED_OFF); }
+
+uint8_t led_read_mask()
+{
+    uint8_t mask = 0;
+
+    for (BoardLEDs led = LED1; led < LEDS_TOTAL; led++) {
+        const LEDStruct* const LED = &AVAILABLE_LEDS[led];
+        const bool HIGH = (LED->port->ODR & LED->pin) != 0;
+
+        if (HIGH == (LED->polarity == ACTIVE_HIGH)) {
+            mask |= (uint8_t)(1U << led);
+        }
+    }
+
+    return mask;
+}
+
+uint8_t led_write_mask(const uint8_t on_mask, const uint8_t off_mask)
+{
+    assert((on_mask & off_mask) == 0);
+    uint8_t writes = 0;
+
+    // BSRR: the lower half sets pins and the upper half resets them, so a single store updates a whole port
+    for (BoardLEDs first = LED1; first < LEDS_TOTAL; first++) {
+        GPIO_TypeDef* const PORT = AVAILABLE_LEDS[first].port;
+        uint32_t bsrr = 0;
+        bool visited = false;
+
+        for (BoardLEDs led = LED1; led < LEDS_TOTAL; led++) {
+            const LEDStruct* const LED = &AVAILABLE_LEDS[led];
+            if (LED->port != PORT) {
+                continue;
+            }
+            if (led < first) {
+                visited = true; // This port was already written
+                break;
+            }
+
+            const uint8_t BIT = (uint8_t)(1U << led);
+            if (!((on_mask | off_mask) & BIT)) {
+                continue;
+            }
+
+            const bool HIGH = ((on_mask & BIT) != 0) == (LED->polarity == ACTIVE_HIGH);
+            bsrr |= HIGH ? (uint32_t)LED->pin : ((uint32_t)LED->pin << 16U);
+        }
+
+        if (!visited && bsrr) {
+            PORT->BSRR = bsrr;
+            writes++;
+        }
+    }
+
+    return writes;
+}
+
+#else
+
+// Host build (e.g. simulation): the LEDs are a bit mask in memory, and a write touches a single "port"
+static uint8_t host_leds;
+
+void led_toggle(const BoardLEDs led)
+{
+    assert(led < LEDS_TOTAL);
+    host_leds ^= (uint8_t)(1U << led);
+}
+
+void led_write(const BoardLEDs led, const LEDStatus status)
+{
+    assert(led < LEDS_TOTAL);
+    assert(status == LED_ON || status == LED_OFF);
+
+    if (status == LED_ON) {
+        host_leds |= (uint8_t)(1U << led);
+    } else {
+        host_leds &= (uint8_t)~(1U << led);
+    }
+}
+
+void led_set(const BoardLEDs led) { led_write(led, LED_ON); }
+
+void led_clear(const BoardLEDs led) { led_write(led, LED_OFF); }
+
+uint8_t led_read_mask()
+{
+    return host_leds;
+}
+
+uint8_t led_write_mask(const uint8_t on_mask, const uint8_t off_mask)
+{
+    assert((on_mask & off_mask) == 0);
+    if (!(on_mask | off_mask)) {
+        return 0;
+    }
+
+    host_leds = (uint8_t)((host_leds | on_mask) & ~off_mask);
+    return 1;
+}
+
+#endif
@@ -1,10 +1,14 @@
+#define LOG_MODULE_LEVEL LOG_LEVEL_UART
+
+#if defined(__arm__)
+
 #include <assert.h>
-#include <stdio.h>
 
 #include "stm32f4xx_hal.h"
 #include "stm32f4xx_hal_uart.h"
 
 #include "HAL_uart.h"
+#include "SVC_log.h"
 
 /// | Private typedef -----------------------------------------------------------
 
@@ -18,9 +22,6 @@ typedef struct
 } UARTInstance_port;
 
 /// | Private define ------------------------------------------------------------
-
-#define INITIALIZATION_BUFFER_SIZE 256 // Size of the buffer used for transmitting the UART initialization message
-
 /// | Private macro -------------------------------------------------------------
 
 /// | Private variables ---------------------------------------------------------
@@ -166,8 +167,6 @@ static uint32_t parse_parity(const UARTParity parity)
 
 bool uart_init(UARTConfig* config)
 {
-    uint8_t buffer[INITIALIZATION_BUFFER_SIZE];
-
     bool ret = false;
     const UARTInstance INSTANCE = config->instance;
 
@@ -183,24 +182,14 @@ bool uart_init(UARTConfig* config)
 
     ret = (HAL_UART_Init(&UART_INSTANCES[INSTANCE].huart) == HAL_OK);
 
-    // Only print the message if the initialization was OK
+    // Only log the parameters if the initialization was OK. Every string is a constant, so the decoder can rebuild it.
     if(ret) {
-        snprintf((char*)buffer, INITIALIZATION_BUFFER_SIZE,
-                "--------------------\r\n"
-                "%s initialized!\r\n"
-                "Parameters:\r\n"
-                "\t> Baudrate: %ld\r\n"
-                "\t> Data bits: %s\r\n"
-                "\t> Stop bits: %s\r\n"
-                "\t> Parity: %s\r\n"
-                "--------------------\r\n",
+        LOG_INFO("%s initialized! Baudrate: %lu, data bits: %s, stop bits: %s, parity: %s",
                 uart_instance_name(&UART_INSTANCES[INSTANCE].huart),
                 UART_INSTANCES[INSTANCE].huart.Init.BaudRate,
                 uart_data_bits_string(&UART_INSTANCES[INSTANCE].huart),
                 uart_stop_bits_string(&UART_INSTANCES[INSTANCE].huart),
                 uart_parity_string(&UART_INSTANCES[INSTANCE].huart));
-
-        printf("%s\n", buffer);
     }
 
     return ret;
@@ -211,11 +200,46 @@ void uart_send(UARTInstance instance, uint8_t* p_data, size_t size)
     HAL_UART_Transmit_IT(&UART_INSTANCES[instance].huart, p_data, size);
 }
 
+bool uart_send_blocking(UARTInstance instance, const uint8_t* p_data, size_t size, uint32_t timeout_ms)
+{
+    // The vendor HAL never writes the buffer, it just lacks the const qualifier
+    return HAL_UART_Transmit(&UART_INSTANCES[instance].huart, (uint8_t*)p_data, size, timeout_ms) == HAL_OK;
+}
+
+void uart_send_polled(UARTInstance instance, const uint8_t* p_data, size_t size)
+{
+    UART_HandleTypeDef* const HUART = &UART_INSTANCES[instance].huart;
+
+    for (size_t i = 0; i < size; i++) {
+        while (__HAL_UART_GET_FLAG(HUART, UART_FLAG_TXE) == RESET) {
+        }
+        HUART->Instance->DR = p_data[i];
+    }
+
+    // The system halts right after: the last byte must be out of the shift register
+    while (__HAL_UART_GET_FLAG(HUART, UART_FLAG_TC) == RESET) {
+    }
+}
+
 void uart_receive(UARTInstance instance, uint8_t* p_data, size_t size)
 {
     HAL_UART_Receive_IT(&UART_INSTANCES[instance].huart, p_data, size);
 }
 
+bool uart_receive_poll(UARTInstance instance, uint8_t* p_data)
+{
+    UART_HandleTypeDef* const HUART = &UART_INSTANCES[instance].huart;
+
+    // Straight from the registers: a polled HAL_UART_Receive() that times out also resets the TX state, which would
+    // break a transmission in progress
+    if (__HAL_UART_GET_FLAG(HUART, UART_FLAG_RXNE) == RESET) {
+        return false;
+    }
+
+    *p_data = (uint8_t)(HUART->Instance->DR & 0xFFU);
+    return true;
+}
+
 void uart_irq_handler(UARTInstance instance)
 {
     HAL_UART_IRQHandler(&UART_INSTANCES[instance].huart);
@@ -244,3 +268,73 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
         }
     }
 }
+
+#else
+
+// Host build (e.g. simulation): each instance writes to a file of its own, "uart<N>.bin" in the working directory, so
+// binary streams (the log, the recorder fault dump) never garble the console. Nothing is ever received.
+#include <stdio.h>
+
+#include "HAL_uart.h"
+
+static FILE* host_files[UART_INSTANCE_TOTAL];
+static uart_callback_t host_tx_done_callbacks[UART_INSTANCE_TOTAL];
+
+static void host_write(UARTInstance instance, const uint8_t* p_data, size_t size)
+{
+    if (host_files[instance]) {
+        fwrite(p_data, 1, size, host_files[instance]);
+        fflush(host_files[instance]);
+    }
+}
+
+bool uart_init(UARTConfig* config)
+{
+    char name[] = "uart0.bin";
+    name[4] = (char)('0' + config->instance);
+
+    host_files[config->instance] = fopen(name, "wb");
+    host_tx_done_callbacks[config->instance] = config->tx_done_callback;
+    return host_files[config->instance] != NULL;
+}
+
+void uart_send(UARTInstance instance, uint8_t* p_data, size_t size)
+{
+    host_write(instance, p_data, size);
+    if (host_tx_done_callbacks[instance]) {
+        host_tx_done_callbacks[instance](instance);
+    }
+}
+
+bool uart_send_blocking(UARTInstance instance, const uint8_t* p_data, size_t size, uint32_t timeout_ms)
+{
+    (void) timeout_ms;
+    host_write(instance, p_data, size);
+    return true;
+}
+
+void uart_send_polled(UARTInstance instance, const uint8_t* p_data, size_t size)
+{
+    host_write(instance, p_data, size);
+}
+
+void uart_receive(UARTInstance instance, uint8_t* p_data, size_t size)
+{
+    (void) instance;
+    (void) p_data;
+    (void) size;
+}
+
+bool uart_receive_poll(UARTInstance instance, uint8_t* p_data)
+{
+    (void) instance;
+    (void) p_data;
+    return false;
+}
+
+void uart_irq_handler(UARTInstance instance)
+{
+    (void) instance;
+}
+
+#endif
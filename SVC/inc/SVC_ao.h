@@ -0,0 +1,319 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+
+/// @brief Events up to this size (in bytes) are copied straight into the AO queue storage. Bigger events are taken
+///        from the event pool and the queue only carries a pointer to them.
+#define AO_EVENT_BY_VALUE_MAX_SIZE 8
+
+/// @brief Maximum amount of Active Objects. Each AO gets a unique id in [0, AO_MAX_ACTIVE_OBJECTS).
+#define AO_MAX_ACTIVE_OBJECTS 8
+
+/// @brief Size of each queue item for an AO that handles events of `event_size` bytes.
+#define AO_QUEUE_ITEM_SIZE(event_size) (((event_size) <= AO_EVENT_BY_VALUE_MAX_SIZE) ? (event_size) : sizeof(void*))
+
+/// @brief Size (in bytes) of the queue storage needed by an AO.
+#define AO_QUEUE_STORAGE_SIZE(event_size, queue_length) (AO_QUEUE_ITEM_SIZE(event_size) * (queue_length))
+
+/// @brief Size of the FreeRTOS queue registry name of a lane ("<AO name>/normal" or "<AO name>/urgent"), terminator
+///        included. Longer names are truncated.
+#define AO_LANE_NAME_SIZE 24
+
+/// @brief Maximum amount of keys of an AO using AO_OVERFLOW_COALESCE. Keys go from 0 to AO_COALESCE_MAX_KEYS - 1.
+#define AO_COALESCE_MAX_KEYS 32
+
+/// @brief Size (in bytes) of the storage needed by an AO using AO_OVERFLOW_COALESCE: one pending event per key.
+#define AO_COALESCE_STORAGE_SIZE(event_size) (AO_COALESCE_MAX_KEYS * (event_size))
+
+/// @brief What happens when an event is posted to an AO. Every policy but AO_OVERFLOW_BLOCK guarantees that posting
+///        never blocks the producer, no matter how slow the consumer is.
+typedef enum
+{
+    AO_OVERFLOW_BLOCK = 0,   ///< Wait for room up to min(caller timeout, AOConfig.block_timeout) ticks. The default
+                             ///< block_timeout (0) sets no cap: the caller timeout applies as is.
+    AO_OVERFLOW_DROP_NEWEST, ///< If the queue is full, the posted event is dropped.
+    AO_OVERFLOW_DROP_OLDEST, ///< If the queue is full, the oldest pending event is dropped to make room.
+    AO_OVERFLOW_OVERWRITE,   ///< Mailbox: the queue holds a single event, and every post overwrites it.
+    AO_OVERFLOW_COALESCE,    ///< At most one pending event per key: posting a key that is pending replaces its event.
+} AOOverflowPolicy;
+
+/// @brief Events up to this size (in bytes) can be carried by a task notification transport.
+#define AO_NOTIFY_EVENT_MAX_SIZE sizeof(uint32_t)
+
+/// @brief How events travel from the posters to the AO. Chosen per AO at init.
+typedef enum
+{
+    AO_TRANSPORT_QUEUE = 0,    ///< FreeRTOS queue (one per lane). Supports every feature.
+    AO_TRANSPORT_NOTIFY_BITS,  ///< Task notification, eSetBits: the events are bitmasks, and pending ones are ORed into
+                               ///< a single dispatch. For signal-style events.
+    AO_TRANSPORT_NOTIFY_VALUE, ///< Task notification, eSetValueWithOverwrite: single-slot mailbox, the latest event wins.
+} AOTransport;
+
+/// @brief Event lanes of an AO. Each lane is a queue of its own, and pending urgent events are always dispatched
+///        before any normal one, so a control event never waits behind routine traffic.
+typedef enum
+{
+    AO_LANE_NORMAL = 0, ///< Routine events. Every AO has this lane.
+    AO_LANE_URGENT,     ///< Control events. Only available if the AO was given an urgent queue.
+    AO_LANES_TOTAL,     ///< Total amount of lanes. Keep this value always at the bottom!
+} AOLane;
+
+/// @brief Posting statistics of an AO lane. Only updated inside a critical section.
+typedef struct
+{
+    uint32_t posted;         ///< Events queued (or coalesced) in the lane.
+    uint32_t depth_max;      ///< High-water mark of the lane queue.
+    uint32_t dropped;        ///< Events lost by AO_OVERFLOW_DROP_NEWEST/DROP_OLDEST, or by a blocking post timeout.
+    uint32_t overwritten;    ///< Events replaced by AO_OVERFLOW_OVERWRITE.
+    uint32_t coalesced;      ///< Events replaced by AO_OVERFLOW_COALESCE.
+    uint32_t blocked_posts;  ///< Posts that had to wait for room in the queue.
+    uint32_t blocked_ticks;  ///< Total ticks spent waiting for room in the queue.
+    uint32_t blocked_max;    ///< Longest wait for room in the queue, in ticks.
+} AOStats;
+
+/// @brief Dispatch statistics of an AO. Only written by the task that dispatches the AO.
+typedef struct
+{
+    uint32_t dispatched;     ///< Events dispatched.
+    uint32_t cycles_min;     ///< Cheapest dispatch, in CPU cycles.
+    uint32_t cycles_max;     ///< Most expensive dispatch, in CPU cycles.
+    uint64_t cycles_total;   ///< Cycles spent dispatching. Divide by `dispatched` for the average.
+    uint8_t last_event_type; ///< Type of the last dispatched event, as reported by `AOConfig.event_type`.
+} AODispatchStats;
+
+/// @brief `AODispatchStats.last_event_type` of AOs without an event type handler, or that dispatched nothing yet.
+#define AO_EVENT_TYPE_UNKNOWN UINT8_MAX
+
+/// @brief Absolute deadline of an event, as a `cycles_now()` value. Build it with `ao_deadline_in()`.
+typedef uint32_t AODeadline;
+
+/// @brief Deadline of events that have none.
+#define AO_DEADLINE_NONE 0
+
+/// @brief Buckets of the slack histogram. Bucket N counts slacks in [4^N, 4^(N+1)) cycles (bucket 0 also counts 0),
+///        so 16 buckets cover the whole 32 bit range.
+#define AO_SLACK_BUCKETS 16
+
+/// @brief Deadline statistics of an AO. Only events with a deadline are accounted. The slack is measured when the
+///        dispatch handler returns, or when the AO reports the event done (see `AOConfig.completes_deadlines`).
+typedef struct
+{
+    uint32_t met;                       ///< Events completed before their deadline.
+    uint32_t missed;                    ///< Events completed after their deadline.
+    uint32_t lateness_max;              ///< Worst miss, in CPU cycles past the deadline.
+    uint32_t slack[AO_SLACK_BUCKETS];   ///< Histogram of the slack left by the met deadlines.
+} AODeadlineStats;
+
+typedef struct ActiveObject ActiveObject;
+typedef struct AOKernel AOKernel;
+typedef struct AOQueueSet AOQueueSet;
+
+/// @brief Handler invoked by the AO task for every received event. It runs to completion before the next event
+///        is dequeued, so it must not block.
+/// @param ao AO that received the event.
+/// @param event Received event. It is only valid during the call.
+typedef void (*ao_dispatch_handler_t)(ActiveObject* ao, const void* event);
+
+/// @brief Handler invoked after a dispatch that left the AO without pending events. AOs that batch the work of several
+///        events (e.g. to touch the hardware once per burst) apply it here.
+/// @param ao AO that ran out of events.
+typedef void (*ao_flush_handler_t)(ActiveObject* ao);
+
+/// @brief Handler that tells the type of an event. Only used for introspection.
+/// @param event Dispatched event.
+/// @return Type of the event, as defined by the AO.
+typedef uint8_t (*ao_type_handler_t)(const void* event);
+
+/// @brief Handler that maps an event to its coalescing key. Used by AO_OVERFLOW_COALESCE.
+/// @param event Event being posted.
+/// @return Key of the event, in [0, AO_COALESCE_MAX_KEYS).
+typedef uint8_t (*ao_key_handler_t)(const void* event);
+
+/// @brief Handler that tells the deadline of an event.
+/// @param event Queued or dispatched event.
+/// @return Absolute deadline of the event, or AO_DEADLINE_NONE.
+typedef AODeadline (*ao_deadline_handler_t)(const void* event);
+
+/// @brief Parameters needed to initialize an Active Object. All the memory is provided by the caller, so no AO
+///        touches the FreeRTOS heap. AOs hosted by a cooperative kernel or a queue set need no stack nor task control
+///        block.
+typedef struct
+{
+    const char* name;                ///< Name of the AO. Also used as the task name.
+    ao_dispatch_handler_t dispatch;  ///< Event handler.
+    ao_flush_handler_t flush;        ///< Batch handler. NULL if the AO does not batch its events.
+    ao_type_handler_t event_type;    ///< Event type handler. NULL if the AO does not report event types.
+    size_t event_size;               ///< Size of the events handled by the AO, in bytes.
+    AOTransport transport;           ///< Event transport. Notification transports need events of at most
+                                     ///< AO_NOTIFY_EVENT_MAX_SIZE bytes, an AO task of its own and no urgent lane.
+    UBaseType_t queue_length;        ///< Maximum amount of pending events. Unused by notification transports.
+    uint8_t* queue_storage;          ///< At least `AO_QUEUE_STORAGE_SIZE(event_size, queue_length)` bytes. Unused by
+                                     ///< notification transports.
+    uint32_t stack_depth;            ///< Task stack size, in words. Unused if the AO is hosted.
+    StackType_t* stack;              ///< At least `stack_depth` words. Unused if the AO is hosted.
+    StaticTask_t* task_buffer;       ///< Task control block. Unused if the AO is hosted.
+    UBaseType_t priority;            ///< Task priority, or priority inside its host (`kernel` or `queue_set`).
+    AOKernel* kernel;                ///< Cooperative kernel hosting the AO, or NULL to give the AO its own task.
+    AOQueueSet* queue_set;           ///< Queue set host of the AO, or NULL. Exclusive with `kernel`.
+    UBaseType_t urgent_queue_length; ///< Maximum amount of pending urgent events. 0 means no urgent lane.
+    uint8_t* urgent_queue_storage;   ///< At least `AO_QUEUE_STORAGE_SIZE(event_size, urgent_queue_length)` bytes.
+    AOOverflowPolicy overflow_policy; ///< What to do when a lane queue is full. Applies to every lane.
+    TickType_t block_timeout;        ///< AO_OVERFLOW_BLOCK only: longest wait allowed, whatever the caller asks for.
+                                     ///< 0 (the default) sets no cap, so the caller timeout is used.
+    ao_key_handler_t coalesce_key;   ///< AO_OVERFLOW_COALESCE only: key of each event.
+    uint8_t* coalesce_storage;       ///< AO_OVERFLOW_COALESCE only: `AO_COALESCE_STORAGE_SIZE(event_size)` bytes.
+    ao_deadline_handler_t deadline;  ///< Deadline handler. NULL if the events of the AO carry no deadline.
+    bool completes_deadlines;        ///< true if the AO calls `ao_deadline_done()` once each event takes effect (e.g.
+                                     ///< a batching AO, whose output only changes in its flush). false to measure the
+                                     ///< deadlines when the dispatch handler returns.
+} AOConfig;
+
+/// @brief Active Object: an event queue plus a task that dispatches its events one at a time.
+///        Embed it as the first member of a service specific struct to build a concrete AO.
+struct ActiveObject
+{
+    uint8_t id;                      ///< Index of the AO in the AO registry. Also used as bit in subscriber masks.
+    const char* name;                ///< Name of the AO. Its lanes are "<name>/normal" and "<name>/urgent" in the
+                                     ///< FreeRTOS queue registry.
+    QueueHandle_t queues[AO_LANES_TOTAL]; ///< Event queue of each lane. NULL if the lane is not available (or the AO
+                                          ///< uses a notification transport).
+    TaskHandle_t task;               ///< Task that dispatches the queue. Shared by every AO of the same host.
+    AOKernel* kernel;                ///< Cooperative kernel hosting the AO. NULL if the AO owns its task.
+    AOQueueSet* queue_set;           ///< Queue set hosting the AO. NULL if the AO owns its task.
+    UBaseType_t priority;            ///< Task priority, or priority inside its host.
+    ao_dispatch_handler_t dispatch;  ///< Event handler.
+    ao_flush_handler_t flush;        ///< Batch handler. NULL if the AO does not batch its events.
+    ao_type_handler_t event_type;    ///< Event type handler. NULL if the AO does not report event types.
+    size_t event_size;               ///< Size of the events handled by the AO, in bytes.
+    bool by_value;                   ///< true if the queue stores whole events, false if it stores pool blocks.
+    AOTransport transport;           ///< Event transport.
+    AOOverflowPolicy overflow_policy; ///< What to do when the queue is full.
+    TickType_t block_timeout;        ///< AO_OVERFLOW_BLOCK only: longest wait allowed. portMAX_DELAY if uncapped.
+    ao_key_handler_t coalesce_key;   ///< AO_OVERFLOW_COALESCE only: key of each event.
+    uint8_t* coalesce_slots;         ///< AO_OVERFLOW_COALESCE only: latest pending event of each key.
+    uint32_t coalesce_pending;       ///< AO_OVERFLOW_COALESCE only: bit N set if key N is queued.
+    ao_deadline_handler_t deadline;  ///< Deadline handler. NULL if the events of the AO carry no deadline.
+    bool completes_deadlines;        ///< true if the AO reports its deadlines with `ao_deadline_done()`.
+    AOStats stats[AO_LANES_TOTAL];   ///< Posting statistics of each lane.
+    AODispatchStats dispatch_stats;  ///< Dispatch statistics.
+    AODeadlineStats deadline_stats;  ///< Deadline statistics.
+    StaticQueue_t queue_buffers[AO_LANES_TOTAL]; ///< Queue control block of each lane.
+#if configQUEUE_REGISTRY_SIZE > 0
+    char lane_names[AO_LANES_TOTAL][AO_LANE_NAME_SIZE]; ///< Queue registry name of each lane.
+#endif
+};
+
+/// @brief Initialize an Active Object and add it to the AO registry. The queues are created before the task, so the
+///        task never sees a half initialized AO. AOs with an urgent lane are woken through their task notification,
+///        since the task has to wait on both queues at once. AO_OVERFLOW_OVERWRITE and AO_OVERFLOW_COALESCE AOs can
+///        only have the normal lane. This function must be called before starting the scheduler (it is asserted): the
+///        registry is not locked, and its slots are never given back.
+/// @param ao Active Object to initialize.
+/// @param config AO parameters. It is only read during the call.
+void ao_initialize(ActiveObject* ao, const AOConfig* const config);
+
+/// @brief Post an event to a lane of an Active Object, applying its overflow policy. The event is copied, so the caller
+///        keeps its ownership.
+/// @param ao Receiver of the event.
+/// @param event Event to be sent. Must be `event_size` bytes long.
+/// @param lane Lane of the event. It must be available in the AO.
+/// @param timeout Maximum amount of ticks to wait if the lane queue is full. Only used by AO_OVERFLOW_BLOCK.
+/// @return true if the event was queued (or coalesced), false if it was dropped.
+bool ao_post_lane(ActiveObject* ao, const void* const event, const AOLane lane, const TickType_t timeout);
+
+/// @brief Post an event to the normal lane of an Active Object. See `ao_post_lane()`.
+bool ao_post(ActiveObject* ao, const void* const event, const TickType_t timeout);
+
+/// @brief Post an event pool block to an Active Object without copying it, applying its overflow policy. Only valid for
+///        AOs whose events are not posted by value. On success the AO owns one reference of the block and drops it
+///        after the dispatch.
+/// @param ao Receiver of the event.
+/// @param block Event pool block holding the event.
+/// @param lane Lane of the event. It must be available in the AO.
+/// @param timeout Maximum amount of ticks to wait if the lane queue is full.
+/// @return true if the block was queued, false otherwise (the reference stays with the caller).
+bool ao_post_reference(ActiveObject* ao, void* const block, const AOLane lane, const TickType_t timeout);
+
+/// @brief Same as `ao_post()`, but safe to be called from interrupt context. It never waits: AO_OVERFLOW_BLOCK behaves
+///        like AO_OVERFLOW_DROP_NEWEST, and big events are taken from the event pool (never from the heap). An ISR may
+///        post several events sharing the same `woken` flag, and then call `ao_isr_yield()` once before returning:
+///
+///            BaseType_t woken = pdFALSE;
+///            ao_post_from_isr(ao_a, &event_a, &woken);
+///            ao_post_from_isr(ao_b, &event_b, &woken);
+///            ao_isr_yield(woken);
+///
+/// @param ao Receiver of the event.
+/// @param event Event to be sent. Must be `event_size` bytes long.
+/// @param woken Set to pdTRUE if a task with higher priority than the interrupted one was woken. Never cleared.
+/// @return true if the event was queued (or coalesced), false if it was dropped.
+bool ao_post_from_isr(ActiveObject* ao, const void* const event, BaseType_t* const woken);
+
+/// @brief Same as `ao_post_from_isr()`, but posting to any lane of the AO.
+bool ao_post_lane_from_isr(ActiveObject* ao, const void* const event, const AOLane lane, BaseType_t* const woken);
+
+/// @brief Same as `ao_post_reference()`, but safe to be called from interrupt context. See `ao_post_from_isr()`.
+bool ao_post_reference_from_isr(ActiveObject* ao, void* const block, const AOLane lane, BaseType_t* const woken);
+
+/// @brief Request a context switch at the end of an ISR if any `*_from_isr` post woke a higher priority task.
+///        Must be the last call of the ISR.
+/// @param woken Flag gathered across the ISR posts.
+#define ao_isr_yield(woken) portYIELD_FROM_ISR(woken)
+
+/// @brief Take the next event of an Active Object (waiting up to `timeout` ticks for it) and dispatch it to completion.
+///        Urgent events are always taken first. This is the loop body of every AO task. Cooperative kernels call it
+///        with a zero timeout.
+/// @param ao Active Object.
+/// @param timeout Maximum amount of ticks to wait for an event.
+/// @return true if an event was dispatched, false if the queue was empty.
+bool ao_dispatch_next(ActiveObject* ao, const TickType_t timeout);
+
+/// @brief Amount of events waiting in every lane of an AO.
+/// @param ao Active Object.
+/// @return Pending events.
+UBaseType_t ao_pending_events(ActiveObject* ao);
+
+/// @brief Build an absolute deadline `cycles` CPU cycles from now. Use `cycles_from_us()` for time based budgets.
+/// @param cycles Relative deadline.
+/// @return Absolute deadline. Never AO_DEADLINE_NONE.
+AODeadline ao_deadline_in(const uint32_t cycles);
+
+/// @brief Report that an event of an AO with `AOConfig.completes_deadlines` took effect, accounting its deadline now.
+///        Only the task that dispatches the AO may call it.
+/// @param ao Active Object.
+/// @param deadline Deadline of the event. AO_DEADLINE_NONE is a no-op.
+void ao_deadline_done(ActiveObject* ao, const AODeadline deadline);
+
+/// @brief Deadline of the event the AO will dispatch next (urgent lane first). Used by the EDF hosts.
+///        Events passed by reference are peeked without being owned, so only the AO host task may call it.
+/// @param ao Active Object.
+/// @param deadline Where the deadline will be stored.
+/// @return true if the AO has a pending event with a deadline.
+bool ao_next_deadline(ActiveObject* ao, AODeadline* const deadline);
+
+/// @brief Get a snapshot of the posting statistics of an AO lane.
+/// @param ao Active Object.
+/// @param lane Lane. Unavailable lanes report all zeroes.
+/// @param stats Where the snapshot will be stored.
+void ao_get_stats(ActiveObject* ao, const AOLane lane, AOStats* const stats);
+
+/// @brief Get a snapshot of the dispatch statistics of an AO.
+/// @param ao Active Object.
+/// @param stats Where the snapshot will be stored.
+void ao_get_dispatch_stats(ActiveObject* ao, AODispatchStats* const stats);
+
+/// @brief Get a snapshot of the deadline statistics of an AO.
+/// @param ao Active Object.
+/// @param stats Where the snapshot will be stored.
+void ao_get_deadline_stats(ActiveObject* ao, AODeadlineStats* const stats);
+
+/// @brief Get an Active Object from the AO registry.
+/// @param id AO id.
+/// @return The AO, or NULL if no AO was registered with that id.
+ActiveObject* ao_registry_get(const uint8_t id);
@@ -0,0 +1,333 @@
+#pragma once
+
+/// C++17 layer over the generic Active Object core (SVC_ao.h). Header only: including it from a C++ translation unit
+/// is all it takes. Every size (queue item, queue storage, stack) is fixed at compile time, the storage lives inside
+/// the object (so a static instance never touches the heap), and events are dispatched without virtual calls:
+///
+///     struct Toggle { uint8_t leds; };
+///     struct Block { uint8_t leds; };
+///     using LEDEvents = svc::Events<Toggle, Block>;
+///
+///     class LEDs : public svc::ActiveObject<LEDs, LEDEvents, 16, 256, tskIDLE_PRIORITY + 1>
+///     {
+///     public:
+///         void on(const Toggle& event);
+///         void on(const Block& event);
+///     };
+///
+///     static LEDs leds;
+///     leds.start("ao_leds");
+///     leds.post(Toggle{LED_MASK(LED_GREEN)});
+///
+/// The object can be handed to C code through `core()`, so the rest of the application keeps using the C API
+/// (ao_post(), pubsub_subscribe(), ...). SVC_led_ao.cpp is a complete example (urgent lane, batching, deadlines), and
+/// SVC_button_ao.cpp drives a hierarchical state machine (SVC_hsm.h) from it.
+///
+/// Translation units including it are built with -fno-exceptions -fno-rtti (see the G++ options of the project):
+/// nothing here needs either of them.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+extern "C" {
+#include "SVC_ao.h"
+}
+
+namespace svc
+{
+
+/// @brief Index of `T` inside `Ts...`, or sizeof...(Ts) if it is not there.
+template <typename T, typename... Ts>
+struct IndexOf;
+
+template <typename T>
+struct IndexOf<T> : std::integral_constant<std::size_t, 0>
+{
+};
+
+template <typename T, typename... Ts>
+struct IndexOf<T, T, Ts...> : std::integral_constant<std::size_t, 0>
+{
+};
+
+template <typename T, typename U, typename... Ts>
+struct IndexOf<T, U, Ts...> : std::integral_constant<std::size_t, 1 + IndexOf<T, Ts...>::value>
+{
+};
+
+/// @brief Closed set of event types, in the spirit of `std::variant`, but guaranteed to be trivially copyable so it
+///        can travel through a FreeRTOS queue (by value when small enough, otherwise through the event pool).
+///        Every alternative must be trivially copyable, and there can be at most 255 of them.
+template <typename... Ts>
+class Events
+{
+    static_assert(sizeof...(Ts) > 0 && sizeof...(Ts) <= UINT8_MAX, "Invalid amount of event types");
+    static_assert((std::is_trivially_copyable_v<Ts> && ...), "Events must be trivially copyable");
+
+public:
+    /// @brief Amount of event types.
+    static constexpr std::size_t TYPES = sizeof...(Ts);
+
+    /// @brief Index of an event type, usable as a compile-time constant.
+    template <typename T>
+    static constexpr std::uint8_t index_of = static_cast<std::uint8_t>(IndexOf<T, Ts...>::value);
+
+    /// @brief Build the event holding a copy of `value`.
+    template <typename T, typename = std::enable_if_t<(IndexOf<T, Ts...>::value < sizeof...(Ts))>>
+    Events(const T& value) : index_(index_of<T>)
+    {
+        std::memcpy(storage_, &value, sizeof(T));
+    }
+
+    /// @brief Index of the event type currently held.
+    std::uint8_t index() const { return index_; }
+
+    /// @brief Raw pointer to the held event. Use `get_if()` for a typed access.
+    const void* data() const { return storage_; }
+
+    /// @brief Get the held event if its type is `T`.
+    /// @return Pointer to the event, or nullptr if it holds another type.
+    template <typename T>
+    const T* get_if() const
+    {
+        return (index_ == index_of<T>) ? reinterpret_cast<const T*>(storage_) : nullptr;
+    }
+
+private:
+    static constexpr std::size_t max_size()
+    {
+        std::size_t size = 0;
+        ((size = (sizeof(Ts) > size) ? sizeof(Ts) : size), ...);
+        return size;
+    }
+
+    alignas(Ts...) unsigned char storage_[max_size()];
+    std::uint8_t index_;
+};
+
+/// @brief Call `visitor.on(event)` with the event type held by `events`. Dispatch goes through a jump table built at
+///        compile time: one indirect call, no virtual functions, no type switch.
+template <typename Visitor, typename... Ts>
+void visit(Visitor& visitor, const Events<Ts...>& events)
+{
+    using Thunk = void (*)(Visitor&, const void*);
+    static constexpr Thunk TABLE[] = {
+        [](Visitor& target, const void* event) { target.on(*static_cast<const Ts*>(event)); }...
+    };
+
+    TABLE[events.index()](visitor, events.data());
+}
+
+template <typename T>
+struct IsEvents : std::false_type
+{
+};
+
+template <typename... Ts>
+struct IsEvents<Events<Ts...>> : std::true_type
+{
+};
+
+/// @brief true if `T` provides `void flush()`.
+template <typename T, typename = void>
+struct HasFlush : std::false_type
+{
+};
+
+template <typename T>
+struct HasFlush<T, std::void_t<decltype(std::declval<T&>().flush())>> : std::true_type
+{
+};
+
+/// @brief true if `T` provides `static std::uint8_t event_type(const EventT&)`.
+template <typename T, typename EventT, typename = void>
+struct HasEventType : std::false_type
+{
+};
+
+template <typename T, typename EventT>
+struct HasEventType<T, EventT, std::void_t<decltype(T::event_type(std::declval<const EventT&>()))>> : std::true_type
+{
+};
+
+/// @brief true if `T` provides `static AODeadline deadline(const EventT&)`.
+template <typename T, typename EventT, typename = void>
+struct HasDeadline : std::false_type
+{
+};
+
+template <typename T, typename EventT>
+struct HasDeadline<T, EventT, std::void_t<decltype(T::deadline(std::declval<const EventT&>()))>> : std::true_type
+{
+};
+
+/// @brief `T::COMPLETES_DEADLINES`, or false if `T` does not define it.
+template <typename T, typename = void>
+struct CompletesDeadlines : std::false_type
+{
+};
+
+template <typename T>
+struct CompletesDeadlines<T, std::void_t<decltype(T::COMPLETES_DEADLINES)>> : std::bool_constant<T::COMPLETES_DEADLINES>
+{
+};
+
+/// @brief Task stack and control block of an AO. Empty for hosted AOs (`StackWords == 0`).
+template <std::size_t StackWords>
+struct TaskStorage
+{
+    StackType_t stack[StackWords];
+    StaticTask_t task_buffer;
+};
+
+template <>
+struct TaskStorage<0>
+{
+};
+
+/// @brief Statically sized Active Object. `Derived` (CRTP) handles the events:
+///        - If `EventT` is an `Events<...>` set, `Derived` provides one `void on(const T&)` per event type.
+///        - Otherwise `Derived` provides `void on(const EventT&)`.
+///        Handlers run to completion on the AO task, so they must not block. Optional hooks of `Derived`:
+///        - `void flush()`: batch handler, see `AOConfig.flush`.
+///        - `static std::uint8_t event_type(const EventT&)`: event type handler, see `AOConfig.event_type`.
+///        - `static AODeadline deadline(const EventT&)`: deadline handler, see `AOConfig.deadline`.
+///        - `static constexpr bool COMPLETES_DEADLINES`: see `AOConfig.completes_deadlines`.
+/// @tparam Derived Concrete AO.
+/// @tparam EventT Event type. Must be trivially copyable.
+/// @tparam QueueDepth Maximum amount of pending events.
+/// @tparam StackWords Task stack size, in words. 0 for AOs hosted by a queue set, which need no task of their own.
+/// @tparam Priority Task priority, or priority inside its host.
+/// @tparam UrgentDepth Maximum amount of pending urgent events. 0 means no urgent lane.
+template <typename Derived, typename EventT, std::size_t QueueDepth, std::size_t StackWords, UBaseType_t Priority,
+          std::size_t UrgentDepth = 0>
+class ActiveObject
+{
+    static_assert(std::is_trivially_copyable_v<EventT>, "Events are copied into the AO queue");
+    static_assert(QueueDepth > 0 && (StackWords == 0 || StackWords >= configMINIMAL_STACK_SIZE), "Invalid AO sizing");
+    static_assert(Priority < configMAX_PRIORITIES, "Invalid AO priority");
+
+public:
+    /// @brief true if the events are copied straight into the queue storage, false if they go through the event pool.
+    static constexpr bool BY_VALUE = sizeof(EventT) <= AO_EVENT_BY_VALUE_MAX_SIZE;
+
+    ActiveObject() = default;
+    ActiveObject(const ActiveObject&) = delete;
+    ActiveObject& operator=(const ActiveObject&) = delete;
+
+    /// @brief Create the queues and the task. Must be called before starting the scheduler, like `ao_initialize()`.
+    /// @param name Name of the AO and its task.
+    /// @param policy What to do when a lane queue is full.
+    /// @param host Queue set hosting the AO. Required if `StackWords` is 0, must be nullptr otherwise.
+    void start(const char* name, const AOOverflowPolicy policy = AO_OVERFLOW_BLOCK, AOQueueSet* host = nullptr)
+    {
+        AOConfig config = {};
+        config.name = name;
+        config.dispatch = &ActiveObject::trampoline;
+        config.event_size = sizeof(EventT);
+        config.queue_length = QueueDepth;
+        config.queue_storage = queue_storage_;
+        config.priority = Priority;
+        config.overflow_policy = policy;
+        config.block_timeout = portMAX_DELAY;
+
+        if constexpr (StackWords > 0) {
+            configASSERT(host == nullptr);
+            config.stack_depth = StackWords;
+            config.stack = task_.stack;
+            config.task_buffer = &task_.task_buffer;
+        } else {
+            configASSERT(host != nullptr);
+            config.queue_set = host;
+        }
+
+        if constexpr (UrgentDepth > 0) {
+            config.urgent_queue_length = UrgentDepth;
+            config.urgent_queue_storage = urgent_queue_storage_;
+        }
+
+        if constexpr (HasFlush<Derived>::value) {
+            config.flush = &ActiveObject::flush_trampoline;
+        }
+
+        if constexpr (HasEventType<Derived, EventT>::value) {
+            config.event_type = &ActiveObject::event_type_trampoline;
+        }
+
+        if constexpr (HasDeadline<Derived, EventT>::value) {
+            config.deadline = &ActiveObject::deadline_trampoline;
+            config.completes_deadlines = CompletesDeadlines<Derived>::value;
+        }
+
+        ao_initialize(&core_, &config);
+    }
+
+    /// @brief Post an event. See `ao_post()`.
+    bool post(const EventT& event, const TickType_t timeout = portMAX_DELAY)
+    {
+        return ao_post(&core_, &event, timeout);
+    }
+
+    /// @brief Post an event on a given lane. See `ao_post_lane()`.
+    bool post(const EventT& event, const AOLane lane, const TickType_t timeout)
+    {
+        return ao_post_lane(&core_, &event, lane, timeout);
+    }
+
+    /// @brief Post an event from interrupt context. See `ao_post_from_isr()`.
+    bool post_from_isr(const EventT& event, BaseType_t* const woken)
+    {
+        return ao_post_from_isr(&core_, &event, woken);
+    }
+
+    /// @brief Generic C AO, for the C API (pubsub, metrics, registry...).
+    ::ActiveObject* core() { return &core_; }
+
+private:
+    /// @brief Slots of the urgent queue storage: zero sized arrays are not allowed, even if the lane is unused.
+    static constexpr std::size_t URGENT_SLOTS = (UrgentDepth > 0) ? UrgentDepth : 1;
+
+    static Derived& self(::ActiveObject* ao)
+    {
+        // `core_` is the first member of a standard layout class, so both share the same address
+        static_assert(std::is_standard_layout_v<ActiveObject>, "core_ must be pointer-interconvertible");
+        return static_cast<Derived&>(*reinterpret_cast<ActiveObject*>(ao));
+    }
+
+    static void flush_trampoline(::ActiveObject* ao)
+    {
+        self(ao).flush();
+    }
+
+    static std::uint8_t event_type_trampoline(const void* event)
+    {
+        return Derived::event_type(*static_cast<const EventT*>(event));
+    }
+
+    static AODeadline deadline_trampoline(const void* event)
+    {
+        return Derived::deadline(*static_cast<const EventT*>(event));
+    }
+
+    static void trampoline(::ActiveObject* ao, const void* event)
+    {
+        Derived& target = self(ao);
+        const EventT& typed = *static_cast<const EventT*>(event);
+
+        if constexpr (IsEvents<EventT>::value) {
+            visit(target, typed);
+        } else {
+            target.on(typed);
+        }
+    }
+
+    ::ActiveObject core_; ///< Generic AO. Keep it always as the first member!
+    alignas(EventT) std::uint8_t queue_storage_[AO_QUEUE_STORAGE_SIZE(sizeof(EventT), QueueDepth)];
+    alignas(EventT) std::uint8_t urgent_queue_storage_[AO_QUEUE_STORAGE_SIZE(sizeof(EventT), URGENT_SLOTS)];
+    TaskStorage<StackWords> task_;
+};
+
+} // namespace svc
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "SVC_ao.h"
+
+/// @brief Maximum amount of AOs hosted by a single kernel. AO priorities inside a kernel go from 0 (lowest) to
+///        AO_KERNEL_MAX_PRIORITIES - 1 (highest), and must be unique.
+#define AO_KERNEL_MAX_PRIORITIES 32
+
+/// @brief Which ready AO a kernel dispatches next.
+typedef enum
+{
+    AO_KERNEL_PRIORITY = 0, ///< The highest priority ready AO.
+    AO_KERNEL_EDF,          ///< The ready AO whose next event has the earliest deadline (see `AOConfig.deadline`).
+                            ///< AOs without deadlines come after, by priority.
+} AOKernelPolicy;
+
+/// @brief Parameters needed to initialize a cooperative kernel.
+typedef struct
+{
+    const char* name;          ///< Kernel task name.
+    uint32_t stack_depth;      ///< Kernel task stack size, in words. It must fit the deepest dispatch handler.
+    StackType_t* stack;        ///< At least `stack_depth` words.
+    StaticTask_t* task_buffer; ///< Kernel task control block.
+    UBaseType_t priority;      ///< FreeRTOS priority of the kernel task. Use one kernel per priority band.
+    AOKernelPolicy policy;     ///< Dispatch order of the hosted AOs.
+} AOKernelConfig;
+
+/// @brief Cooperative run-to-completion kernel. A single task dispatches every AO attached to it, one event at a time,
+///        always picking the highest priority AO with pending events. AOs hosted by a kernel need no task nor stack
+///        of their own, so the cost of a new AO is just its queue.
+struct AOKernel
+{
+    TaskHandle_t task;                                      ///< Task shared by every hosted AO.
+    uint32_t ready_set;                                     ///< Bit N set: the AO with priority N has pending events.
+    AOKernelPolicy policy;                                  ///< Dispatch order.
+    ActiveObject* active_objects[AO_KERNEL_MAX_PRIORITIES]; ///< Hosted AOs, indexed by priority.
+};
+
+/// @brief Initialize a cooperative kernel. This function must be called before attaching AOs to it, and before
+///        starting the scheduler.
+/// @param kernel Kernel to initialize.
+/// @param config Kernel parameters. It is only read during the call.
+void ao_kernel_initialize(AOKernel* kernel, const AOKernelConfig* const config);
+
+/// @brief Host an AO on a kernel. Called by `ao_initialize()` when `AOConfig.kernel` is set.
+/// @param kernel Hosting kernel.
+/// @param ao Hosted AO.
+/// @param priority Priority of the AO inside the kernel. Must be unique inside the kernel.
+void ao_kernel_attach(AOKernel* kernel, ActiveObject* ao, const UBaseType_t priority);
+
+/// @brief Mark an AO as ready and wake up its kernel. Called after every successful post.
+/// @param kernel Hosting kernel. NULL (AO with its own task) is a no-op.
+/// @param ao AO that got a new event.
+void ao_kernel_signal(AOKernel* kernel, ActiveObject* ao);
+
+/// @brief Same as `ao_kernel_signal()`, but safe to be called from interrupt context.
+/// @param woken Set to pdTRUE if the kernel task has higher priority than the interrupted one.
+void ao_kernel_signal_from_isr(AOKernel* kernel, ActiveObject* ao, BaseType_t* const woken);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "SVC_ao.h"
+
+/// @brief Runtime metrics of an Active Object, merged from its posting and dispatch statistics. It is also the record
+///        of the binary snapshot, so it only holds fixed size fields (no pointers): match records and names by `id`.
+typedef struct
+{
+    uint8_t id;                         ///< AO id.
+    uint8_t priority;                   ///< Task priority, or priority inside its kernel.
+    uint8_t lanes;                      ///< Amount of lanes available.
+    uint8_t last_event_type;            ///< Type of the last dispatched event, or AO_EVENT_TYPE_UNKNOWN.
+    uint32_t posted;                    ///< Events posted, every lane.
+    uint32_t dispatched;                ///< Events dispatched.
+    uint32_t dropped;                   ///< Events dropped, every lane.
+    uint16_t depth[AO_LANES_TOTAL];     ///< Current queue depth of each lane.
+    uint16_t depth_max[AO_LANES_TOTAL]; ///< Maximum queue depth of each lane.
+    uint32_t cycles_min;                ///< Cheapest dispatch, in CPU cycles. 0 if nothing was dispatched.
+    uint32_t cycles_avg;                ///< Average dispatch, in CPU cycles.
+    uint32_t cycles_max;                ///< Most expensive dispatch, in CPU cycles.
+    uint32_t blocked_ticks;             ///< Ticks producers spent blocked on a full queue, every lane.
+    uint32_t deadline_missed;           ///< Events completed after their deadline (see `AODeadlineStats`).
+} AOMetrics;
+
+/// @brief Collect the metrics of an Active Object.
+/// @param ao Active Object.
+/// @param metrics Where the metrics will be stored.
+void ao_metrics_get(ActiveObject* ao, AOMetrics* const metrics);
+
+/// @brief Binary snapshot: collect the metrics of every registered AO, in id order.
+/// @param metrics Array where the metrics will be stored.
+/// @param max_records Length of `metrics`.
+/// @return Amount of records stored.
+size_t ao_metrics_snapshot(AOMetrics* const metrics, const size_t max_records);
+
+/// @brief Text snapshot: format the metrics of every registered AO, one line per AO plus a header line.
+/// @param buffer Where the text will be stored. It is always null terminated.
+/// @param size Size of `buffer`, in bytes.
+/// @return Amount of characters stored (excluding the terminator). Lines that do not fit are left out.
+size_t ao_metrics_format(char* const buffer, const size_t size);
+
+/// @brief Print the text snapshot through the standard output.
+void ao_metrics_print();
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+
+#include "SVC_ao.h"
+
+/// @brief Maximum amount of AOs hosted by a single queue set host.
+#define AO_QSET_MAX_ACTIVE_OBJECTS 8
+
+/// @brief Maximum amount of semaphores (ISR signals) watched by a single queue set host.
+#define AO_QSET_MAX_SIGNALS 4
+
+/// @brief Bytes of queue set storage needed for `length` entries.
+#define AO_QSET_STORAGE_SIZE(length) ((length) * sizeof(QueueSetMemberHandle_t))
+
+/// @brief Which hosted AO gets the CPU when several have pending events.
+typedef enum
+{
+    AO_QSET_FAIR = 0, ///< Events are served in arrival order, whatever AO they belong to.
+    AO_QSET_PRIORITY, ///< The AO with the highest `AOConfig.priority` and pending events is always served first.
+    AO_QSET_EDF,      ///< The AO whose next event has the earliest deadline (see `AOConfig.deadline`). AOs without
+                      ///< deadlines come after, by priority.
+} AOQueueSetPolicy;
+
+/// @brief Handler of a semaphore signal. Runs on the host task, so it must not block.
+/// @param context Context given to `ao_qset_add_signal()`.
+typedef void (*ao_qset_signal_handler_t)(void* context);
+
+/// @brief Parameters needed to initialize a queue set host.
+typedef struct
+{
+    const char* name;          ///< Host task name.
+    uint32_t stack_depth;      ///< Host task stack size, in words. It must fit the deepest dispatch handler.
+    StackType_t* stack;        ///< At least `stack_depth` words.
+    StaticTask_t* task_buffer; ///< Host task control block.
+    UBaseType_t priority;      ///< FreeRTOS priority of the host task.
+    AOQueueSetPolicy policy;   ///< Dispatch order of the hosted AOs.
+    UBaseType_t length;        ///< Queue set length: the sum of the queue lengths (every lane) of the hosted AOs,
+                               ///< plus one per binary semaphore.
+    uint8_t* storage;          ///< At least `AO_QSET_STORAGE_SIZE(length)` bytes.
+} AOQueueSetConfig;
+
+/// @brief Semaphore watched by a queue set host.
+typedef struct
+{
+    SemaphoreHandle_t semaphore;      ///< Binary semaphore given by an ISR.
+    ao_qset_signal_handler_t handler; ///< Called once per take.
+    void* context;                    ///< Argument of `handler`.
+} AOQueueSetSignal;
+
+/// @brief Queue set host. A single task waits on a FreeRTOS queue set that spans the queues of every hosted AO, plus
+///        some semaphores for ISR signals, and dispatches one event at a time. Unlike the cooperative kernel
+///        (SVC_ao_kernel.h), posters need no extra signaling: the queues themselves wake up the host. Each hosted AO
+///        keeps its own queues, API and metrics, and costs no stack nor task control block.
+struct AOQueueSet
+{
+    QueueSetHandle_t set;                                          ///< Set of every hosted queue and semaphore.
+    TaskHandle_t task;                                             ///< Task shared by every hosted AO.
+    AOQueueSetPolicy policy;                                       ///< Dispatch order.
+    UBaseType_t length;                                            ///< Set length.
+    UBaseType_t used;                                              ///< Set entries already claimed by members.
+    ActiveObject* active_objects[AO_QSET_MAX_ACTIVE_OBJECTS];      ///< Hosted AOs.
+    uint8_t active_objects_count;                                  ///< Amount of hosted AOs.
+    AOQueueSetSignal signals[AO_QSET_MAX_SIGNALS];                 ///< Watched semaphores.
+    uint8_t signals_count;                                         ///< Amount of watched semaphores.
+    StaticQueue_t set_buffer;                                      ///< Queue set control block.
+};
+
+/// @brief Initialize a queue set host. This function must be called before attaching AOs to it, and before starting
+///        the scheduler.
+/// @param host Host to initialize.
+/// @param config Host parameters. It is only read during the call.
+void ao_qset_initialize(AOQueueSet* host, const AOQueueSetConfig* const config);
+
+/// @brief Host an AO. Called by `ao_initialize()` when `AOConfig.queue_set` is set, once its queues exist (and are
+///        still empty).
+/// @param host Hosting queue set.
+/// @param ao Hosted AO.
+/// @param length Sum of the lengths of the AO queues.
+void ao_qset_attach(AOQueueSet* host, ActiveObject* ao, const UBaseType_t length);
+
+/// @brief Watch a binary semaphore. Every time an ISR gives it, `handler` runs on the host task. Must be called
+///        before starting the scheduler.
+/// @param host Hosting queue set.
+/// @param semaphore Binary semaphore, still not given.
+/// @param handler Signal handler.
+/// @param context Argument of `handler`.
+void ao_qset_add_signal(AOQueueSet* host, SemaphoreHandle_t semaphore, ao_qset_signal_handler_t handler, void* context);
+
+/// @brief Keep the set entries in step with the queue items, after a poster took an item out of a hosted queue
+///        (AO_OVERFLOW_DROP_OLDEST). Otherwise every dropped item would leave a stale entry behind.
+/// @param host Hosting queue set. NULL (AO not hosted by a queue set) is a no-op.
+void ao_qset_forget(AOQueueSet* host);
+
+/// @brief Same as `ao_qset_forget()`, but safe to be called from interrupt context.
+void ao_qset_forget_from_isr(AOQueueSet* host, BaseType_t* const woken);
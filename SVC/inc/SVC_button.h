@@ -1,5 +1,34 @@
 #pragma once
 
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "HAL_button.h"
+#include "SVC_ao.h"
+#include "SVC_ao_qset.h"
+
+#define BUTTON_AO_QUEUE_LENGTH 8
+#define BUTTON_AO_STACK_DEPTH (2 * configMINIMAL_STACK_SIZE)
+#define BUTTON_AO_PRIORITY (tskIDLE_PRIORITY + 1UL)
+
+/// @brief Set to 1 to host the button AO on a shared queue set host (SVC_ao_qset.h) instead of giving it a task of its
+///        own. The debouncer only handles a sample every BUTTON_SAMPLE_PERIOD_MS, so a whole task is a waste of RAM.
+#define BUTTON_AO_QUEUE_SET_HOSTED 1
+
+/// @brief Period of the button polling, in ms. The USER button has no interrupt, so its level is sampled: a sample
+///        only detects edges, while the debounce and gesture timing comes from one-shot time events.
+#define BUTTON_SAMPLE_PERIOD_MS 5
+
+/// @brief Debouncer and gesture timing, in ms. Shared by the button AO and the coroutine debouncer.
+#define DEBOUNCE_PERIOD_MS 40
+#define EVENT_SHORT_THRESHOLD_MIN_MS 100
+#define EVENT_LONG_THRESHOLD_MIN_MS 2000
+#define EVENT_BLOCKED_THRESHOLD_MIN_MS 8000
+
+/// @brief Set to 1 to debounce the button with a C++20 coroutine (SVC_button_coro.cpp) instead of the button AO. Both
+///        publish the same LED events. SVC_button_coro.cpp is always compiled, and is empty unless this flag is set.
+#define BUTTON_CORO 0
+
 /// @brief Events to be detected by the button task
 typedef enum
 {
@@ -9,4 +38,39 @@ typedef enum
     EVENT_BLOCKED ///< Detected when the button is being pressed in the range >= EVENT_BLOCKED_THRESHOLD_MIN_MS
 } ButtonEvent;
 
-void task_button(void* parameters);
+/// @brief Event received by the button AO. Every one of them is posted by a time event.
+typedef struct
+{
+    uint8_t signal; ///< HSM signal: sample, debounce timeout or gesture threshold.
+} ButtonSignalEvent;
+
+#if !BUTTON_CORO
+/// @brief Initialize the button Active Object (SVC_button_ao.cpp, on top of SVC_ao.hpp) and start polling its button.
+///        The detected gestures are published on TOPIC_LED. This function must be called before starting the
+///        scheduler.
+/// @param ao_task_name Name for the task
+/// @param button Button to be debounced
+/// @param host Queue set host. Must be NULL unless BUTTON_AO_QUEUE_SET_HOSTED is set.
+void button_initialize_ao(const char* ao_task_name, const BoardButtons button, AOQueueSet* host);
+
+/// @brief Generic AO of the button Active Object, for the C API (metrics, registry...).
+ActiveObject* button_ao();
+#endif
+
+/// @brief Record a raw edge of the button: stage 0 of the LED events it ends up triggering (TRACE_ENABLED only).
+void button_edge_detected();
+
+/// @brief Publish on TOPIC_LED the feedback of a gesture threshold reached while the button is held.
+/// @param gesture Gesture just reached
+void button_gesture_reached(const ButtonEvent gesture);
+
+/// @brief Publish on TOPIC_LED the feedback of a debounced release.
+/// @param gesture Last gesture reached before the release
+void button_gesture_released(const ButtonEvent gesture);
+
+#if BUTTON_CORO
+/// @brief Start debouncing a button with a coroutine, on an executor task of its own (SVC_button_coro.cpp). This
+///        function must be called before starting the scheduler.
+/// @param button Button to be debounced
+void button_coro_init(const BoardButtons button);
+#endif
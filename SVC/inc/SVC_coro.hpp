@@ -0,0 +1,572 @@
+#pragma once
+
+/// C++20 coroutines on top of FreeRTOS. Header only. An Executor owns a single FreeRTOS task and runs up to
+/// `MaxCoroutines` coroutines on it, so many small state machines (debouncers, gesture detectors, protocol handlers)
+/// can be written as straight-line code while sharing one stack and one TCB. Coroutine frames come from a static
+/// pool (CORO_FRAME_SLOTS blocks of CORO_FRAME_SIZE bytes), never from the heap.
+///
+///     svc::coro::Task debounce(BoardButtons button)
+///     {
+///         for (;;) {
+///             co_await svc::coro::edge(button, BUTTON_PRESSED);
+///             co_await svc::coro::delay(pdMS_TO_TICKS(20));
+///             if (button_read(button) == BUTTON_PRESSED) {
+///                 ...
+///             }
+///         }
+///     }
+///
+///     static svc::coro::Executor<4, 256, tskIDLE_PRIORITY + 1> executor;
+///     executor.start("coro");
+///     executor.spawn(debounce(USER_BUTTON));
+///
+/// Coroutines are cooperative: they only give the CPU back at a `co_await`, so they must not call blocking APIs.
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+
+#include "HAL_button.h"
+#include "HAL_cycles.h"
+#include "HAL_uart.h"
+}
+
+/// @brief Amount of coroutine frames available, shared by every executor. At most 32.
+#define CORO_FRAME_SLOTS 8
+
+/// @brief Size of each coroutine frame, in bytes. Coroutines whose frame does not fit fail to be created.
+#define CORO_FRAME_SIZE 192
+
+namespace svc::coro
+{
+
+/// @brief Usage statistics of the frame pool.
+struct FramePoolStats
+{
+    std::uint8_t used;     ///< Frames currently in use.
+    std::uint8_t used_max; ///< High-water mark.
+    std::uint32_t failed;  ///< Coroutines that could not be created (pool exhausted or frame too big).
+};
+
+/// @brief Fixed-size block pool for coroutine frames. Constant time, safe to be used from any task.
+class FramePool
+{
+    static_assert(CORO_FRAME_SLOTS > 0 && CORO_FRAME_SLOTS <= 32, "The pool is tracked with a 32-bit mask");
+
+public:
+    void* allocate(const std::size_t size)
+    {
+        void* frame = nullptr;
+
+        taskENTER_CRITICAL();
+        const std::uint32_t FREE = ~used_ & ALL_SLOTS;
+        if (size <= CORO_FRAME_SIZE && FREE != 0) {
+            const unsigned SLOT = __builtin_ctz(FREE);
+            used_ |= 1UL << SLOT;
+            frame = slots_[SLOT];
+            const std::uint8_t USED = __builtin_popcount(used_);
+            stats_.used = USED;
+            if (USED > stats_.used_max) {
+                stats_.used_max = USED;
+            }
+        } else {
+            stats_.failed++;
+        }
+        taskEXIT_CRITICAL();
+
+        return frame;
+    }
+
+    void release(void* const frame)
+    {
+        const std::size_t SLOT = (static_cast<unsigned char*>(frame) - slots_[0]) / CORO_FRAME_SIZE;
+        configASSERT(SLOT < CORO_FRAME_SLOTS);
+
+        taskENTER_CRITICAL();
+        used_ &= ~(1UL << SLOT);
+        stats_.used--;
+        taskEXIT_CRITICAL();
+    }
+
+    FramePoolStats stats()
+    {
+        taskENTER_CRITICAL();
+        const FramePoolStats SNAPSHOT = stats_;
+        taskEXIT_CRITICAL();
+        return SNAPSHOT;
+    }
+
+private:
+    static constexpr std::uint32_t ALL_SLOTS =
+        (CORO_FRAME_SLOTS == 32) ? UINT32_MAX : ((1UL << CORO_FRAME_SLOTS) - 1);
+
+    alignas(std::max_align_t) unsigned char slots_[CORO_FRAME_SLOTS][CORO_FRAME_SIZE];
+    std::uint32_t used_ = 0;
+    FramePoolStats stats_ = {};
+};
+
+/// @brief Pool every coroutine frame is taken from.
+inline FramePool frame_pool;
+
+/// @brief What a suspended coroutine is waiting for. Filled by the awaitables, checked by the executor.
+struct Wait
+{
+    bool (*ready)(void* context) = nullptr; ///< Condition to resume. nullptr if it only waits for the timeout.
+    void* context = nullptr;                ///< Argument of `ready`.
+    TickType_t since = 0;                   ///< Tick count when the wait started.
+    TickType_t ticks = 0;                   ///< Timeout. portMAX_DELAY waits for `ready` only.
+    bool polled = false;                    ///< true if `ready` can not signal the executor, so it is checked every tick.
+};
+
+/// @brief Coroutine run by an Executor. Its frame comes from `frame_pool`: if the pool is exhausted the Task is empty
+///        (evaluates to false) and `Executor::spawn()` rejects it.
+class Task
+{
+public:
+    struct promise_type
+    {
+        Wait wait;                        ///< Current suspension reason.
+        TaskHandle_t* executor = nullptr; ///< Task of the executor running the coroutine, for signaling it.
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        static Task get_return_object_on_allocation_failure() { return Task(nullptr); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { configASSERT(0); }
+
+        static void* operator new(const std::size_t size) noexcept { return frame_pool.allocate(size); }
+        static void operator delete(void* const frame) { frame_pool.release(frame); }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task(Task&& other) : handle_(other.handle_) { other.handle_ = nullptr; }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task()
+    {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    explicit operator bool() const { return static_cast<bool>(handle_); }
+
+    /// @brief Hand the coroutine over (to the executor).
+    Handle release()
+    {
+        const Handle HANDLE = handle_;
+        handle_ = nullptr;
+        return HANDLE;
+    }
+
+private:
+    explicit Task(const Handle handle) : handle_(handle) {}
+
+    Handle handle_;
+};
+
+/// @brief Base of every awaitable: it never completes synchronously and stores its Wait in the promise.
+struct WaitAwaiter
+{
+    Wait wait;
+
+    bool await_ready() const { return false; }
+    void await_suspend(const Task::Handle handle)
+    {
+        wait.since = xTaskGetTickCount();
+        handle.promise().wait = wait;
+    }
+    void await_resume() const {}
+};
+
+/// @brief Suspend the coroutine for `ticks` ticks.
+inline WaitAwaiter delay(const TickType_t ticks)
+{
+    Wait wait;
+    wait.ticks = ticks;
+    return WaitAwaiter{wait};
+}
+
+/// @brief Awaitable returned by `edge()`.
+class EdgeAwaiter
+{
+public:
+    EdgeAwaiter(const BoardButtons button, const ButtonStatus status) : button_(button), status_(status) {}
+
+    bool await_ready() const { return false; }
+    void await_suspend(const Task::Handle handle)
+    {
+        Wait& wait = handle.promise().wait;
+        wait = Wait{};
+        wait.ready = &EdgeAwaiter::ready;
+        wait.context = this;
+        wait.since = xTaskGetTickCount();
+        wait.ticks = portMAX_DELAY;
+        wait.polled = true;
+    }
+    void await_resume() const {}
+
+private:
+    static bool ready(void* context)
+    {
+        EdgeAwaiter* self = static_cast<EdgeAwaiter*>(context);
+        const ButtonStatus STATUS = button_read(self->button_);
+
+        if (STATUS != self->status_) {
+            self->armed_ = true;
+            return false;
+        }
+        return self->armed_;
+    }
+
+    BoardButtons button_;
+    ButtonStatus status_;
+    bool armed_ = false; ///< The opposite level was seen, so reaching `status_` is an edge.
+};
+
+/// @brief Suspend the coroutine until `button` changes to `status`. The button is polled once per tick, since it has
+///        no interrupt.
+inline EdgeAwaiter edge(const BoardButtons button, const ButtonStatus status)
+{
+    return EdgeAwaiter(button, status);
+}
+
+/// @brief Binary signal a coroutine can wait for. Set from a task or an ISR (e.g. a driver completion callback).
+class Signal
+{
+public:
+    /// @brief Set the signal, waking up the coroutine waiting for it.
+    void set()
+    {
+        taskENTER_CRITICAL();
+        pending_ = true;
+        TaskHandle_t const WAITER = waiter_;
+        taskEXIT_CRITICAL();
+
+        if (WAITER != nullptr) {
+            xTaskNotifyGive(WAITER);
+        }
+    }
+
+    /// @brief Same as `set()`, but safe to be called from interrupt context.
+    void set_from_isr(BaseType_t* const woken)
+    {
+        const UBaseType_t MASK = taskENTER_CRITICAL_FROM_ISR();
+        pending_ = true;
+        TaskHandle_t const WAITER = waiter_;
+        taskEXIT_CRITICAL_FROM_ISR(MASK);
+
+        if (WAITER != nullptr) {
+            vTaskNotifyGiveFromISR(WAITER, woken);
+        }
+    }
+
+    /// @brief Forget a pending set. Call it before starting whatever sets the signal, so a set left over by an earlier
+    ///        operation can not complete the next wait.
+    void clear() { take(); }
+
+    /// @brief Awaitable: suspend until the signal is set, and clear it.
+    auto wait()
+    {
+        struct Awaiter
+        {
+            Signal& signal;
+
+            bool await_ready() const { return signal.take(); }
+            void await_suspend(const Task::Handle handle)
+            {
+                Wait& wait = handle.promise().wait;
+                wait = Wait{};
+                wait.ready = &Signal::ready;
+                wait.context = &signal;
+                wait.since = xTaskGetTickCount();
+                wait.ticks = portMAX_DELAY;
+                taskENTER_CRITICAL();
+                signal.waiter_ = *handle.promise().executor;
+                taskEXIT_CRITICAL();
+            }
+            void await_resume() const {}
+        };
+        return Awaiter{*this};
+    }
+
+private:
+    template <typename, std::size_t>
+    friend class Mailbox;
+
+    bool take()
+    {
+        taskENTER_CRITICAL();
+        const bool PENDING = pending_;
+        pending_ = false;
+        taskEXIT_CRITICAL();
+        return PENDING;
+    }
+
+    static bool ready(void* context) { return static_cast<Signal*>(context)->take(); }
+
+    volatile bool pending_ = false;
+    TaskHandle_t volatile waiter_ = nullptr;
+};
+
+/// | UART completion. Plug `on_uart_tx_done()` / `on_uart_rx_done()` as the callbacks of `uart_init()`.
+
+inline Signal uart_tx_done[UART_INSTANCE_TOTAL];
+inline Signal uart_rx_done[UART_INSTANCE_TOTAL];
+
+/// @brief UART TX done callback (interrupt context).
+inline void on_uart_tx_done(const UARTInstance instance)
+{
+    BaseType_t woken = pdFALSE;
+    uart_tx_done[instance].set_from_isr(&woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/// @brief UART RX done callback (interrupt context).
+inline void on_uart_rx_done(const UARTInstance instance)
+{
+    BaseType_t woken = pdFALSE;
+    uart_rx_done[instance].set_from_isr(&woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/// @brief Send over UART and suspend until the transmission ends: `co_await uart_send_async(...)`.
+inline auto uart_send_async(const UARTInstance instance, std::uint8_t* data, const std::size_t size)
+{
+    // A completion nobody waited for (e.g. a blocking uart_send() on the same instance) must not end this wait early
+    uart_tx_done[instance].clear();
+    uart_send(instance, data, size);
+    return uart_tx_done[instance].wait();
+}
+
+/// @brief Start a UART reception and suspend until it ends: `co_await uart_receive_async(...)`.
+inline auto uart_receive_async(const UARTInstance instance, std::uint8_t* data, const std::size_t size)
+{
+    uart_rx_done[instance].clear();
+    uart_receive(instance, data, size);
+    return uart_rx_done[instance].wait();
+}
+
+/// @brief Event queue a coroutine receives from, the coroutine counterpart of an AO queue. Statically allocated.
+/// @tparam EventT Event type. Copied by value.
+/// @tparam Depth Maximum amount of pending events.
+template <typename EventT, std::size_t Depth>
+class Mailbox
+{
+public:
+    /// @brief Create the queue. Must be called before posting or receiving.
+    void init(const char* name)
+    {
+        queue_ = xQueueCreateStatic(Depth, sizeof(EventT), storage_, &queue_buffer_);
+        configASSERT(queue_ != nullptr);
+        vQueueAddToRegistry(queue_, name);
+    }
+
+    /// @brief Post an event. See `ao_post()`.
+    bool post(const EventT& event, const TickType_t timeout)
+    {
+        if (xQueueSendToBack(queue_, &event, timeout) != pdPASS) {
+            return false;
+        }
+        signal_.set();
+        return true;
+    }
+
+    /// @brief Same as `post()`, but safe to be called from interrupt context.
+    bool post_from_isr(const EventT& event, BaseType_t* const woken)
+    {
+        if (xQueueSendToBackFromISR(queue_, &event, woken) != pdPASS) {
+            return false;
+        }
+        signal_.set_from_isr(woken);
+        return true;
+    }
+
+    /// @brief Awaitable: `EventT event = co_await mailbox.receive();`
+    auto receive()
+    {
+        struct Awaiter
+        {
+            Mailbox& mailbox;
+            EventT event;
+
+            bool await_ready()
+            {
+                // The queue is the state, the signal only wakes the executor up: clear it before looking at the queue,
+                // so a post racing with this check sets it again instead of being lost
+                mailbox.signal_.clear();
+                return xQueueReceive(mailbox.queue_, &event, 0) == pdPASS;
+            }
+            void await_suspend(const Task::Handle handle)
+            {
+                Wait& wait = handle.promise().wait;
+                wait = Wait{};
+                wait.ready = &Awaiter::ready;
+                wait.context = this;
+                wait.since = xTaskGetTickCount();
+                wait.ticks = portMAX_DELAY;
+                taskENTER_CRITICAL();
+                mailbox.signal_.waiter_ = *handle.promise().executor;
+                taskEXIT_CRITICAL();
+            }
+            EventT await_resume() const { return event; }
+
+            static bool ready(void* context) { return static_cast<Awaiter*>(context)->await_ready(); }
+        };
+        return Awaiter{*this, EventT{}};
+    }
+
+private:
+    QueueHandle_t queue_ = nullptr;
+    StaticQueue_t queue_buffer_;
+    std::uint8_t storage_[Depth * sizeof(EventT)];
+    Signal signal_; ///< Only used for waking up the executor: the queue holds the events.
+};
+
+/// @brief Executor statistics. A switch is one `resume()`: from the executor into the coroutine and back at its next
+///        `co_await`, so it includes the coroutine code in between.
+struct ExecutorStats
+{
+    std::uint32_t switches;     ///< Coroutine resumes.
+    std::uint32_t cycles_min;   ///< Cheapest switch.
+    std::uint32_t cycles_max;   ///< Most expensive switch.
+    std::uint64_t cycles_total; ///< Total cycles spent in switches, for the average.
+};
+
+/// @brief Runs coroutines on one FreeRTOS task.
+/// @tparam MaxCoroutines Maximum amount of coroutines alive at the same time.
+/// @tparam StackWords Task stack size, in words. Shared by every coroutine (frames live in `frame_pool`).
+/// @tparam Priority Task priority.
+template <std::size_t MaxCoroutines, std::size_t StackWords, UBaseType_t Priority>
+class Executor
+{
+    static_assert(MaxCoroutines > 0 && StackWords >= configMINIMAL_STACK_SIZE, "Invalid executor sizing");
+    static_assert(Priority < configMAX_PRIORITIES, "Invalid executor priority");
+
+public:
+    /// @brief RAM used by the executor and `MaxCoroutines` frames, in bytes. Compare it against one native task per
+    ///        coroutine: MaxCoroutines * (sizeof(StaticTask_t) + stack).
+    static constexpr std::size_t ram_bytes() { return sizeof(Executor) + MaxCoroutines * CORO_FRAME_SIZE; }
+
+    /// @brief Create the executor task.
+    void start(const char* name)
+    {
+        task_ = xTaskCreateStatic(&Executor::run, name, StackWords, this, Priority, stack_, &task_buffer_);
+        configASSERT(task_ != nullptr);
+    }
+
+    /// @brief Schedule a coroutine. It starts running at the next executor iteration.
+    /// @return false if the coroutine could not be created or every slot is taken.
+    bool spawn(Task&& task)
+    {
+        if (!task) {
+            return false;
+        }
+
+        bool spawned = false;
+        taskENTER_CRITICAL();
+        for (Task::Handle& handle : handles_) {
+            if (!handle) {
+                handle = task.release();
+                handle.promise().executor = &task_;
+                spawned = true;
+                break;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if (spawned && task_ != nullptr) {
+            xTaskNotifyGive(task_);
+        }
+        return spawned;
+    }
+
+    ExecutorStats stats()
+    {
+        taskENTER_CRITICAL();
+        const ExecutorStats SNAPSHOT = stats_;
+        taskEXIT_CRITICAL();
+        return SNAPSHOT;
+    }
+
+private:
+    static void run(void* parameters)
+    {
+        Executor* self = static_cast<Executor*>(parameters);
+
+        for (;;) {
+            ulTaskNotifyTake(pdTRUE, self->step());
+        }
+    }
+
+    /// @brief Resume every coroutine whose wait is over.
+    /// @return Ticks until the next timeout, or portMAX_DELAY if everything waits for a signal.
+    TickType_t step()
+    {
+        const TickType_t NOW = xTaskGetTickCount();
+        TickType_t next = portMAX_DELAY;
+
+        for (Task::Handle& handle : handles_) {
+            if (!handle) {
+                continue;
+            }
+
+            const Wait& WAIT = handle.promise().wait;
+            const TickType_t ELAPSED = NOW - WAIT.since;
+            const bool TIMED_OUT = (WAIT.ticks != portMAX_DELAY) && (ELAPSED >= WAIT.ticks);
+
+            if (!TIMED_OUT && !(WAIT.ready != nullptr && WAIT.ready(WAIT.context))) {
+                if (WAIT.polled) {
+                    next = 1;
+                } else if (WAIT.ticks != portMAX_DELAY && (WAIT.ticks - ELAPSED) < next) {
+                    next = WAIT.ticks - ELAPSED;
+                }
+                continue;
+            }
+
+            const std::uint32_t START = cycles_now();
+            handle.resume();
+            record(cycles_now() - START);
+
+            if (handle.done()) {
+                taskENTER_CRITICAL();
+                handle.destroy();
+                handle = nullptr;
+                taskEXIT_CRITICAL();
+            } else {
+                next = 0; // Its new wait may already be over
+            }
+        }
+
+        return next;
+    }
+
+    void record(const std::uint32_t cycles)
+    {
+        taskENTER_CRITICAL();
+        if (stats_.switches == 0 || cycles < stats_.cycles_min) {
+            stats_.cycles_min = cycles;
+        }
+        if (cycles > stats_.cycles_max) {
+            stats_.cycles_max = cycles;
+        }
+        stats_.switches++;
+        stats_.cycles_total += cycles;
+        taskEXIT_CRITICAL();
+    }
+
+    Task::Handle handles_[MaxCoroutines] = {};
+    TaskHandle_t task_ = nullptr;
+    ExecutorStats stats_ = {};
+    StackType_t stack_[StackWords];
+    StaticTask_t task_buffer_;
+};
+
+} // namespace svc::coro
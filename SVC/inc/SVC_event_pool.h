@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Block-size classes handled by the event pool. Each class is a static array of equally sized blocks.
+///        Requests are served by the smallest class whose block size fits the requested size.
+typedef enum
+{
+    EVENT_POOL_SMALL = 0, ///< Blocks of EVENT_POOL_SMALL_BLOCK_SIZE bytes
+    EVENT_POOL_MEDIUM,    ///< Blocks of EVENT_POOL_MEDIUM_BLOCK_SIZE bytes
+    EVENT_POOL_LARGE,     ///< Blocks of EVENT_POOL_LARGE_BLOCK_SIZE bytes
+    EVENT_POOL_TOTAL,     ///< Total amount of pools. Keep this value always at the bottom!
+} EventPoolClass;
+
+/// @brief Usage statistics of a single pool.
+typedef struct
+{
+    size_t block_size;   ///< Size of each block, in bytes
+    size_t blocks_total; ///< Amount of blocks owned by the pool
+    size_t blocks_free;  ///< Amount of blocks currently available
+    size_t blocks_max;   ///< High-water mark: maximum amount of blocks that were in use at the same time
+    uint32_t exhausted;  ///< Times a request for this class found no free block
+} EventPoolStats;
+
+/// | Pool sizing. Block sizes must be multiples of the pointer size.
+
+#define EVENT_POOL_SMALL_BLOCK_SIZE 8
+#define EVENT_POOL_SMALL_BLOCKS 32
+#define EVENT_POOL_MEDIUM_BLOCK_SIZE 32
+#define EVENT_POOL_MEDIUM_BLOCKS 16
+#define EVENT_POOL_LARGE_BLOCK_SIZE 128
+#define EVENT_POOL_LARGE_BLOCKS 8
+
+/// @brief Initialize every pool, chaining all of its blocks in the free list.
+///        This function must be called before starting the scheduler and before any other event_pool_* call.
+void event_pool_init();
+
+/// @brief Get a block of at least `size` bytes. If the best fitting class is exhausted the next bigger one is tried.
+///        Runs in constant time and never touches the FreeRTOS heap. The block starts with a single reference.
+/// @param size Requested size, in bytes.
+/// @return Pointer to the block, or NULL if no class can serve the request.
+void* event_pool_get(const size_t size);
+
+/// @brief Same as `event_pool_get()`, but safe to be called from interrupt context.
+void* event_pool_get_from_isr(const size_t size);
+
+/// @brief Drop one reference of a block. The block goes back to the pool it was taken from once its last reference
+///        is dropped. Runs in constant time.
+/// @param block Block previously obtained with `event_pool_get()`. Passing NULL is a no-op.
+void event_pool_put(void* const block);
+
+/// @brief Same as `event_pool_put()`, but safe to be called from interrupt context.
+void event_pool_put_from_isr(void* const block);
+
+/// @brief Add references to a block, so it can be shared by several owners (e.g. the subscribers of a topic) without
+///        being copied. Each owner must call `event_pool_put()` once it is done with it.
+/// @param block Block previously obtained with `event_pool_get()`. It must hold at least one reference.
+/// @param references Amount of references to add.
+void event_pool_retain(void* const block, const uint8_t references);
+
+/// @brief Same as `event_pool_retain()`, but safe to be called from interrupt context.
+void event_pool_retain_from_isr(void* const block, const uint8_t references);
+
+/// @brief Get a snapshot of the usage statistics of a pool.
+/// @param pool Must be one of the defined in EventPoolClass.
+/// @param stats Where the snapshot will be stored.
+void event_pool_get_stats(const EventPoolClass pool, EventPoolStats* const stats);
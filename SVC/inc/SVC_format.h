@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stddef.h>
+
+/// | Small printf-like formatter. Reentrant (no static state, no newlib `struct _reent`), allocation-free, and with a
+/// | bounded stack: no recursion, and at most FORMAT_CHUNK_SIZE bytes of output buffered by `format_printf()`.
+/// |
+/// | Supported: %d %i %u %x %X %o %c %s %p %%, the flags `-0+ #`, width and precision (also as `*`), and the length
+/// | modifiers hh h l ll z j t. Floating point is not: %f %e %g and %a print "?" (their argument is still consumed).
+
+/// @brief Output of `format_printf()` gathered before each write to the console.
+#define FORMAT_CHUNK_SIZE 32
+
+/// @brief Let the compiler check the arguments against the format string, as it does for printf().
+#define FORMAT_PRINTF(format_index, first_argument) __attribute__((format(printf, format_index, first_argument)))
+
+/// @brief Where the formatted text goes.
+/// @param data Text to be written. Not null terminated.
+/// @param length Length of `data`.
+/// @param context Context given to `format_vwrite()`.
+typedef void (*format_write_t)(const char* data, const size_t length, void* context);
+
+/// @brief Format text in chunks of up to FORMAT_CHUNK_SIZE bytes.
+/// @param write Where the chunks go.
+/// @param context Passed to `write` as is.
+/// @param format printf-like format string.
+/// @param arguments Arguments of the format string.
+/// @return Length of the whole text.
+size_t format_vwrite(format_write_t write, void* context, const char* format, va_list arguments);
+
+/// @brief Same as vsnprintf().
+/// @return Length the whole text would take, without the terminator. Only the first `size - 1` bytes are stored.
+int format_vsnprintf(char* buffer, const size_t size, const char* format, va_list arguments);
+
+/// @brief Same as snprintf().
+int format_snprintf(char* buffer, const size_t size, const char* format, ...) FORMAT_PRINTF(3, 4);
+
+/// @brief Same as printf(), on the SWV console. Lines printed by different tasks at the same time may interleave, one
+///        chunk at a time.
+int format_printf(const char* format, ...) FORMAT_PRINTF(1, 2);
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// @brief Maximum nesting depth of a state machine (the top state has depth 1). Bounds every dispatch and transition.
+#define HSM_MAX_DEPTH 6
+
+/// @brief Transition paths cached by each state machine, one per (source state, target) pair. Machines with more
+///        distinct pairs still work, but the least recently computed path is evicted and computed again when needed.
+#define HSM_PATH_CACHE_SIZE 8
+
+/// @brief Signals reserved by the engine. User signals start at HSM_SIGNAL_USER.
+typedef enum
+{
+    HSM_SIGNAL_ENTRY = 0, ///< The state is being entered.
+    HSM_SIGNAL_EXIT,      ///< The state is being exited.
+    HSM_SIGNAL_INIT,      ///< The state is composite and its initial child is about to be entered.
+    HSM_SIGNAL_USER,      ///< First signal available for the application.
+} HSMReservedSignal;
+
+typedef uint8_t HSMSignal;
+
+/// @brief What a state handler did with a signal.
+typedef enum
+{
+    HSM_HANDLED = 0, ///< Signal consumed.
+    HSM_UNHANDLED,   ///< Signal not handled by this state: the parent state will get it.
+    HSM_TRANSITION,  ///< Signal consumed, and a transition was requested with `hsm_transition()`.
+} HSMStatus;
+
+typedef struct HSM HSM;
+typedef struct HSMState HSMState;
+
+/// @brief State handler. It must not block.
+/// @param hsm State machine.
+/// @param signal Signal to be processed.
+/// @param event Event that carried the signal. NULL for reserved signals.
+/// @return What the state did with the signal.
+typedef HSMStatus (*hsm_handler_t)(HSM* hsm, const HSMSignal signal, const void* event);
+
+/// @brief State descriptor. States are usually `static const` and form a tree through `parent`.
+struct HSMState
+{
+    const char* name;        ///< State name. Used for debugging purposes.
+    const HSMState* parent;  ///< Parent state, or NULL for the top state.
+    hsm_handler_t handler;   ///< State handler.
+    const HSMState* initial; ///< Child entered when this (composite) state is the target of a transition. NULL for leaves.
+};
+
+/// @brief Transition descriptor. Declare one per transition with `HSM_TRANSITION_TO()`, as a `static const` variable:
+///        it is never written, so any amount of state machines (on any amount of tasks) can share it.
+typedef struct
+{
+    const HSMState* target; ///< Target state.
+} HSMTransition;
+
+/// @brief Path of a transition, computed the first time a state machine takes it from a given source state and
+///        cached in that state machine. It only depends on the source and the target: the states exited are the
+///        chain from the leaf state up to `ancestor`, which needs no search of the state tree.
+typedef struct
+{
+    const HSMState* source;                    ///< State whose handler requested the transition. NULL for a free slot.
+    const HSMState* target;                    ///< Target state.
+    const HSMState* ancestor;                  ///< Deepest state neither exited nor entered. NULL for the whole tree.
+    uint8_t entry_count;                       ///< Amount of states in `entry_path`.
+    uint8_t initial_index;                     ///< First `entry_path` index reached through `initial` children.
+    const HSMState* entry_path[HSM_MAX_DEPTH]; ///< States to enter, outermost first (including initial children).
+} HSMPath;
+
+/// @brief Dispatch statistics, in CPU cycles.
+typedef struct
+{
+    uint32_t dispatches;   ///< Amount of dispatched signals.
+    uint32_t cycles_last;  ///< Cost of the last dispatch.
+    uint32_t cycles_max;   ///< Cost of the most expensive dispatch.
+    uint32_t cache_misses; ///< Transitions whose path had to be computed.
+} HSMStats;
+
+/// @brief Hierarchical State Machine.
+struct HSM
+{
+    const HSMState* state;              ///< Current (leaf) state.
+    const HSMTransition* pending;       ///< Transition requested by the running handler.
+    void* context;                      ///< Owner of the state machine. Available to the handlers.
+    HSMStats stats;                     ///< Dispatch statistics.
+    HSMPath paths[HSM_PATH_CACHE_SIZE]; ///< Path cache. Only touched by the task dispatching to this state machine.
+    uint8_t paths_next;                 ///< Slot the next computed path goes to.
+};
+
+/// @brief Declare a transition to `target_state`.
+#define HSM_TRANSITION_TO(target_state) {.target = (target_state)}
+
+/// @brief Initialize a state machine and enter its initial state: every state from the top down to `initial` gets
+///        an ENTRY, followed by its initial children chain (INIT + ENTRY).
+/// @param hsm State machine to initialize.
+/// @param initial Initial state.
+/// @param context Owner of the state machine.
+void hsm_initialize(HSM* hsm, const HSMState* initial, void* context);
+
+/// @brief Dispatch a signal to the current state. Unhandled signals bubble up to the parent states (at most
+///        HSM_MAX_DEPTH handlers are invoked). Any requested transition is executed before returning.
+/// @param hsm State machine.
+/// @param signal Signal to be dispatched. Must be >= HSM_SIGNAL_USER.
+/// @param event Event that carried the signal.
+void hsm_dispatch(HSM* hsm, const HSMSignal signal, const void* event);
+
+/// @brief Request a transition. Must be called from a state handler, returning its result.
+/// @param hsm State machine.
+/// @param transition Transition to be taken.
+/// @return HSM_TRANSITION
+HSMStatus hsm_transition(HSM* hsm, const HSMTransition* transition);
+
+/// @brief Check whether the state machine is in a state (or any of its children).
+/// @param hsm State machine.
+/// @param state State to check.
+/// @return true if `state` is the current state or one of its ancestors.
+bool hsm_is_in(const HSM* hsm, const HSMState* state);
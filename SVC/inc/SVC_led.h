@@ -1,10 +1,25 @@
 #pragma once
 
 #include "FreeRTOS.h"
-#include "queue.h"
 #include "task.h"
 
 #include "HAL_led.h"
+#include "SVC_ao.h"
+#include "SVC_trace.h"
+
+#define LED_AO_QUEUE_LENGTH 16
+#define LED_AO_URGENT_QUEUE_LENGTH 4
+#define LED_AO_STACK_DEPTH (2 * configMINIMAL_STACK_SIZE)
+#define LED_AO_PRIORITY (tskIDLE_PRIORITY + 1UL)
+
+/// @brief Most events folded into a batch before it is written, even if more events are pending. Under sustained
+///        traffic the queues never run empty, so without a cap the LEDs would never be updated.
+#define LED_BATCH_MAX_EVENTS 8
+
+/// @brief Set to 1 to host the LED AO on a shared queue set host (SVC_ao_qset.h) instead of giving it a task of its own.
+///        The LED AO then keeps its queues, API and metrics, but needs no stack nor task control block, and the EDF
+///        policy of the host orders its events by deadline.
+#define LED_AO_QUEUE_SET_HOSTED 1
 
 /// @brief Type of events handled by the LED AO
 typedef enum
@@ -12,6 +27,8 @@ typedef enum
     LED_EVENT_ON,     ///< Turn on a LED
     LED_EVENT_OFF,    ///< Turn off a LED
     LED_EVENT_TOGGLE, ///< Toggle a LED
+    LED_EVENT_BLOCK,   ///< Enter blocked mode: the LEDs stay on until LED_EVENT_UNBLOCK
+    LED_EVENT_UNBLOCK, ///< Leave blocked mode: the LEDs turned on by LED_EVENT_BLOCK are turned off
 } LEDEventType;
 
 /// @brief Wrapper for LEDs between Application <-> HAL
@@ -21,26 +38,89 @@ typedef enum
     LED_RED = LED3,   ///< Red LED
 } ApplicationLEDs;
 
-/// @brief Struct that determines a LED Event itself. It consists of two thigs:
+/// @brief Bit of an ApplicationLEDs value inside `LEDEvent.leds`.
+#define LED_MASK(led) ((uint8_t)(1U << (led)))
+
+/// @brief Struct that determines a LED Event itself. It consists of two thigs, plus an optional deadline.
+///        Both fields are stored in a single byte (instead of an int-sized enum) so the whole event fits in 8 bytes
+///        and can be posted by value.
 typedef struct
 {
-    ApplicationLEDs led; ///< Which LED we want to handle
-    LEDEventType type;   ///< What action do we need to perform on the LED
+    uint8_t leds; ///< Which LEDs we want to handle. Bitmask built with LED_MASK() of ApplicationLEDs values
+    uint8_t type; ///< What action do we need to perform on the LEDs. Must be one of LEDEventType
+#if TRACE_ENABLED
+    TraceId trace_id; ///< Sequence id of the event. TRACE_ID_NONE if it is not traced
+#endif
+    AODeadline deadline; ///< When the LEDs must reflect the event (see `ao_deadline_in()`), or AO_DEADLINE_NONE
 } LEDEvent;
 
-/// @brief LED Active Object. It basically consists of an event queue and a Task that process the queue.
+/// @brief LED actions folded while draining a burst of events, applied with a single write per GPIO port once the
+///        queues are empty, or once LED_BATCH_MAX_EVENTS events were folded. Each LED is in at most one of the masks.
+typedef struct
+{
+    uint8_t on;     ///< LEDs to be turned on
+    uint8_t off;    ///< LEDs to be turned off
+    uint8_t toggle; ///< LEDs to be toggled
+    uint8_t events; ///< Events folded since the last flush
+    AODeadline deadlines[LED_BATCH_MAX_EVENTS]; ///< Deadlines of the events folded since the last flush. They are
+                                                ///< met or missed when the LEDs are written, not when dispatched.
+    uint8_t deadlined;                          ///< Amount of `deadlines`
+#if TRACE_ENABLED
+    TraceId trace_ids[LED_BATCH_MAX_EVENTS]; ///< Traced events folded since the last flush, from either lane
+    uint8_t traced;                          ///< Amount of `trace_ids`
+#endif
+} LEDBatch;
+
+/// @brief Batching statistics of the LED AO.
 typedef struct
 {
-    QueueHandle_t queue;
-    TaskHandle_t* task;
-} LEDActiveObject;
+    uint32_t events_coalesced;    ///< Events folded into a batch that already had pending events
+    uint32_t gpio_writes;         ///< GPIO port (BSRR) writes performed
+    uint32_t gpio_writes_avoided; ///< Per-LED writes the event-by-event approach would have performed, minus `gpio_writes`
+    uint32_t flushes_capped;      ///< Batches written early because they reached LED_BATCH_MAX_EVENTS
+} LEDBatchStats;
 
-/// @brief Initialize the LED Active Object. By default This function will assign `task_led()` to the task field
-/// @param ao Active Object to initialize
+/// @brief Initialize the LED Active Object (SVC_led_ao.cpp, on top of SVC_ao.hpp). Its events are dispatched by the
+///        generic AO task, or by `host` when LED_AO_QUEUE_SET_HOSTED is set.
 /// @param ao_task_name Name for the task
-void led_initialize_ao(LEDActiveObject* ao, const char* ao_task_name);
+/// @param host Queue set host. Must be NULL unless LED_AO_QUEUE_SET_HOSTED is set.
+void led_initialize_ao(const char* ao_task_name, AOQueueSet* host);
+
+/// @brief Generic AO of the LED Active Object, for the C API (pubsub, metrics...).
+ActiveObject* led_ao();
+
+/// @brief Get a snapshot of the batching statistics of the LED AO.
+/// @param stats Where the snapshot will be stored
+void led_ao_get_batch_stats(LEDBatchStats* const stats);
+
+/// @brief Post an Event to the LED Active Object queue. Producers that don't need to know the consumers should
+///        publish on TOPIC_LED instead.
+/// @param event event to be sent. It is copied, so the caller keeps its ownership.
+void led_ao_send_event(const LEDEvent* const event);
+
+/// @brief Same as `led_ao_send_event()`, but safe to be called from interrupt context. Call `ao_isr_yield()` once at the
+///        end of the ISR.
+/// @param event event to be sent. It is copied, so the caller keeps its ownership.
+/// @param woken Set to pdTRUE if the LED AO task has higher priority than the interrupted one.
+/// @return true if the event was queued.
+bool led_ao_send_event_from_isr(const LEDEvent* const event, BaseType_t* const woken);
+
+/// @brief Account for an event about to be folded into a batch (and record its deadline and trace id).
+/// @param batch Pending batch
+/// @param event Received LEDEvent
+/// @return true if the batch already had pending events.
+bool led_batch_add(LEDBatch* batch, const LEDEvent* const event);
+
+/// @brief Fold an LED action on every LED of a mask into a batch. ON and OFF override any previous action, and two
+///        toggles cancel out. Nothing is written until `led_batch_write()`.
+/// @param batch Pending batch
+/// @param leds Bitmask built with LED_MASK()
+/// @param type LED_EVENT_ON, LED_EVENT_OFF or LED_EVENT_TOGGLE
+/// @return Per-LED writes folded, i.e. the ones an event-by-event approach would have performed.
+uint8_t led_batch_fold(LEDBatch* batch, const uint8_t leds, const LEDEventType type);
 
-/// @brief Post an Event to the LED Active Object queue.
-/// @param ao Receiver of the event
-/// @param event event to be sent
-void led_ao_send_event(LEDActiveObject* ao, LEDEvent* const event);
\ No newline at end of file
+/// @brief Write a batch to the LEDs with a single write per GPIO port, report its deadlines as done, then clear it.
+/// @param batch Pending batch
+/// @param ao LED AO the batch belongs to. It must have been initialized with `AOConfig.completes_deadlines`.
+/// @return GPIO port writes performed.
+uint8_t led_batch_write(LEDBatch* batch, ActiveObject* ao);
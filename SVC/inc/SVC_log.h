@@ -0,0 +1,221 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/// @brief Set to 0 to compile every LOG_*() call out.
+#define LOG_ENABLED 1
+
+/// | Severity levels. Plain defines, so they can be compared by the preprocessor too.
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_OFF 4
+
+/// @brief Build-wide floor: calls below it are compiled out in every module. Production builds should raise it to
+///        LOG_LEVEL_INFO or above.
+#define LOG_LEVEL_FLOOR LOG_LEVEL_DEBUG
+
+/// | Per-module thresholds. Each module selects its own with `#define LOG_MODULE_LEVEL LOG_LEVEL_<MODULE>` before its
+/// | includes. Calls below the threshold of their module (or below the floor) are compiled out: no code, no argument
+/// | evaluation, no format string.
+
+#define LOG_LEVEL_AO LOG_LEVEL_INFO
+#define LOG_LEVEL_BUTTON LOG_LEVEL_INFO
+#define LOG_LEVEL_LED LOG_LEVEL_INFO
+#define LOG_LEVEL_UART LOG_LEVEL_INFO
+#define LOG_LEVEL_LOG LOG_LEVEL_INFO
+
+/// @brief Threshold of modules that do not select one.
+#define LOG_LEVEL_DEFAULT LOG_LEVEL_INFO
+
+#ifndef LOG_MODULE_LEVEL
+#define LOG_MODULE_LEVEL LOG_LEVEL_DEFAULT
+#endif
+
+/// | Record rings. Every logging task, and every interrupt priority level, writes to a ring of its own, so writers
+/// | never take a lock nor wait for each other. Sizes are in 32-bit words: a record takes 3 words plus one per argument.
+
+#define LOG_TASK_RING_WORDS 128
+#define LOG_ISR_RING_WORDS 64
+
+/// @brief Amount of tasks that get a ring, taken on their first log. Logs of further tasks are dropped, and counted
+///        as unregistered. The ring of a deleted task is handed to the next new task once drained.
+#define LOG_MAX_TASKS 8
+
+/// @brief Amount of interrupt priority levels that get a ring. Same as LOG_MAX_TASKS, for levels.
+#define LOG_MAX_ISR_LEVELS 4
+
+/// @brief Maximum amount of arguments of a single LOG_*() call.
+#define LOG_MAX_ARGS 6
+
+/// @brief Runtime threshold at boot. See `log_set_threshold()`.
+#define LOG_THRESHOLD_DEFAULT LOG_LEVEL_DEBUG
+
+/// @brief Record source of logs done from interrupt context, by interrupt priority level. Tasks are sources 0 to
+///        LOG_MAX_TASKS - 1.
+#define LOG_SOURCE_ISR_BASE 0xF0U
+#define LOG_SOURCE_ISR(level) ((uint8_t)(LOG_SOURCE_ISR_BASE | (level)))
+
+/// @brief ELF section holding every LOG_*() format string. The linker script keeps it out of the flash image (INFO
+///        section): the target only ever handles the string addresses, which `Tools/log/log_decode.py` maps back to
+///        the strings using the ELF file.
+#define LOG_FORMAT_SECTION ".log_fmt"
+
+/// @brief Kinds of records shipped by the drain task.
+typedef enum
+{
+    LOG_RECORD_MESSAGE = 0, ///< A LOG_*() call: format address, timestamp and raw arguments.
+    LOG_RECORD_SOURCE,      ///< Name of a record source, as plain characters.
+    LOG_RECORD_CLOCK,       ///< Frequency of the timestamps, in Hz.
+} LogRecordKind;
+
+/// @brief Output of the drain task. Each call carries a whole COBS frame, delimiter included.
+/// @param data Bytes to be written.
+/// @param size Amount of bytes.
+typedef void (*log_sink_t)(const uint8_t* data, const size_t size);
+
+/// @brief Called by the drain task after each burst of frames, so a sink that buffers (e.g. a compressor) can push
+///        its data out before the drain task goes to sleep.
+typedef void (*log_flush_t)();
+
+/// @brief Usage statistics of the log, all rings together.
+typedef struct
+{
+    uint32_t written;      ///< Records stored in a ring.
+    uint32_t dropped;      ///< Records lost because their ring was full.
+    uint32_t drained;      ///< Records shipped by the drain task.
+    uint32_t unregistered; ///< Records lost because their task or interrupt level got no ring.
+} LogStats;
+
+/// @brief Usage statistics of a single ring.
+typedef struct
+{
+    const char* name; ///< Task name ("boot" before the scheduler starts), or "ISR<level>". Latest owner of the ring.
+    uint8_t source;   ///< Record source of the ring.
+    uint32_t written; ///< Records stored.
+    uint32_t dropped; ///< Records lost because the ring was full.
+    size_t used_max;  ///< High-water mark, in words.
+    size_t size;      ///< Capacity, in words.
+} LogRingStats;
+
+/// @brief Parameters needed to initialize the log.
+typedef struct
+{
+    log_sink_t sink;           ///< Where the drain task ships the records.
+    log_flush_t flush;         ///< End of each burst of frames. Optional.
+    uint32_t stack_depth;      ///< Drain task stack size, in words.
+    StackType_t* stack;        ///< At least `stack_depth` words.
+    StaticTask_t* task_buffer; ///< Drain task control block.
+    UBaseType_t priority;      ///< FreeRTOS priority of the drain task. Meant to be the lowest one.
+    uint32_t period_ms;        ///< How often the drain task wakes up. Logging itself never wakes it up.
+} LogConfig;
+
+/// | Argument packing. Every argument is shipped as a raw 32-bit word: integers, characters and pointers. `%s`
+/// | arguments must point to constant strings, which the decoder reads from the ELF file. No floating point.
+
+#define LOG_ARG(x) ((uint32_t)(uintptr_t)(x))
+#define LOG_CAT(a, b) LOG_CAT_(a, b)
+#define LOG_CAT_(a, b) a##b
+#define LOG_NARGS(...) LOG_NARGS_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, N, ...) N
+#define LOG_ARGS_0()
+#define LOG_ARGS_1(a) LOG_ARG(a)
+#define LOG_ARGS_2(a, b) LOG_ARG(a), LOG_ARG(b)
+#define LOG_ARGS_3(a, b, c) LOG_ARG(a), LOG_ARG(b), LOG_ARG(c)
+#define LOG_ARGS_4(a, b, c, d) LOG_ARG(a), LOG_ARG(b), LOG_ARG(c), LOG_ARG(d)
+#define LOG_ARGS_5(a, b, c, d, e) LOG_ARG(a), LOG_ARG(b), LOG_ARG(c), LOG_ARG(d), LOG_ARG(e)
+#define LOG_ARGS_6(a, b, c, d, e, f) LOG_ARG(a), LOG_ARG(b), LOG_ARG(c), LOG_ARG(d), LOG_ARG(e), LOG_ARG(f)
+#define LOG_WORDS(...) LOG_CAT(LOG_ARGS_, LOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+
+#if LOG_ENABLED
+
+/// @brief Initialize the log and create its drain task. LOG_*() calls done before are kept, as long as they fit.
+///        The drain task merges every ring in timestamp order. A writer preempted between taking its timestamp and
+///        storing its record can still show up after newer records of other rings.
+/// @param config Log parameters. It is only read during the call.
+void log_initialize(const LogConfig* const config);
+
+/// @brief Store a record in the ring of the calling task. Lock-free. Use the LOG_*() macros instead. Calls from
+///        interrupt context go to `log_write_from_isr()`, so they never write into the ring of the preempted task.
+/// @param level Severity. One of LOG_LEVEL_*.
+/// @param format Format string, in LOG_FORMAT_SECTION.
+/// @param args Raw arguments.
+/// @param count Amount of arguments.
+void log_write(const uint8_t level, const char* format, const uint32_t* args, const uint8_t count);
+
+/// @brief Same as `log_write()`, but from interrupt context, into the ring of the running priority level. Also
+///        lock-free, so it can be called above configMAX_SYSCALL_INTERRUPT_PRIORITY. Use the LOG_*_FROM_ISR() macros
+///        instead.
+void log_write_from_isr(const uint8_t level, const char* format, const uint32_t* args, const uint8_t count);
+
+/// @brief Change the runtime threshold. Calls compiled in but below it cost a single comparison. It can only filter
+///        on top of the compile-time thresholds, never bring back a call that was compiled out.
+/// @param level One of LOG_LEVEL_*. LOG_LEVEL_OFF silences everything.
+void log_set_threshold(const uint8_t level);
+
+/// @brief Runtime threshold. Read-only: use `log_set_threshold()` to change it.
+extern volatile uint8_t log_threshold;
+
+/// @brief Get a snapshot of the log statistics.
+/// @param stats Where the snapshot will be stored.
+void log_get_stats(LogStats* const stats);
+
+/// @brief Get a snapshot of the statistics of every ring in use, in the order they were taken.
+/// @param stats Where the snapshots will be stored.
+/// @param max Length of `stats`.
+/// @return Amount of snapshots stored.
+size_t log_get_ring_stats(LogRingStats* const stats, const size_t max);
+
+#endif // LOG_ENABLED
+
+/// @brief Task delete hook (`traceTASK_DELETE()` in FreeRTOSConfig.h): the ring of the task is released, and handed to
+///        the next new task once the drain task has emptied it. A no-op when the log is compiled out.
+/// @param task Task being deleted.
+void log_task_deleted(void* task);
+
+#if LOG_ENABLED
+
+/// @brief Whether a level is compiled in for the module expanding the macro. A constant expression, so the whole call
+///        is dropped by the compiler when it is false, arguments included.
+#define LOG_COMPILED_IN(level) ((level) >= LOG_LEVEL_FLOOR && (level) >= LOG_MODULE_LEVEL && (level) < LOG_LEVEL_OFF)
+
+#define LOG_EMIT(writer, level, format, ...) \
+    do { \
+        if (LOG_COMPILED_IN(level) && (level) >= log_threshold) { \
+            static const char LOG_FORMAT_[] __attribute__((section(LOG_FORMAT_SECTION))) = format; \
+            const uint32_t LOG_WORDS_[] = {0, LOG_WORDS(__VA_ARGS__)}; \
+            writer((level), LOG_FORMAT_, &LOG_WORDS_[1], LOG_NARGS(__VA_ARGS__)); \
+        } \
+    } while (0)
+
+#else
+
+// Arguments stay referenced (by dead code), so disabling the log leaves no unused variable warnings behind
+#define LOG_EMIT(writer, level, format, ...) \
+    do { \
+        if (0) { \
+            const uint32_t LOG_WORDS_[] = {0, LOG_WORDS(__VA_ARGS__)}; \
+            (void) LOG_WORDS_; \
+        } \
+    } while (0)
+
+#endif // LOG_ENABLED
+
+/// @brief Log a printf-like message without formatting it. The task name, the level and the timestamp are added by the
+///        decoder, so messages need no "[task]" prefix nor trailing newline.
+#define LOG_DEBUG(format, ...) LOG_EMIT(log_write, LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...) LOG_EMIT(log_write, LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define LOG_WARNING(format, ...) LOG_EMIT(log_write, LOG_LEVEL_WARNING, format, ##__VA_ARGS__)
+#define LOG_ERROR(format, ...) LOG_EMIT(log_write, LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+
+/// @brief Same as the LOG_*() macros, but safe to be called from interrupt context.
+#define LOG_DEBUG_FROM_ISR(format, ...) LOG_EMIT(log_write_from_isr, LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LOG_INFO_FROM_ISR(format, ...) LOG_EMIT(log_write_from_isr, LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define LOG_WARNING_FROM_ISR(format, ...) LOG_EMIT(log_write_from_isr, LOG_LEVEL_WARNING, format, ##__VA_ARGS__)
+#define LOG_ERROR_FROM_ISR(format, ...) LOG_EMIT(log_write_from_isr, LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// | Stream format. An LZSS bit stream, most significant bit first, decoded by `Tools/log/lz.py`:
+/// |   1 + 8 bits                       literal byte
+/// |   0 + WINDOW_BITS + LENGTH_BITS    copy of `length + LZ_MIN_MATCH` bytes, `distance` bytes back (overlap allowed)
+/// | A copy with distance 0 marks a flush: the decoder skips to the next byte boundary. The history survives flushes.
+
+/// @brief Window of 2^LZ_WINDOW_BITS - 1 bytes. Together with the length, the only knob of the RAM footprint and of
+///        the search time per byte.
+#define LZ_WINDOW_BITS 8
+#define LZ_LENGTH_BITS 4
+
+#define LZ_WINDOW_SIZE (1U << LZ_WINDOW_BITS)
+#define LZ_MIN_MATCH 2U
+#define LZ_MAX_MATCH (LZ_MIN_MATCH + (1U << LZ_LENGTH_BITS) - 1)
+
+/// @brief Input kept by the encoder: the window plus room to slide it less often.
+#define LZ_BUFFER_SIZE (2 * LZ_WINDOW_SIZE)
+
+/// @brief Compressed bytes gathered before each call to the output.
+#define LZ_OUTPUT_SIZE 32
+
+/// @brief Where the compressed stream goes. Same signature as a log sink, so an encoder can be put in front of one.
+/// @param data Bytes to be written.
+/// @param size Amount of bytes.
+typedef void (*lz_output_t)(const uint8_t* data, const size_t size);
+
+/// @brief Usage statistics of an encoder.
+typedef struct
+{
+    uint32_t bytes_in;  ///< Bytes written to the encoder.
+    uint32_t bytes_out; ///< Compressed bytes handed to the output, flush padding included.
+    uint32_t flushes;   ///< Calls to `lz_encoder_flush()` that had something to push out.
+    uint32_t cycles;    ///< Cycles spent inside the encoder, output calls excluded.
+} LzStats;
+
+/// @brief Streaming LZSS encoder. Uses no heap and about LZ_BUFFER_SIZE + LZ_OUTPUT_SIZE bytes of RAM. It is not
+///        thread safe: an encoder must only be used by one task, e.g. the log drain task.
+typedef struct
+{
+    lz_output_t output;                   ///< Where the compressed stream goes.
+    uint8_t buffer[LZ_BUFFER_SIZE];       ///< History, [0, start), and input still to be encoded, [start, end).
+    size_t start;                         ///< First byte still to be encoded.
+    size_t end;                           ///< End of the input.
+    uint32_t bits;                        ///< Bits not yet gathered in a whole byte, right aligned.
+    uint8_t bit_count;                    ///< Amount of valid bits in `bits`.
+    uint8_t pending[LZ_OUTPUT_SIZE];      ///< Compressed bytes not handed to the output yet.
+    size_t pending_size;                  ///< Amount of bytes in `pending`.
+    LzStats stats;                        ///< Usage statistics.
+} LzEncoder;
+
+/// @brief Initialize an encoder. The stream it produces starts with an empty history.
+/// @param encoder Encoder to initialize.
+/// @param output Where the compressed stream goes.
+void lz_encoder_initialize(LzEncoder* encoder, lz_output_t output);
+
+/// @brief Compress bytes. Some of them are held back, to look for longer matches, until more input or a flush comes.
+/// @param encoder Encoder.
+/// @param data Bytes to be compressed.
+/// @param size Amount of bytes.
+void lz_encoder_write(LzEncoder* encoder, const uint8_t* data, const size_t size);
+
+/// @brief Encode every byte held back and hand the stream, up to a byte boundary, to the output. Meant to be called
+///        at the end of each burst of data (it costs about two bytes), so the receiver is never left waiting.
+/// @param encoder Encoder.
+void lz_encoder_flush(LzEncoder* encoder);
+
+/// @brief Get a snapshot of the usage statistics of an encoder. Must be called from the task using it.
+/// @param encoder Encoder.
+/// @param stats Where the snapshot will be stored.
+void lz_encoder_get_stats(LzEncoder* encoder, LzStats* const stats);
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "message_buffer.h"
+
+/// @brief Payload alignment. Every message starts at a multiple of it, so payloads can be cast to any struct.
+#define MSG_CHANNEL_ALIGNMENT 8
+
+/// @brief Bytes of descriptor storage needed for a channel of up to `max_messages` messages in flight.
+#define MSG_CHANNEL_DESCRIPTORS_SIZE(max_messages) \
+    ((max_messages) * (sizeof(MsgChannelDescriptor) + sizeof(configMESSAGE_BUFFER_LENGTH_TYPE)) + 1)
+
+/// @brief Where a message lays in the payload storage. Internal to the channel, only exposed for sizing purposes.
+typedef struct
+{
+    uint32_t offset; ///< First payload byte, from the start of the payload storage.
+    uint32_t length; ///< Committed length, in bytes.
+} MsgChannelDescriptor;
+
+/// @brief Usage statistics of a channel.
+typedef struct
+{
+    uint32_t messages;  ///< Messages committed.
+    uint32_t bytes;     ///< Payload bytes committed.
+    uint32_t full;      ///< Reservations refused for lack of space or descriptors.
+    size_t used_max;    ///< High-water mark of the payload storage in use, in bytes (padding and wrap skips included).
+} MsgChannelStats;
+
+/// @brief Parameters needed to initialize a channel.
+typedef struct
+{
+    uint8_t* storage;              ///< Payload storage, aligned to MSG_CHANNEL_ALIGNMENT.
+    size_t size;                   ///< Size of `storage`, in bytes. A multiple of MSG_CHANNEL_ALIGNMENT.
+    size_t max_messages;           ///< Messages in flight (reserved, queued or being read) at the same time.
+    uint8_t* descriptors_storage;  ///< At least `MSG_CHANNEL_DESCRIPTORS_SIZE(max_messages)` bytes.
+} MsgChannelConfig;
+
+/// @brief Variable-length, zero-copy channel between one producer and one consumer (the same restriction as a FreeRTOS
+///        message buffer). The producer reserves contiguous space in the payload storage and fills it in place, and
+///        the consumer reads it in place and releases it, so payloads are never copied nor allocated. Only a small
+///        descriptor per message goes through a FreeRTOS message buffer, which also provides the consumer blocking.
+typedef struct
+{
+    uint8_t* storage;                      ///< Payload storage.
+    size_t size;                           ///< Size of `storage`, in bytes.
+    size_t max_messages;                   ///< Messages in flight allowed.
+    size_t head;                           ///< Next free byte. Only moved by the producer.
+    size_t tail;                           ///< First byte in use. Only moved by the consumer.
+    size_t in_flight;                      ///< Messages reserved but not released yet.
+    size_t reserved_head;                  ///< `head` before the pending reservation, so it can be cancelled.
+    uint8_t* reserved;                     ///< Pending reservation, or NULL.
+    size_t reserved_size;                  ///< Size of the pending reservation.
+    MsgChannelDescriptor reading;          ///< Message being read by the consumer.
+    bool is_reading;                       ///< Whether `reading` still has to be released.
+    MsgChannelStats stats;                 ///< Usage statistics.
+    MessageBufferHandle_t descriptors;     ///< Descriptors of the committed messages, oldest first.
+    StaticMessageBuffer_t descriptors_buffer;
+} MsgChannel;
+
+/// @brief Initialize a channel. This function must be called before starting the scheduler.
+/// @param channel Channel to initialize.
+/// @param config Channel parameters. It is only read during the call.
+void msg_channel_initialize(MsgChannel* channel, const MsgChannelConfig* const config);
+
+/// @brief Reserve contiguous payload space for the next message. Only one reservation can be pending at a time.
+///        Never blocks: a full channel is reported to the caller, which decides whether to retry or to drop.
+/// @param channel Channel.
+/// @param size Maximum size of the message, in bytes.
+/// @return Space to be filled in place, or NULL if the channel is full.
+void* msg_channel_reserve(MsgChannel* channel, const size_t size);
+
+/// @brief Hand the pending reservation over to the consumer.
+/// @param channel Channel.
+/// @param length Actual size of the message. Up to the reserved size. Zero cancels the reservation.
+void msg_channel_commit(MsgChannel* channel, const size_t length);
+
+/// @brief Same as `msg_channel_reserve()`, but safe to be called from interrupt context. An ISR must then be the only
+///        producer of the channel.
+void* msg_channel_reserve_from_isr(MsgChannel* channel, const size_t size);
+
+/// @brief Same as `msg_channel_commit()`, but safe to be called from interrupt context.
+void msg_channel_commit_from_isr(MsgChannel* channel, const size_t length, BaseType_t* const woken);
+
+/// @brief Wait for the next message. It stays in the payload storage, untouched by the producer, until released.
+///        Only one message can be held at a time.
+/// @param channel Channel.
+/// @param length Where the message length will be stored.
+/// @param timeout Maximum time to wait for a message.
+/// @return The message, or NULL on timeout.
+const void* msg_channel_receive(MsgChannel* channel, size_t* const length, const TickType_t timeout);
+
+/// @brief Give the space of the message being read back to the producer.
+/// @param channel Channel.
+void msg_channel_release(MsgChannel* channel);
+
+/// @brief Get a snapshot of the usage statistics of a channel.
+/// @param channel Channel.
+/// @param stats Where the snapshot will be stored.
+void msg_channel_get_stats(MsgChannel* channel, MsgChannelStats* const stats);
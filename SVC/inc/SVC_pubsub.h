@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+
+#include "SVC_ao.h"
+
+/// @brief Available topics. Every topic carries a single event type.
+typedef enum
+{
+    TOPIC_LED = 0, ///< LED commands. Carries LEDEvent.
+    TOPICS_TOTAL,  ///< Total amount of topics. Keep this value always at the bottom!
+} PubSubTopic;
+
+/// @brief Subscribe an Active Object to a topic. Subscribing twice is a no-op.
+/// @param topic Must be one of the defined in PubSubTopic.
+/// @param ao Subscriber. Its event size must match the one of the topic events.
+void pubsub_subscribe(const PubSubTopic topic, ActiveObject* const ao);
+
+/// @brief Unsubscribe an Active Object from a topic. Unsubscribing a non subscribed AO is a no-op.
+/// @param topic Must be one of the defined in PubSubTopic.
+/// @param ao Subscriber.
+void pubsub_unsubscribe(const PubSubTopic topic, ActiveObject* const ao);
+
+/// @brief Publish an event to every subscriber of a topic. The producer publishes once, no matter how many subscribers
+///        there are:
+///        - Subscribers whose events are posted by value get the event copied straight into their queue storage
+///          (no allocation, and the copy costs the same as queueing a pointer).
+///        - Every other subscriber gets a reference to a single event pool block, shared without any copy. The block
+///          goes back to the pool once the last subscriber has dispatched it.
+/// @param topic Must be one of the defined in PubSubTopic.
+/// @param event Event to be published. It is copied (at most once), so the caller keeps its ownership.
+/// @param event_size Size of the event, in bytes.
+/// @param lane Lane of the event in every subscriber. Every subscriber must have it.
+/// @param timeout Maximum amount of ticks to wait on each subscriber queue if it is full.
+/// @return true if every subscriber got the event, false otherwise.
+bool pubsub_publish(const PubSubTopic topic, const void* const event, const size_t event_size, const AOLane lane, const TickType_t timeout);
+
+/// @brief Same as `pubsub_publish()`, but safe to be called from interrupt context. It never waits on a full queue.
+///        Call `ao_isr_yield()` once at the end of the ISR (see `ao_post_from_isr()`).
+/// @param woken Set to pdTRUE if any subscriber task has higher priority than the interrupted one. Never cleared.
+bool pubsub_publish_from_isr(const PubSubTopic topic, const void* const event, const size_t event_size, const AOLane lane, BaseType_t* const woken);
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+#include "HAL_uart.h"
+#include "SVC_ao.h"
+
+/// @brief Set to 0 to compile the flight recorder out. Recording a post costs a digest of the event plus a short
+///        critical section, so it is meant to stay on in production.
+#define RECORDER_ENABLED 1
+
+/// @brief Amount of records kept. Older records are overwritten. Must be a power of two.
+#define RECORDER_RECORDS 64
+
+/// @brief Events up to this size are recorded whole. Bigger ones only keep their first bytes and their digest.
+#define RECORDER_PAYLOAD_SIZE AO_EVENT_BY_VALUE_MAX_SIZE
+
+/// @brief Amount of distinct posting tasks the recorder tells apart. Extra tasks share RECORDER_SOURCE_OTHER.
+#define RECORDER_MAX_SOURCES 8
+
+/// @brief `RecorderRecord.source` of posts done from interrupt context.
+#define RECORDER_SOURCE_ISR UINT8_MAX
+
+/// @brief `RecorderRecord.source` of tasks beyond RECORDER_MAX_SOURCES.
+#define RECORDER_SOURCE_OTHER (UINT8_MAX - 1)
+
+/// @brief A single post, as seen by the flight recorder.
+typedef struct
+{
+    uint32_t sequence;                      ///< Post number since boot. Gaps mean overwritten records.
+    uint32_t timestamp;                     ///< `cycles_now()` right before the post.
+    uint32_t digest;                        ///< FNV-1a digest of the whole event.
+    uint8_t source;                         ///< Posting task (index in the source table), or RECORDER_SOURCE_ISR.
+    uint8_t destination;                    ///< Id of the destination AO.
+    uint8_t lane;                           ///< Destination lane. One of AOLane.
+    uint8_t size;                           ///< Event size, in bytes. Saturated at UINT8_MAX.
+    uint8_t payload[RECORDER_PAYLOAD_SIZE]; ///< First bytes of the event.
+} RecorderRecord;
+
+/// @brief Sink of the dump. Called once per line.
+/// @param line Text to be written. Not null terminated.
+/// @param length Length of `line`.
+/// @param context Context given to `recorder_dump()`.
+typedef void (*recorder_write_t)(const char* line, const size_t length, void* context);
+
+#if RECORDER_ENABLED
+
+/// @brief Record a post. Called by the AO core before every post, so the record order is the post order.
+/// @param ao Destination AO.
+/// @param event Event (or pool block) being posted.
+/// @param lane Destination lane.
+void recorder_record(ActiveObject* ao, const void* const event, const AOLane lane);
+
+/// @brief Same as `recorder_record()`, but safe to be called from interrupt context.
+void recorder_record_from_isr(ActiveObject* ao, const void* const event, const AOLane lane);
+
+/// @brief Copy the records still in the ring, oldest first.
+/// @param records Where the records will be stored.
+/// @param max_records Length of `records`.
+/// @return Amount of records stored.
+size_t recorder_snapshot(RecorderRecord* const records, const size_t max_records);
+
+/// @brief Dump the ring as text, for `Tools/recorder/recorder.py` and `Tools/host/replay.c`: a header with the cycle
+///        counter frequency, the AO and source names, and then one line per record, oldest first. Recording goes on
+///        during the dump.
+/// @param write Line sink.
+/// @param context Argument of `write`.
+void recorder_dump(recorder_write_t write, void* context);
+
+/// @brief Dump the ring over a UART, polling, so it needs no UART interrupt nor completion callback.
+/// @param instance Initialized UART instance.
+void recorder_dump_uart(const UARTInstance instance);
+
+/// @brief Dump the ring over a UART once the system has halted (failed assertion, fault handler): no critical
+///        sections, and the bytes go straight through the UART registers, whatever the instance was doing.
+///        Must only be called with interrupts disabled, and never returned from into the scheduler.
+/// @param instance Initialized UART instance.
+void recorder_dump_halted(const UARTInstance instance);
+
+/// @brief Dump the ring through the standard output.
+void recorder_print();
+
+#define RECORDER_RECORD(ao, event, lane) recorder_record((ao), (event), (lane))
+#define RECORDER_RECORD_FROM_ISR(ao, event, lane) recorder_record_from_isr((ao), (event), (lane))
+
+#else
+
+#define RECORDER_RECORD(ao, event, lane) ((void)(ao))
+#define RECORDER_RECORD_FROM_ISR(ao, event, lane) ((void)(ao))
+
+#endif // RECORDER_ENABLED
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+#include "SVC_ao.h"
+
+/// @brief Amount of slots of the timing wheel. Must be a power of two. Timeouts longer than this amount of ticks
+///        simply stay in their slot for more than one wheel revolution.
+#define TIME_EVENT_WHEEL_SLOTS 64
+
+/// @brief Time event: an ordinary AO event that gets posted when a timeout expires.
+typedef struct TimeEvent
+{
+    struct TimeEvent* next; ///< Next time event in the same wheel slot.
+    struct TimeEvent* prev; ///< Previous time event in the same wheel slot.
+    struct TimeEvent* fired; ///< Next time event expired by the same wheel tick, waiting to be posted.
+    ActiveObject* ao;       ///< Receiver of the event.
+    const void* event;      ///< Event posted on every expiration. It must outlive the time event.
+    TickType_t period;      ///< Re-arm period in ticks, or 0 for one-shot time events.
+    uint32_t rounds;        ///< Wheel revolutions left before expiring.
+    uint16_t slot;          ///< Wheel slot holding the time event.
+    bool armed;             ///< true while the time event is in the wheel.
+} TimeEvent;
+
+/// @brief Initialize the time event service. Every time event is driven by a single FreeRTOS software timer, which
+///        only runs while there are armed time events. This function must be called before starting the scheduler.
+void time_event_init();
+
+/// @brief Bind a time event to its receiver and event. The time event starts disarmed.
+/// @param te Time event.
+/// @param ao Receiver of the event.
+/// @param event Event posted on every expiration (by value, see `ao_post()`). It must outlive the time event.
+void time_event_create(TimeEvent* te, ActiveObject* ao, const void* event);
+
+/// @brief Arm a time event. Arming an already armed time event re-arms it. Runs in constant time.
+/// @param te Time event.
+/// @param delay Ticks until the first expiration. Must be greater than 0.
+/// @param period Ticks between expirations after the first one, or 0 for a one-shot time event.
+void time_event_arm(TimeEvent* te, const TickType_t delay, const TickType_t period);
+
+/// @brief Disarm a time event. Runs in constant time. Once disarmed, the time event won't expire anymore. Expirations
+///        are posted right after the wheel tick that detected them (outside of the wheel lock), so an expiration that
+///        was already due may still be posted after this call: receivers that care can tell it apart with
+///        `time_event_is_armed()`.
+/// @param te Time event.
+/// @return true if the time event was armed, false if it had already expired (or was never armed).
+bool time_event_disarm(TimeEvent* te);
+
+/// @brief Check whether a time event is waiting in the wheel. A one-shot time event whose event is being dispatched is
+///        no longer armed, unless it was re-armed after expiring: then the dispatched event is a stale expiration.
+/// @param te Time event.
+/// @return true if the time event is armed.
+bool time_event_is_armed(const TimeEvent* te);
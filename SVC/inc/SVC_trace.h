@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+
+/// @brief Set to 1 to trace every button -> LED event end to end. When 0 the TRACE_* macros compile to nothing and
+///        events carry no trace id.
+#define TRACE_ENABLED 0
+
+/// @brief Stages of the button -> LED path, in order. Each one gets a timestamp (CPU cycles) per traced event.
+typedef enum
+{
+    TRACE_STAGE_EDGE = 0,     ///< The button task sampled the edge that started the gesture
+    TRACE_STAGE_CLASSIFIED,   ///< The gesture FSM produced a LED event
+    TRACE_STAGE_POSTED,       ///< The event is about to be published
+    TRACE_STAGE_DISPATCHED,   ///< The LED AO started dispatching the event
+    TRACE_STAGE_APPLIED,      ///< The LED AO wrote the GPIO port
+    TRACE_STAGES_TOTAL,       ///< Total amount of stages. Keep this value always at the bottom!
+} TraceStage;
+
+/// @brief Sequence id of a traced event. 0 means "not traced", so untraced producers just leave it zeroed.
+typedef uint16_t TraceId;
+
+#define TRACE_ID_NONE ((TraceId)0)
+
+/// @brief Amount of events that can be in flight at the same time. Older records are overwritten. It must cover
+///        every LED event that can be queued (both lanes) or folded into a pending batch: see SVC_led.c.
+#define TRACE_RECORDS 32
+
+/// @brief Latency histograms use power of two buckets: bucket N counts latencies in [2^N, 2^(N+1)) cycles.
+#define TRACE_HISTOGRAM_BUCKETS 32
+
+/// @brief Latency histogram of a stage.
+typedef struct
+{
+    uint32_t count;                            ///< Latencies accounted
+    uint32_t min;                              ///< Minimum latency, in cycles
+    uint32_t max;                              ///< Maximum latency, in cycles
+    uint64_t total;                            ///< Sum of every latency, in cycles
+    uint32_t buckets[TRACE_HISTOGRAM_BUCKETS]; ///< Latency distribution
+} TraceHistogram;
+
+#if TRACE_ENABLED
+
+/// @brief Start tracing an event. Stamps TRACE_STAGE_EDGE with `edge_cycles` and TRACE_STAGE_CLASSIFIED with now.
+/// @param edge_cycles `cycles_now()` value sampled when the edge was detected.
+/// @return Sequence id of the event. Never TRACE_ID_NONE.
+TraceId trace_begin(const uint32_t edge_cycles);
+
+/// @brief Stamp a stage of a traced event with the current cycle counter. Once TRACE_STAGE_APPLIED is stamped the
+///        latency of every stage is added to its histogram.
+/// @param id Event sequence id. TRACE_ID_NONE, or an id whose record was already overwritten, is a no-op.
+/// @param stage Stage reached.
+void trace_stamp(const TraceId id, const TraceStage stage);
+
+/// @brief Get a snapshot of a stage histogram.
+/// @param stage Stage. Its histogram holds the latency from the previous stage, except for TRACE_STAGE_EDGE which
+///        holds the end to end latency (edge -> applied).
+/// @param histogram Where the snapshot will be stored.
+void trace_get_histogram(const TraceStage stage, TraceHistogram* const histogram);
+
+/// @brief Print every stage histogram through the standard output. Slow: call it on demand (see app_console.h),
+///        never from the traced path.
+void trace_print();
+
+#define TRACE_BEGIN(edge_cycles) trace_begin(edge_cycles)
+#define TRACE_STAMP(id, stage) trace_stamp((id), (stage))
+
+#else
+
+#define TRACE_BEGIN(edge_cycles) TRACE_ID_NONE
+#define TRACE_STAMP(id, stage) ((void)(id))
+
+#endif // TRACE_ENABLED
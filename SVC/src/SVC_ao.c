@@ -0,0 +1,783 @@
+// ------ inclusions ---------------------------------------------------
+#define LOG_MODULE_LEVEL LOG_LEVEL_AO
+
+#include <string.h>
+
+#include "HAL_cycles.h"
+#include "SVC_ao.h"
+#include "SVC_ao_kernel.h"
+#include "SVC_ao_qset.h"
+#include "SVC_event_pool.h"
+#include "SVC_format.h"
+#include "SVC_log.h"
+#include "SVC_recorder.h"
+
+/// | Private typedef -----------------------------------------------------------
+
+/// @brief Queue item as seen by the AO task. Depending on the AO mode it is either the event itself or a pointer to
+///        an event pool block.
+typedef union
+{
+    uint8_t value[AO_EVENT_BY_VALUE_MAX_SIZE];
+    void* reference;
+    uint64_t alignment; ///< Unused. Keeps `value` suitably aligned for any event.
+} AOQueueItem;
+
+/// @brief Where a post comes from. Task and interrupt posts share every policy: only the FreeRTOS calls differ, and
+///        the `post_*()` helpers pick them from here.
+typedef struct
+{
+    BaseType_t* woken;  ///< NULL in task context. From an ISR, set to pdTRUE if a higher priority task woke up.
+    TickType_t timeout; ///< Task context only: maximum amount of ticks the caller is willing to wait.
+} AOPostContext;
+
+/// | Private define ------------------------------------------------------------
+/// | Private macro -------------------------------------------------------------
+
+#define COALESCE_BIT(key) ((uint32_t)1U << (key))
+
+/// @brief Slack histogram bucket of a slack: log4 of it, so every bucket is 4 times wider than the previous one.
+#define SLACK_BUCKET(slack) ((31U - (uint32_t)__builtin_clz((slack) | 1U)) / 2U)
+
+// Notification transports use their own notification index when the kernel has notification arrays, so they never
+// collide with other users of the task notification. Otherwise the (only) default notification is used.
+#if defined(configTASK_NOTIFICATION_ARRAY_ENTRIES) && (configTASK_NOTIFICATION_ARRAY_ENTRIES > 1)
+#define AO_NOTIFY_INDEX 1
+#define AO_NOTIFY_AND_QUERY(task, value, action, previous) \
+    xTaskNotifyAndQueryIndexed((task), AO_NOTIFY_INDEX, (value), (action), (previous))
+#define AO_NOTIFY_AND_QUERY_FROM_ISR(task, value, action, previous, woken) \
+    xTaskNotifyAndQueryIndexedFromISR((task), AO_NOTIFY_INDEX, (value), (action), (previous), (woken))
+#define AO_NOTIFY_WAIT(value, timeout) xTaskNotifyWaitIndexed(AO_NOTIFY_INDEX, 0, UINT32_MAX, (value), (timeout))
+#else
+#define AO_NOTIFY_AND_QUERY(task, value, action, previous) xTaskNotifyAndQuery((task), (value), (action), (previous))
+#define AO_NOTIFY_AND_QUERY_FROM_ISR(task, value, action, previous, woken) \
+    xTaskNotifyAndQueryFromISR((task), (value), (action), (previous), (woken))
+#define AO_NOTIFY_WAIT(value, timeout) xTaskNotifyWait(0, UINT32_MAX, (value), (timeout))
+#endif
+
+/// @brief Update an AOStats field inside a critical section, since several producers may post at the same time.
+#define AO_STATS_ADD(context, ao, lane, field, value) \
+    do { \
+        const UBaseType_t SAVED_MASK = post_enter_critical(context); \
+        (ao)->stats[lane].field += (value); \
+        post_exit_critical((context), SAVED_MASK); \
+    } while (0)
+
+/// | Private variables ---------------------------------------------------------
+
+/// @brief Every initialized AO, indexed by id.
+static ActiveObject* ao_registry[AO_MAX_ACTIVE_OBJECTS];
+
+/// @brief Amount of registered AOs. It is also the id of the next AO.
+static uint8_t ao_registry_count = 0;
+
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Common Active Object task: wait for an event and dispatch it.
+/// @param parameters should be a reference to the AO.
+static void ao_task(void* parameters);
+
+/// @brief Add a lane queue to the FreeRTOS queue registry (the one kernel aware debuggers show) as "<name>/<lane>".
+static void register_lane(ActiveObject* ao, const AOLane lane);
+
+/// @brief Post an event to a lane, from task or interrupt context.
+/// @return true if the event was queued (or coalesced), false if it was dropped.
+static bool post_lane(ActiveObject* ao, const void* const event, const AOLane lane, const AOPostContext* const context);
+
+/// @brief Queue an item (an event, or a pointer to a pool block) applying the AO overflow policy. From an ISR,
+///        AO_OVERFLOW_BLOCK never waits: it behaves like AO_OVERFLOW_DROP_NEWEST.
+/// @param ao Receiver.
+/// @param lane Lane of the item.
+/// @param item Queue item.
+/// @param context Where the post comes from.
+/// @return true if the item was queued.
+static bool post_item(ActiveObject* ao, const AOLane lane, const void* const item, const AOPostContext* const context);
+
+/// @brief Wait for room in a lane queue, accounting the time spent blocked. Task context only.
+static bool post_item_blocking(ActiveObject* ao, const AOLane lane, const void* const item,
+        const AOPostContext* const context);
+
+/// @brief Drop the oldest pending item of a lane, releasing its pool block if needed.
+/// @return true if an item was dropped.
+static bool drop_oldest(ActiveObject* ao, const AOLane lane, const AOPostContext* const context);
+
+/// @brief AO_OVERFLOW_COALESCE post: keep the event in its key slot, and only queue the key if it wasn't pending.
+static bool post_coalesce(ActiveObject* ao, const void* const event, const AOPostContext* const context);
+
+/// @brief Post an event through a notification transport. It never fails: bits are ORed and values overwritten.
+static bool post_notify(ActiveObject* ao, const void* const event, const AOPostContext* const context);
+
+/// @brief Account a successful post and wake up whoever dispatches the AO.
+static void posted(ActiveObject* ao, const AOLane lane, const AOPostContext* const context);
+
+/// @brief Enter a critical section suitable for the context of the post.
+/// @return Interrupt mask to be given back to `post_exit_critical()`.
+static UBaseType_t post_enter_critical(const AOPostContext* const context);
+
+/// @brief Leave the critical section entered with `post_enter_critical()`.
+static void post_exit_critical(const AOPostContext* const context, const UBaseType_t saved_mask);
+
+/// @brief Queue an item without waiting.
+static bool post_send(const AOPostContext* const context, QueueHandle_t queue, const void* const item);
+
+/// @brief Take an item without waiting.
+static bool post_receive(const AOPostContext* const context, QueueHandle_t queue, void* const item);
+
+/// @brief Take the next item without waiting, urgent lane first.
+/// @return true if an item was taken.
+static bool receive_item(ActiveObject* ao, AOQueueItem* const item);
+
+/// @brief Same as `receive_item()`, but leaving the item in its queue.
+static bool peek_item(ActiveObject* ao, AOQueueItem* const item);
+
+/// @brief Replace a coalescing key by the latest event of that key.
+/// @param take true if the key leaves the queue, so later posts of the same key queue it again.
+static void load_coalesced(ActiveObject* ao, AOQueueItem* const item, const bool take);
+
+/// @brief Account an event that took effect at `done` against its deadline. Must be called inside a critical section.
+static void record_deadline(ActiveObject* ao, const AODeadline deadline, const uint32_t done);
+
+/// | Private functions ---------------------------------------------------------
+
+static void ao_task(void* parameters)
+{
+    ActiveObject* const AO = (ActiveObject*) (parameters);
+
+    LOG_INFO("Task Created");
+
+    while (1) {
+        ao_dispatch_next(AO, portMAX_DELAY);
+    }
+}
+
+void ao_initialize(ActiveObject* ao, const AOConfig* const config)
+{
+    configASSERT(ao && config);
+    configASSERT(config->dispatch);
+    // Notification transports have no queue: their depth is the single notification value
+    configASSERT(config->transport != AO_TRANSPORT_QUEUE || (config->queue_storage && config->queue_length > 0));
+    configASSERT(config->kernel || config->queue_set || (config->stack && config->task_buffer));
+    configASSERT(!(config->kernel && config->queue_set));
+    configASSERT(config->event_size > 0);
+    configASSERT(config->urgent_queue_length == 0 || config->urgent_queue_storage);
+
+    // The registry is written without a lock and read by hosts, publishers and metrics without one either: it must be
+    // complete before any task runs. Slots are never given back, since AOs live as long as the application.
+    configASSERT(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED);
+    configASSERT(ao_registry_count < AO_MAX_ACTIVE_OBJECTS);
+
+    ao->id = ao_registry_count++;
+    ao_registry[ao->id] = ao;
+    ao->name = config->name;
+    ao->dispatch = config->dispatch;
+    ao->flush = config->flush;
+    ao->event_type = config->event_type;
+    ao->dispatch_stats = (AODispatchStats){.cycles_min = UINT32_MAX, .last_event_type = AO_EVENT_TYPE_UNKNOWN};
+    ao->event_size = config->event_size;
+    ao->by_value = (config->event_size <= AO_EVENT_BY_VALUE_MAX_SIZE);
+    ao->transport = config->transport;
+    ao->overflow_policy = config->overflow_policy;
+    // A zero-initialized config must not turn every blocking post into a silent drop
+    ao->block_timeout = (config->block_timeout > 0) ? config->block_timeout : portMAX_DELAY;
+    ao->coalesce_key = config->coalesce_key;
+    ao->coalesce_slots = config->coalesce_storage;
+    ao->coalesce_pending = 0;
+    ao->deadline = config->deadline;
+    ao->completes_deadlines = config->completes_deadlines;
+    ao->deadline_stats = (AODeadlineStats){0};
+
+    // A mailbox can only hold one event, and it must be overwritable in place
+    configASSERT(ao->overflow_policy != AO_OVERFLOW_OVERWRITE || ao->transport != AO_TRANSPORT_QUEUE ||
+                 (config->queue_length == 1 && ao->by_value));
+    // Coalescing AOs queue keys, while the events stay in their key slot
+    configASSERT(ao->overflow_policy != AO_OVERFLOW_COALESCE || (ao->by_value && ao->coalesce_key && ao->coalesce_slots));
+    configASSERT(config->urgent_queue_length == 0 ||
+                 (ao->overflow_policy != AO_OVERFLOW_OVERWRITE && ao->overflow_policy != AO_OVERFLOW_COALESCE));
+
+    // A notification carries a single 32 bit value, and the task notification must not be shared with anyone else
+    configASSERT(ao->transport == AO_TRANSPORT_QUEUE ||
+                 (config->event_size <= AO_NOTIFY_EVENT_MAX_SIZE && config->kernel == NULL && config->queue_set == NULL &&
+                  config->urgent_queue_length == 0 && ao->overflow_policy != AO_OVERFLOW_COALESCE));
+
+    const UBaseType_t ITEM_SIZE = (ao->overflow_policy == AO_OVERFLOW_COALESCE) ? sizeof(uint8_t) : AO_QUEUE_ITEM_SIZE(config->event_size);
+
+    // The queues must exist before the task starts running
+    for (size_t lane = 0; lane < AO_LANES_TOTAL; lane++) {
+        ao->stats[lane] = (AOStats){0};
+        ao->queues[lane] = NULL;
+    }
+
+    if (ao->transport == AO_TRANSPORT_QUEUE) {
+        ao->queues[AO_LANE_NORMAL] = xQueueCreateStatic(
+                config->queue_length,
+                ITEM_SIZE,
+                config->queue_storage,
+                &ao->queue_buffers[AO_LANE_NORMAL]);
+        configASSERT(ao->queues[AO_LANE_NORMAL]);
+        register_lane(ao, AO_LANE_NORMAL);
+    }
+
+    if (config->urgent_queue_length > 0) {
+        ao->queues[AO_LANE_URGENT] = xQueueCreateStatic(
+                config->urgent_queue_length,
+                ITEM_SIZE,
+                config->urgent_queue_storage,
+                &ao->queue_buffers[AO_LANE_URGENT]);
+        configASSERT(ao->queues[AO_LANE_URGENT]);
+        register_lane(ao, AO_LANE_URGENT);
+    }
+
+    ao->kernel = config->kernel;
+    ao->queue_set = config->queue_set;
+    ao->priority = config->priority;
+    if (ao->kernel) {
+        // Hosted AOs share the kernel task (and its stack)
+        ao_kernel_attach(ao->kernel, ao, config->priority);
+        ao->task = ao->kernel->task;
+        return;
+    }
+
+    if (ao->queue_set) {
+        // Same, but the host wakes up on the queues themselves
+        ao_qset_attach(ao->queue_set, ao, config->queue_length + config->urgent_queue_length);
+        ao->task = ao->queue_set->task;
+        return;
+    }
+
+    ao->task = xTaskCreateStatic(
+            ao_task,
+            config->name,
+            config->stack_depth,
+            (void*) ao,
+            config->priority,
+            config->stack,
+            config->task_buffer);
+    configASSERT(ao->task);
+}
+
+static void register_lane(ActiveObject* ao, const AOLane lane)
+{
+#if configQUEUE_REGISTRY_SIZE > 0
+    static const char* const LANE_NAMES[AO_LANES_TOTAL] =
+    {
+        [AO_LANE_NORMAL] = "normal",
+        [AO_LANE_URGENT] = "urgent",
+    };
+
+    format_snprintf(ao->lane_names[lane], sizeof(ao->lane_names[lane]), "%s/%s", ao->name ? ao->name : "ao",
+            LANE_NAMES[lane]);
+    vQueueAddToRegistry(ao->queues[lane], ao->lane_names[lane]);
+
+    // The registry silently ignores queues once it is full: raise configQUEUE_REGISTRY_SIZE instead
+    configASSERT(pcQueueGetName(ao->queues[lane]) != NULL && "FreeRTOS queue registry full");
+#else
+    (void) ao;
+    (void) lane;
+#endif
+}
+
+static UBaseType_t post_enter_critical(const AOPostContext* const context)
+{
+    if (context->woken) {
+        return taskENTER_CRITICAL_FROM_ISR();
+    }
+
+    taskENTER_CRITICAL();
+    return 0;
+}
+
+static void post_exit_critical(const AOPostContext* const context, const UBaseType_t saved_mask)
+{
+    if (context->woken) {
+        taskEXIT_CRITICAL_FROM_ISR(saved_mask);
+    } else {
+        taskEXIT_CRITICAL();
+    }
+}
+
+static bool post_send(const AOPostContext* const context, QueueHandle_t queue, const void* const item)
+{
+    if (context->woken) {
+        return xQueueSendFromISR(queue, item, context->woken) == pdPASS;
+    }
+    return xQueueSend(queue, item, 0) == pdPASS;
+}
+
+static bool post_receive(const AOPostContext* const context, QueueHandle_t queue, void* const item)
+{
+    if (context->woken) {
+        return xQueueReceiveFromISR(queue, item, context->woken) == pdPASS;
+    }
+    return xQueueReceive(queue, item, 0) == pdPASS;
+}
+
+static void posted(ActiveObject* ao, const AOLane lane, const AOPostContext* const context)
+{
+    const UBaseType_t SAVED_MASK = post_enter_critical(context);
+    const UBaseType_t DEPTH = context->woken ? uxQueueMessagesWaitingFromISR(ao->queues[lane])
+                                             : uxQueueMessagesWaiting(ao->queues[lane]);
+    ao->stats[lane].posted++;
+    if (DEPTH > ao->stats[lane].depth_max) {
+        ao->stats[lane].depth_max = DEPTH;
+    }
+    post_exit_critical(context, SAVED_MASK);
+
+    if (ao->kernel) {
+        if (context->woken) {
+            ao_kernel_signal_from_isr(ao->kernel, ao, context->woken);
+        } else {
+            ao_kernel_signal(ao->kernel, ao);
+        }
+    } else if (ao->queues[AO_LANE_URGENT] && ao->queue_set == NULL) {
+        // The task can not block on two queues, so it waits for its notification instead
+        if (context->woken) {
+            vTaskNotifyGiveFromISR(ao->task, context->woken);
+        } else {
+            xTaskNotifyGive(ao->task);
+        }
+    }
+}
+
+static bool post_item_blocking(ActiveObject* ao, const AOLane lane, const void* const item,
+        const AOPostContext* const context)
+{
+    QueueHandle_t const QUEUE = ao->queues[lane];
+
+    // Fast path: there is room, so there is nothing to account
+    if (xQueueSend(QUEUE, item, 0) == pdPASS) {
+        return true;
+    }
+
+    const TickType_t TIMEOUT = (context->timeout < ao->block_timeout) ? context->timeout : ao->block_timeout;
+    if (TIMEOUT == 0) {
+        AO_STATS_ADD(context, ao, lane, dropped, 1);
+        return false;
+    }
+
+    const TickType_t START = xTaskGetTickCount();
+    const bool POSTED = (xQueueSend(QUEUE, item, TIMEOUT) == pdPASS);
+    const TickType_t BLOCKED = xTaskGetTickCount() - START;
+
+    taskENTER_CRITICAL();
+    ao->stats[lane].blocked_posts++;
+    ao->stats[lane].blocked_ticks += BLOCKED;
+    if (BLOCKED > ao->stats[lane].blocked_max) {
+        ao->stats[lane].blocked_max = BLOCKED;
+    }
+    if (!POSTED) {
+        ao->stats[lane].dropped++;
+    }
+    taskEXIT_CRITICAL();
+
+    return POSTED;
+}
+
+static bool drop_oldest(ActiveObject* ao, const AOLane lane, const AOPostContext* const context)
+{
+    AOQueueItem discarded;
+
+    if (!post_receive(context, ao->queues[lane], &discarded)) {
+        return false;
+    }
+
+    if (context->woken) {
+        if (!ao->by_value) {
+            event_pool_put_from_isr(discarded.reference);
+        }
+        ao_qset_forget_from_isr(ao->queue_set, context->woken);
+    } else {
+        if (!ao->by_value) {
+            event_pool_put(discarded.reference);
+        }
+        ao_qset_forget(ao->queue_set);
+    }
+
+    AO_STATS_ADD(context, ao, lane, dropped, 1);
+    return true;
+}
+
+static bool post_item(ActiveObject* ao, const AOLane lane, const void* const item, const AOPostContext* const context)
+{
+    configASSERT(lane < AO_LANES_TOTAL && ao->queues[lane]);
+    QueueHandle_t const QUEUE = ao->queues[lane];
+    bool ok = false;
+
+    AOOverflowPolicy policy = ao->overflow_policy;
+    if (policy == AO_OVERFLOW_BLOCK && context->woken) {
+        policy = AO_OVERFLOW_DROP_NEWEST; // Interrupts never wait
+    }
+
+    switch (policy) {
+    case AO_OVERFLOW_BLOCK:
+        ok = post_item_blocking(ao, lane, item, context);
+        break;
+    case AO_OVERFLOW_DROP_NEWEST:
+        ok = post_send(context, QUEUE, item);
+        if (!ok) {
+            AO_STATS_ADD(context, ao, lane, dropped, 1);
+        }
+        break;
+    case AO_OVERFLOW_DROP_OLDEST:
+        // The consumer may empty the queue in between, so only drop while there is actually no room
+        while (!(ok = post_send(context, QUEUE, item))) {
+            drop_oldest(ao, lane, context);
+        }
+        break;
+    case AO_OVERFLOW_OVERWRITE:
+        if (context->woken ? xQueueIsQueueFullFromISR(QUEUE) : (uxQueueSpacesAvailable(QUEUE) == 0)) {
+            AO_STATS_ADD(context, ao, lane, overwritten, 1);
+        }
+        ok = context->woken ? (xQueueOverwriteFromISR(QUEUE, item, context->woken) == pdPASS)
+                            : (xQueueOverwrite(QUEUE, item) == pdPASS);
+        break;
+    default:
+        configASSERT(pdFAIL && "Invalid overflow policy");
+        break;
+    }
+
+    if (ok) {
+        posted(ao, lane, context);
+    }
+
+    return ok;
+}
+
+static bool post_coalesce(ActiveObject* ao, const void* const event, const AOPostContext* const context)
+{
+    const uint8_t KEY = ao->coalesce_key(event);
+    configASSERT(KEY < AO_COALESCE_MAX_KEYS);
+
+    UBaseType_t saved_mask = post_enter_critical(context);
+    memcpy(&ao->coalesce_slots[KEY * ao->event_size], event, ao->event_size);
+    const bool PENDING = (ao->coalesce_pending & COALESCE_BIT(KEY)) != 0;
+    ao->coalesce_pending |= COALESCE_BIT(KEY);
+    if (PENDING) {
+        ao->stats[AO_LANE_NORMAL].coalesced++;
+    }
+    post_exit_critical(context, saved_mask);
+
+    if (PENDING) {
+        return true;
+    }
+
+    if (!post_send(context, ao->queues[AO_LANE_NORMAL], &KEY)) {
+        // Only possible with a queue shorter than the amount of keys in use
+        saved_mask = post_enter_critical(context);
+        ao->coalesce_pending &= ~COALESCE_BIT(KEY);
+        ao->stats[AO_LANE_NORMAL].dropped++;
+        post_exit_critical(context, saved_mask);
+        return false;
+    }
+
+    posted(ao, AO_LANE_NORMAL, context);
+    return true;
+}
+
+static bool post_notify(ActiveObject* ao, const void* const event, const AOPostContext* const context)
+{
+    uint32_t value = 0;
+    uint32_t previous = 0;
+    memcpy(&value, event, ao->event_size);
+
+    const eNotifyAction ACTION = (ao->transport == AO_TRANSPORT_NOTIFY_BITS) ? eSetBits : eSetValueWithOverwrite;
+    if (context->woken) {
+        AO_NOTIFY_AND_QUERY_FROM_ISR(ao->task, value, ACTION, &previous, context->woken);
+    } else {
+        AO_NOTIFY_AND_QUERY(ao->task, value, ACTION, &previous);
+    }
+
+    // Bits are cleared when the AO takes them, so anything left means this event was merged into a pending one
+    if (ao->transport == AO_TRANSPORT_NOTIFY_BITS && previous) {
+        AO_STATS_ADD(context, ao, AO_LANE_NORMAL, coalesced, 1);
+    }
+
+    AO_STATS_ADD(context, ao, AO_LANE_NORMAL, posted, 1);
+    return true;
+}
+
+static bool post_lane(ActiveObject* ao, const void* const event, const AOLane lane, const AOPostContext* const context)
+{
+    if (ao->transport != AO_TRANSPORT_QUEUE) {
+        configASSERT(lane == AO_LANE_NORMAL);
+        return post_notify(ao, event, context);
+    }
+
+    if (ao->overflow_policy == AO_OVERFLOW_COALESCE) {
+        configASSERT(lane == AO_LANE_NORMAL);
+        return post_coalesce(ao, event, context);
+    }
+
+    if (ao->by_value) {
+        // Small events are copied straight into the queue storage: no allocation, no free, no pointer chase
+        return post_item(ao, lane, event, context);
+    }
+
+    void* const BLOCK = context->woken ? event_pool_get_from_isr(ao->event_size) : event_pool_get(ao->event_size);
+    if (BLOCK == NULL) {
+        AO_STATS_ADD(context, ao, lane, dropped, 1);
+        return false;
+    }
+
+    memcpy(BLOCK, event, ao->event_size);
+    if (!post_item(ao, lane, (void*)(&BLOCK), context)) {
+        if (context->woken) {
+            event_pool_put_from_isr(BLOCK);
+        } else {
+            event_pool_put(BLOCK);
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool ao_post_lane(ActiveObject* ao, const void* const event, const AOLane lane, const TickType_t timeout)
+{
+    const AOPostContext CONTEXT = {.woken = NULL, .timeout = timeout};
+
+    // Recorded before the post, so the record order is the order the AO sees, and dropped posts are recorded too
+    RECORDER_RECORD(ao, event, lane);
+    return post_lane(ao, event, lane, &CONTEXT);
+}
+
+bool ao_post(ActiveObject* ao, const void* const event, const TickType_t timeout)
+{
+    return ao_post_lane(ao, event, AO_LANE_NORMAL, timeout);
+}
+
+bool ao_post_reference(ActiveObject* ao, void* const block, const AOLane lane, const TickType_t timeout)
+{
+    const AOPostContext CONTEXT = {.woken = NULL, .timeout = timeout};
+
+    configASSERT(!ao->by_value);
+    RECORDER_RECORD(ao, block, lane);
+    return post_item(ao, lane, (void*)(&block), &CONTEXT);
+}
+
+bool ao_post_lane_from_isr(ActiveObject* ao, const void* const event, const AOLane lane, BaseType_t* const woken)
+{
+    const AOPostContext CONTEXT = {.woken = woken, .timeout = 0};
+
+    configASSERT(woken);
+    RECORDER_RECORD_FROM_ISR(ao, event, lane);
+    return post_lane(ao, event, lane, &CONTEXT);
+}
+
+bool ao_post_from_isr(ActiveObject* ao, const void* const event, BaseType_t* const woken)
+{
+    return ao_post_lane_from_isr(ao, event, AO_LANE_NORMAL, woken);
+}
+
+bool ao_post_reference_from_isr(ActiveObject* ao, void* const block, const AOLane lane, BaseType_t* const woken)
+{
+    const AOPostContext CONTEXT = {.woken = woken, .timeout = 0};
+
+    configASSERT(!ao->by_value && woken);
+    RECORDER_RECORD_FROM_ISR(ao, block, lane);
+    return post_item(ao, lane, (void*)(&block), &CONTEXT);
+}
+
+static bool receive_item(ActiveObject* ao, AOQueueItem* const item)
+{
+    for (size_t lane = AO_LANES_TOTAL; lane > 0; lane--) {
+        QueueHandle_t const QUEUE = ao->queues[lane - 1];
+
+        if (QUEUE && xQueueReceive(QUEUE, item, 0) == pdPASS) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool peek_item(ActiveObject* ao, AOQueueItem* const item)
+{
+    for (size_t lane = AO_LANES_TOTAL; lane > 0; lane--) {
+        QueueHandle_t const QUEUE = ao->queues[lane - 1];
+
+        if (QUEUE && xQueuePeek(QUEUE, item, 0) == pdPASS) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void load_coalesced(ActiveObject* ao, AOQueueItem* const item, const bool take)
+{
+    const uint8_t KEY = item->value[0];
+
+    taskENTER_CRITICAL();
+    memcpy(item->value, &ao->coalesce_slots[KEY * ao->event_size], ao->event_size);
+    if (take) {
+        ao->coalesce_pending &= ~COALESCE_BIT(KEY);
+    }
+    taskEXIT_CRITICAL();
+}
+
+bool ao_dispatch_next(ActiveObject* ao, const TickType_t timeout)
+{
+    AOQueueItem item;
+
+    if (ao->transport != AO_TRANSPORT_QUEUE) {
+        // The whole event travels in the notification value
+        uint32_t value;
+        if (AO_NOTIFY_WAIT(&value, timeout) != pdTRUE) {
+            return false;
+        }
+        memcpy(item.value, &value, ao->event_size);
+    } else if (ao->queues[AO_LANE_URGENT] == NULL) {
+        // Single lane: block right on the queue
+        if (xQueueReceive(ao->queues[AO_LANE_NORMAL], &item, timeout) != pdPASS) {
+            return false;
+        }
+    } else if (!receive_item(ao, &item)) {
+        // Posters queue first and notify afterwards, so no event is missed. A notification left by an event that was
+        // already taken just makes the caller find the lanes empty once more.
+        if (timeout == 0 || ulTaskNotifyTake(pdTRUE, timeout) == 0 || !receive_item(ao, &item)) {
+            return false;
+        }
+    }
+
+    if (ao->overflow_policy == AO_OVERFLOW_COALESCE) {
+        load_coalesced(ao, &item, true);
+    }
+
+    const void* const EVENT = ao->by_value ? (const void*) item.value : item.reference;
+    if (EVENT == NULL) {
+        return true;
+    }
+
+    const uint32_t START = cycles_now();
+    ao->dispatch(ao, EVENT);
+    const uint32_t END = cycles_now();
+    const uint32_t CYCLES = END - START;
+    const uint8_t TYPE = ao->event_type ? ao->event_type(EVENT) : AO_EVENT_TYPE_UNKNOWN;
+    // AOs that complete their deadlines themselves account them once the event takes effect (e.g. in their flush)
+    const AODeadline DEADLINE = (ao->deadline && !ao->completes_deadlines) ? ao->deadline(EVENT) : AO_DEADLINE_NONE;
+
+    taskENTER_CRITICAL();
+    AODispatchStats* const STATS = &ao->dispatch_stats;
+    STATS->dispatched++;
+    STATS->cycles_total += CYCLES;
+    if (CYCLES < STATS->cycles_min) {
+        STATS->cycles_min = CYCLES;
+    }
+    if (CYCLES > STATS->cycles_max) {
+        STATS->cycles_max = CYCLES;
+    }
+    STATS->last_event_type = TYPE;
+    if (DEADLINE != AO_DEADLINE_NONE) {
+        record_deadline(ao, DEADLINE, END);
+    }
+    taskEXIT_CRITICAL();
+
+    if (!ao->by_value) {
+        event_pool_put(item.reference);
+    }
+
+    // The task keeps dispatching without blocking while events are pending, so a burst is flushed once at its end
+    if (ao->flush && ao_pending_events(ao) == 0) {
+        ao->flush(ao);
+    }
+
+    return true;
+}
+
+UBaseType_t ao_pending_events(ActiveObject* ao)
+{
+    UBaseType_t pending = 0;
+
+    for (size_t lane = 0; lane < AO_LANES_TOTAL; lane++) {
+        if (ao->queues[lane]) {
+            pending += uxQueueMessagesWaiting(ao->queues[lane]);
+        }
+    }
+
+    return pending;
+}
+
+static void record_deadline(ActiveObject* ao, const AODeadline deadline, const uint32_t done)
+{
+    AODeadlineStats* const DEADLINES = &ao->deadline_stats;
+    const int32_t SLACK = (int32_t)(deadline - done);
+
+    if (SLACK < 0) {
+        DEADLINES->missed++;
+        if ((uint32_t)(-SLACK) > DEADLINES->lateness_max) {
+            DEADLINES->lateness_max = (uint32_t)(-SLACK);
+        }
+    } else {
+        DEADLINES->met++;
+        DEADLINES->slack[SLACK_BUCKET((uint32_t) SLACK)]++;
+    }
+}
+
+void ao_deadline_done(ActiveObject* ao, const AODeadline deadline)
+{
+    configASSERT(ao->completes_deadlines);
+    if (deadline == AO_DEADLINE_NONE) {
+        return;
+    }
+
+    const uint32_t NOW = cycles_now();
+
+    taskENTER_CRITICAL();
+    record_deadline(ao, deadline, NOW);
+    taskEXIT_CRITICAL();
+}
+
+AODeadline ao_deadline_in(const uint32_t cycles)
+{
+    const AODeadline DEADLINE = cycles_now() + cycles;
+    return (DEADLINE == AO_DEADLINE_NONE) ? DEADLINE + 1 : DEADLINE;
+}
+
+bool ao_next_deadline(ActiveObject* ao, AODeadline* const deadline)
+{
+    AOQueueItem item;
+
+    if (ao->deadline == NULL || ao->transport != AO_TRANSPORT_QUEUE || !peek_item(ao, &item)) {
+        return false;
+    }
+
+    if (ao->overflow_policy == AO_OVERFLOW_COALESCE) {
+        load_coalesced(ao, &item, false);
+    }
+
+    const void* const EVENT = ao->by_value ? (const void*) item.value : item.reference;
+    if (EVENT == NULL) {
+        return false;
+    }
+
+    *deadline = ao->deadline(EVENT);
+    return *deadline != AO_DEADLINE_NONE;
+}
+
+void ao_get_stats(ActiveObject* ao, const AOLane lane, AOStats* const stats)
+{
+    configASSERT(lane < AO_LANES_TOTAL);
+
+    taskENTER_CRITICAL();
+    *stats = ao->stats[lane];
+    taskEXIT_CRITICAL();
+}
+
+void ao_get_dispatch_stats(ActiveObject* ao, AODispatchStats* const stats)
+{
+    taskENTER_CRITICAL();
+    *stats = ao->dispatch_stats;
+    taskEXIT_CRITICAL();
+}
+
+void ao_get_deadline_stats(ActiveObject* ao, AODeadlineStats* const stats)
+{
+    taskENTER_CRITICAL();
+    *stats = ao->deadline_stats;
+    taskEXIT_CRITICAL();
+}
+
+ActiveObject* ao_registry_get(const uint8_t id)
+{
+    return (id < ao_registry_count) ? ao_registry[id] : NULL;
+}
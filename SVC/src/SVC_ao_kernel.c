@@ -0,0 +1,142 @@
+// ------ inclusions ---------------------------------------------------
+#define LOG_MODULE_LEVEL LOG_LEVEL_AO
+
+#include "HAL_cycles.h"
+#include "SVC_ao_kernel.h"
+#include "SVC_log.h"
+
+/// | Private typedef -----------------------------------------------------------
+/// | Private define ------------------------------------------------------------
+/// | Private macro -------------------------------------------------------------
+
+#define READY_BIT(priority) ((uint32_t)1U << (priority))
+
+/// | Private variables ---------------------------------------------------------
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Kernel task: dispatch the highest priority ready AO, or sleep until some AO gets an event.
+/// @param parameters should be a reference to the kernel.
+static void ao_kernel_task(void* parameters);
+
+/// @brief Pick the ready AO whose next event has the earliest deadline.
+/// @param ready_set Ready AOs. Must not be empty.
+/// @return Priority of the picked AO. The highest priority ready AO if no event has a deadline.
+static UBaseType_t earliest_deadline(AOKernel* kernel, const uint32_t ready_set);
+
+/// | Private functions ---------------------------------------------------------
+
+static void ao_kernel_task(void* parameters)
+{
+    AOKernel* const KERNEL = (AOKernel*) (parameters);
+
+    LOG_INFO("Task Created");
+
+    while (1) {
+        taskENTER_CRITICAL();
+        const uint32_t READY_SET = KERNEL->ready_set;
+        taskEXIT_CRITICAL();
+
+        if (READY_SET == 0) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        const UBaseType_t PRIORITY = (KERNEL->policy == AO_KERNEL_EDF) ? earliest_deadline(KERNEL, READY_SET)
+                                                                      : 31U - (UBaseType_t)__builtin_clz(READY_SET);
+        ActiveObject* const AO = KERNEL->active_objects[PRIORITY];
+
+        ao_dispatch_next(AO, 0);
+
+        // Posters set the bit after queueing, so clearing it with an empty queue can not lose an event
+        taskENTER_CRITICAL();
+        if (ao_pending_events(AO) == 0) {
+            KERNEL->ready_set &= ~READY_BIT(PRIORITY);
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+static UBaseType_t earliest_deadline(AOKernel* kernel, const uint32_t ready_set)
+{
+    const AODeadline NOW = cycles_now();
+    UBaseType_t selected = 31U - (UBaseType_t)__builtin_clz(ready_set);
+    bool found = false;
+    int32_t earliest = 0;
+
+    // Highest priority first, so ties go to the highest priority AO
+    uint32_t pending = ready_set;
+    while (pending) {
+        const UBaseType_t PRIORITY = 31U - (UBaseType_t)__builtin_clz(pending);
+        pending &= ~READY_BIT(PRIORITY);
+        AODeadline deadline;
+
+        if (ao_next_deadline(kernel->active_objects[PRIORITY], &deadline)) {
+            // Relative to now, so the comparison survives the cycle counter wrap around
+            const int32_t REMAINING = (int32_t)(deadline - NOW);
+            if (!found || REMAINING < earliest) {
+                found = true;
+                earliest = REMAINING;
+                selected = PRIORITY;
+            }
+        }
+    }
+
+    return selected;
+}
+
+void ao_kernel_initialize(AOKernel* kernel, const AOKernelConfig* const config)
+{
+    configASSERT(kernel && config && config->stack && config->task_buffer);
+    configASSERT(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED);
+
+    kernel->ready_set = 0;
+    kernel->policy = config->policy;
+    for (size_t i = 0; i < AO_KERNEL_MAX_PRIORITIES; i++) {
+        kernel->active_objects[i] = NULL;
+    }
+
+    kernel->task = xTaskCreateStatic(
+            ao_kernel_task,
+            config->name,
+            config->stack_depth,
+            (void*) kernel,
+            config->priority,
+            config->stack,
+            config->task_buffer);
+    configASSERT(kernel->task);
+}
+
+void ao_kernel_attach(AOKernel* kernel, ActiveObject* ao, const UBaseType_t priority)
+{
+    configASSERT(kernel->task && "Kernel must be initialized before attaching AOs");
+    configASSERT(priority < AO_KERNEL_MAX_PRIORITIES);
+    configASSERT(kernel->active_objects[priority] == NULL && "AO priorities must be unique inside a kernel");
+
+    kernel->active_objects[priority] = ao;
+}
+
+void ao_kernel_signal(AOKernel* kernel, ActiveObject* ao)
+{
+    if (kernel == NULL) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    kernel->ready_set |= READY_BIT(ao->priority);
+    taskEXIT_CRITICAL();
+
+    xTaskNotifyGive(kernel->task);
+}
+
+void ao_kernel_signal_from_isr(AOKernel* kernel, ActiveObject* ao, BaseType_t* const woken)
+{
+    if (kernel == NULL) {
+        return;
+    }
+
+    const UBaseType_t SAVED_MASK = taskENTER_CRITICAL_FROM_ISR();
+    kernel->ready_set |= READY_BIT(ao->priority);
+    taskEXIT_CRITICAL_FROM_ISR(SAVED_MASK);
+
+    vTaskNotifyGiveFromISR(kernel->task, woken);
+}
@@ -0,0 +1,122 @@
+// ------ inclusions ---------------------------------------------------
+#include "SVC_ao_metrics.h"
+#include "SVC_format.h"
+
+/// | Private typedef -----------------------------------------------------------
+/// | Private define ------------------------------------------------------------
+
+/// @brief Longest line produced by `format_line()`, including the terminator.
+#define AO_METRICS_LINE_SIZE 128
+
+/// | Private macro -------------------------------------------------------------
+/// | Private variables ---------------------------------------------------------
+
+static const char AO_METRICS_HEADER[] = "id name             prio posted   dispatch dropped  depth    cyc min/avg/max      blocked missed last\n";
+
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Format the metrics of an AO as a single line.
+/// @return Amount of characters the line needs (excluding the terminator).
+static int format_line(char* const buffer, const size_t size, const ActiveObject* ao, const AOMetrics* const metrics);
+
+/// | Private functions ---------------------------------------------------------
+
+void ao_metrics_get(ActiveObject* ao, AOMetrics* const metrics)
+{
+    AODispatchStats dispatch_stats;
+    ao_get_dispatch_stats(ao, &dispatch_stats);
+    AODeadlineStats deadline_stats;
+    ao_get_deadline_stats(ao, &deadline_stats);
+
+    *metrics = (AOMetrics){0};
+    metrics->id = ao->id;
+    metrics->priority = (uint8_t) ao->priority;
+    metrics->last_event_type = dispatch_stats.last_event_type;
+    metrics->dispatched = dispatch_stats.dispatched;
+    metrics->deadline_missed = deadline_stats.missed;
+
+    if (dispatch_stats.dispatched > 0) {
+        metrics->cycles_min = dispatch_stats.cycles_min;
+        metrics->cycles_avg = (uint32_t)(dispatch_stats.cycles_total / dispatch_stats.dispatched);
+        metrics->cycles_max = dispatch_stats.cycles_max;
+    }
+
+    for (AOLane lane = AO_LANE_NORMAL; lane < AO_LANES_TOTAL; lane++) {
+        // Notification transports have no queues, but still account their posts on the normal lane
+        AOStats stats;
+        ao_get_stats(ao, lane, &stats);
+
+        metrics->posted += stats.posted;
+        metrics->dropped += stats.dropped;
+        metrics->blocked_ticks += stats.blocked_ticks;
+        metrics->depth_max[lane] = (uint16_t) stats.depth_max;
+
+        if (ao->queues[lane]) {
+            metrics->lanes++;
+            metrics->depth[lane] = (uint16_t) uxQueueMessagesWaiting(ao->queues[lane]);
+        }
+    }
+}
+
+size_t ao_metrics_snapshot(AOMetrics* const metrics, const size_t max_records)
+{
+    size_t records = 0;
+
+    for (ActiveObject* ao = ao_registry_get(0); ao && records < max_records; ao = ao_registry_get(ao->id + 1)) {
+        ao_metrics_get(ao, &metrics[records++]);
+    }
+
+    return records;
+}
+
+static int format_line(char* const buffer, const size_t size, const ActiveObject* ao, const AOMetrics* const metrics)
+{
+    return format_snprintf(buffer, size, "%-2u %-16.16s %-4u %-8lu %-8lu %-8lu %2u/%-2u %2u/%-2u %lu/%lu/%lu %-7lu %-6lu %u\n",
+            metrics->id, ao->name ? ao->name : "?", metrics->priority,
+            (unsigned long) metrics->posted, (unsigned long) metrics->dispatched, (unsigned long) metrics->dropped,
+            metrics->depth[AO_LANE_NORMAL], metrics->depth_max[AO_LANE_NORMAL],
+            metrics->depth[AO_LANE_URGENT], metrics->depth_max[AO_LANE_URGENT],
+            (unsigned long) metrics->cycles_min, (unsigned long) metrics->cycles_avg, (unsigned long) metrics->cycles_max,
+            (unsigned long) metrics->blocked_ticks, (unsigned long) metrics->deadline_missed, metrics->last_event_type);
+}
+
+size_t ao_metrics_format(char* const buffer, const size_t size)
+{
+    if (size == 0) {
+        return 0;
+    }
+
+    buffer[0] = '\0';
+    if (size <= sizeof(AO_METRICS_HEADER) - 1) {
+        return 0;
+    }
+
+    size_t length = (size_t) format_snprintf(buffer, size, "%s", AO_METRICS_HEADER);
+
+    for (ActiveObject* ao = ao_registry_get(0); ao; ao = ao_registry_get(ao->id + 1)) {
+        AOMetrics metrics;
+        ao_metrics_get(ao, &metrics);
+
+        const int LINE_LENGTH = format_line(&buffer[length], size - length, ao, &metrics);
+        if (LINE_LENGTH < 0 || (size_t) LINE_LENGTH >= size - length) {
+            buffer[length] = '\0'; // Truncated: leave the line out
+            break;
+        }
+        length += (size_t) LINE_LENGTH;
+    }
+
+    return length;
+}
+
+void ao_metrics_print()
+{
+    char line[AO_METRICS_LINE_SIZE];
+
+    format_printf("%s", AO_METRICS_HEADER);
+    for (ActiveObject* ao = ao_registry_get(0); ao; ao = ao_registry_get(ao->id + 1)) {
+        AOMetrics metrics;
+        ao_metrics_get(ao, &metrics);
+        format_line(line, sizeof(line), ao, &metrics);
+        format_printf("%s", line);
+    }
+}
@@ -0,0 +1,257 @@
+// ------ inclusions ---------------------------------------------------
+#define LOG_MODULE_LEVEL LOG_LEVEL_AO
+
+#include "HAL_cycles.h"
+#include "SVC_ao_qset.h"
+#include "SVC_log.h"
+
+/// | Private typedef -----------------------------------------------------------
+/// | Private define ------------------------------------------------------------
+/// | Private macro -------------------------------------------------------------
+/// | Private variables ---------------------------------------------------------
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Host task: wait for any member of the set and serve it.
+/// @param parameters should be a reference to the host.
+static void ao_qset_task(void* parameters);
+
+/// @brief Run the handler of a signal, if `member` is one of the watched semaphores.
+/// @return true if `member` was a semaphore.
+static bool dispatch_signal(AOQueueSet* host, QueueSetMemberHandle_t member);
+
+/// @brief Check whether a set member is one of the watched semaphores.
+static bool is_signal(AOQueueSet* host, QueueSetMemberHandle_t member);
+
+/// @brief Find the hosted AO that owns a queue.
+/// @return The owner, or NULL if `member` is not a hosted queue.
+static ActiveObject* owner_of(AOQueueSet* host, QueueSetMemberHandle_t member);
+
+/// @brief Find the hosted AO with the highest priority and pending events.
+/// @return That AO, or NULL if no AO has pending events.
+static ActiveObject* highest_pending(AOQueueSet* host);
+
+/// @brief Find the hosted AO whose next event has the earliest deadline.
+/// @return That AO, or `highest_pending()` if no pending event has a deadline.
+static ActiveObject* earliest_deadline(AOQueueSet* host);
+
+/// | Private functions ---------------------------------------------------------
+
+static void ao_qset_task(void* parameters)
+{
+    AOQueueSet* const HOST = (AOQueueSet*) (parameters);
+
+    LOG_INFO("Task Created");
+
+    while (1) {
+        // Each set entry stands for one item, so exactly one item is taken per entry (from whatever AO the policy
+        // picks) to keep both counts in step
+        QueueSetMemberHandle_t const MEMBER = xQueueSelectFromSet(HOST->set, portMAX_DELAY);
+        if (MEMBER == NULL || dispatch_signal(HOST, MEMBER)) {
+            continue;
+        }
+
+        ActiveObject* AO = NULL;
+        if (HOST->policy == AO_QSET_FAIR) {
+            AO = owner_of(HOST, MEMBER);
+        } else if (HOST->policy == AO_QSET_EDF) {
+            AO = earliest_deadline(HOST);
+        }
+        if (AO == NULL || ao_pending_events(AO) == 0) {
+            // Priority policy, or the entry outlived its item (AO_OVERFLOW_DROP_OLDEST): serve whoever is pending
+            AO = highest_pending(HOST);
+        }
+        if (AO) {
+            ao_dispatch_next(AO, 0);
+        }
+    }
+}
+
+static bool is_signal(AOQueueSet* host, QueueSetMemberHandle_t member)
+{
+    for (size_t i = 0; i < host->signals_count; i++) {
+        if ((QueueSetMemberHandle_t) host->signals[i].semaphore == member) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool dispatch_signal(AOQueueSet* host, QueueSetMemberHandle_t member)
+{
+    for (size_t i = 0; i < host->signals_count; i++) {
+        AOQueueSetSignal* const SIGNAL = &host->signals[i];
+
+        if ((QueueSetMemberHandle_t) SIGNAL->semaphore == member) {
+            if (xSemaphoreTake(SIGNAL->semaphore, 0) == pdPASS) {
+                SIGNAL->handler(SIGNAL->context);
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static ActiveObject* owner_of(AOQueueSet* host, QueueSetMemberHandle_t member)
+{
+    for (size_t i = 0; i < host->active_objects_count; i++) {
+        ActiveObject* const AO = host->active_objects[i];
+
+        for (size_t lane = 0; lane < AO_LANES_TOTAL; lane++) {
+            if (AO->queues[lane] && (QueueSetMemberHandle_t) AO->queues[lane] == member) {
+                return AO;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static ActiveObject* highest_pending(AOQueueSet* host)
+{
+    ActiveObject* selected = NULL;
+
+    for (size_t i = 0; i < host->active_objects_count; i++) {
+        ActiveObject* const AO = host->active_objects[i];
+
+        if ((selected == NULL || AO->priority > selected->priority) && ao_pending_events(AO) > 0) {
+            selected = AO;
+        }
+    }
+
+    return selected;
+}
+
+static ActiveObject* earliest_deadline(AOQueueSet* host)
+{
+    const AODeadline NOW = cycles_now();
+    ActiveObject* selected = NULL;
+    int32_t earliest = 0;
+
+    for (size_t i = 0; i < host->active_objects_count; i++) {
+        ActiveObject* const AO = host->active_objects[i];
+        AODeadline deadline;
+
+        if (ao_next_deadline(AO, &deadline)) {
+            // Relative to now, so the comparison survives the cycle counter wrap around
+            const int32_t REMAINING = (int32_t)(deadline - NOW);
+            if (selected == NULL || REMAINING < earliest ||
+                (REMAINING == earliest && AO->priority > selected->priority)) {
+                selected = AO;
+                earliest = REMAINING;
+            }
+        }
+    }
+
+    return selected ? selected : highest_pending(host);
+}
+
+void ao_qset_initialize(AOQueueSet* host, const AOQueueSetConfig* const config)
+{
+    configASSERT(host && config && config->stack && config->task_buffer);
+    configASSERT(config->length > 0 && config->storage);
+    configASSERT(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED);
+
+    host->policy = config->policy;
+    host->length = config->length;
+    host->used = 0;
+    host->active_objects_count = 0;
+    host->signals_count = 0;
+
+    // xQueueCreateSet() only has a dynamic version, but a queue set is just a queue of member handles
+    host->set = (QueueSetHandle_t) xQueueGenericCreateStatic(
+            config->length,
+            sizeof(QueueSetMemberHandle_t),
+            config->storage,
+            &host->set_buffer,
+            queueQUEUE_TYPE_SET);
+    configASSERT(host->set);
+
+    host->task = xTaskCreateStatic(
+            ao_qset_task,
+            config->name,
+            config->stack_depth,
+            (void*) host,
+            config->priority,
+            config->stack,
+            config->task_buffer);
+    configASSERT(host->task);
+}
+
+void ao_qset_attach(AOQueueSet* host, ActiveObject* ao, const UBaseType_t length)
+{
+    configASSERT(host->task && "Host must be initialized before attaching AOs");
+    configASSERT(host->active_objects_count < AO_QSET_MAX_ACTIVE_OBJECTS);
+    // A full set asserts inside FreeRTOS as soon as a member gets one item too many
+    configASSERT(host->used + length <= host->length && "Queue set too short for its members");
+
+    for (size_t lane = 0; lane < AO_LANES_TOTAL; lane++) {
+        if (ao->queues[lane]) {
+            const BaseType_t ADDED = xQueueAddToSet(ao->queues[lane], host->set);
+            configASSERT(ADDED == pdPASS);
+        }
+    }
+
+    host->used += length;
+    host->active_objects[host->active_objects_count++] = ao;
+}
+
+void ao_qset_add_signal(AOQueueSet* host, SemaphoreHandle_t semaphore, ao_qset_signal_handler_t handler, void* context)
+{
+    configASSERT(host->task && semaphore && handler);
+    configASSERT(host->signals_count < AO_QSET_MAX_SIGNALS);
+    configASSERT(host->used + 1 <= host->length && "Queue set too short for its members");
+
+    const BaseType_t ADDED = xQueueAddToSet(semaphore, host->set);
+    configASSERT(ADDED == pdPASS);
+
+    host->used++;
+    host->signals[host->signals_count++] = (AOQueueSetSignal){
+        .semaphore = semaphore,
+        .handler = handler,
+        .context = context,
+    };
+}
+
+void ao_qset_forget(AOQueueSet* host)
+{
+    if (host == NULL) {
+        return;
+    }
+
+    // Any AO entry will do: the host serves AOs by their own queues, entries just count items. Finding the set empty
+    // means the host already took the entry, and will find one item less. Semaphore entries are the only way a
+    // signal is ever seen, so they are skipped and go back to the front, in their order: taking one instead of an AO
+    // entry would leave the set an entry over its items, and the next post would overflow it.
+    QueueSetMemberHandle_t skipped[AO_QSET_MAX_SIGNALS];
+    size_t skipped_count = 0;
+    QueueSetMemberHandle_t stale;
+
+    while (xQueueReceive((QueueHandle_t) host->set, &stale, 0) == pdPASS && is_signal(host, stale)) {
+        configASSERT(skipped_count < AO_QSET_MAX_SIGNALS);
+        skipped[skipped_count++] = stale;
+    }
+    while (skipped_count > 0) {
+        (void) xQueueSendToFront((QueueHandle_t) host->set, &skipped[--skipped_count], 0);
+    }
+}
+
+void ao_qset_forget_from_isr(AOQueueSet* host, BaseType_t* const woken)
+{
+    if (host == NULL) {
+        return;
+    }
+
+    QueueSetMemberHandle_t skipped[AO_QSET_MAX_SIGNALS];
+    size_t skipped_count = 0;
+    QueueSetMemberHandle_t stale;
+
+    while (xQueueReceiveFromISR((QueueHandle_t) host->set, &stale, woken) == pdPASS && is_signal(host, stale)) {
+        configASSERT(skipped_count < AO_QSET_MAX_SIGNALS);
+        skipped[skipped_count++] = stale;
+    }
+    while (skipped_count > 0) {
+        (void) xQueueSendToFrontFromISR((QueueHandle_t) host->set, &skipped[--skipped_count], woken);
+    }
+}
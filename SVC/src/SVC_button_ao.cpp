@@ -0,0 +1,264 @@
+// ------ inclusions ---------------------------------------------------
+#include "SVC_ao.hpp"
+
+extern "C" {
+#include "SVC_button.h"
+#include "SVC_hsm.h"
+#include "SVC_time_event.h"
+}
+
+#if !BUTTON_CORO
+
+/// | Private typedef -----------------------------------------------------------
+
+namespace
+{
+
+/// @brief Signals of the button HSM.
+enum ButtonSignal : HSMSignal
+{
+    BUTTON_SIGNAL_SAMPLE = HSM_SIGNAL_USER, ///< Time to poll the button. Dispatched as PRESSED or RELEASED instead.
+    BUTTON_SIGNAL_PRESSED,                  ///< The sampled level is BUTTON_PRESSED.
+    BUTTON_SIGNAL_RELEASED,                 ///< The sampled level is BUTTON_RELEASED.
+    BUTTON_SIGNAL_DEBOUNCED,                ///< The level has been stable for DEBOUNCE_PERIOD_MS.
+    BUTTON_SIGNAL_GESTURE,                  ///< The button has been held up to the next gesture threshold.
+};
+
+/// @brief Stack of the button AO, in words. Hosted AOs run on the stack of their host.
+constexpr std::size_t STACK_WORDS = BUTTON_AO_QUEUE_SET_HOSTED ? 0 : BUTTON_AO_STACK_DEPTH;
+
+/// @brief Events posted by the time events of the button AO.
+constexpr ButtonSignalEvent SAMPLE_EVENT = {BUTTON_SIGNAL_SAMPLE};
+constexpr ButtonSignalEvent DEBOUNCED_EVENT = {BUTTON_SIGNAL_DEBOUNCED};
+constexpr ButtonSignalEvent GESTURE_EVENT = {BUTTON_SIGNAL_GESTURE};
+
+/// @brief Pressed time at which each gesture is detected, in ms.
+constexpr std::uint32_t GESTURE_THRESHOLDS_MS[] = {
+    0,
+    EVENT_SHORT_THRESHOLD_MIN_MS,
+    EVENT_LONG_THRESHOLD_MIN_MS,
+    EVENT_BLOCKED_THRESHOLD_MIN_MS,
+};
+
+/// @brief Button Active Object, on top of the C++ layer. A debouncer driven by a hierarchical state machine (released,
+///        debouncing press, held, debouncing release), whose timeouts are time events. Its detected gestures are
+///        published on TOPIC_LED through `button_gesture_reached()` and `button_gesture_released()`.
+class Button : public svc::ActiveObject<Button, ButtonSignalEvent, BUTTON_AO_QUEUE_LENGTH, STACK_WORDS,
+                                        BUTTON_AO_PRIORITY>
+{
+public:
+    /// @brief Create the AO, its time events and its state machine, and start polling the button.
+    void begin(const char* name, const BoardButtons button, AOQueueSet* host)
+    {
+        // A sample or an expiration that finds the queue full is simply lost: the next sample catches up
+        start(name, AO_OVERFLOW_DROP_NEWEST, host);
+
+        button_ = button;
+        current_event_ = EVENT_INITIAL;
+        time_event_create(&sample_, core(), &SAMPLE_EVENT);
+        time_event_create(&debounce_, core(), &DEBOUNCED_EVENT);
+        time_event_create(&gesture_, core(), &GESTURE_EVENT);
+        hsm_initialize(&hsm_, &STATE_RELEASED, this);
+
+        time_event_arm(&sample_, pdMS_TO_TICKS(BUTTON_SAMPLE_PERIOD_MS), pdMS_TO_TICKS(BUTTON_SAMPLE_PERIOD_MS));
+    }
+
+    /// @brief Event handler.
+    void on(const ButtonSignalEvent& event)
+    {
+        HSMSignal signal = event.signal;
+        if (signal == BUTTON_SIGNAL_SAMPLE) {
+            // Every state sees the sample as the level it read
+            signal = (button_read(button_) == BUTTON_PRESSED) ? BUTTON_SIGNAL_PRESSED : BUTTON_SIGNAL_RELEASED;
+        }
+
+        hsm_dispatch(&hsm_, signal, &event);
+    }
+
+private:
+    static Button& self(HSM* hsm)
+    {
+        return *static_cast<Button*>(hsm->context);
+    }
+
+    /// @brief Top state: ignores whatever no other state handles, such as stale expirations.
+    static HSMStatus state_top(HSM*, const HSMSignal, const void*)
+    {
+        return HSM_HANDLED; // Top state: nothing to bubble up to
+    }
+
+    /// @brief Key released, waiting to be pressed.
+    static HSMStatus state_released(HSM* hsm, const HSMSignal signal, const void*)
+    {
+        switch (signal) {
+        case BUTTON_SIGNAL_PRESSED:
+            button_edge_detected();
+            return hsm_transition(hsm, &TO_DEBOUNCING_PRESS);
+        default:
+            return HSM_UNHANDLED;
+        }
+    }
+
+    /// @brief The key has been pressed and we need to filter the debouncing.
+    static HSMStatus state_debouncing_press(HSM* hsm, const HSMSignal signal, const void*)
+    {
+        Button& ao = self(hsm);
+
+        switch (signal) {
+        case HSM_SIGNAL_ENTRY:
+            time_event_arm(&ao.debounce_, pdMS_TO_TICKS(DEBOUNCE_PERIOD_MS), 0);
+            return HSM_HANDLED;
+        case HSM_SIGNAL_EXIT:
+            time_event_disarm(&ao.debounce_);
+            return HSM_HANDLED;
+        case BUTTON_SIGNAL_RELEASED:
+            return hsm_transition(hsm, &TO_RELEASED);
+        case BUTTON_SIGNAL_DEBOUNCED:
+            // Re-armed since it expired: this is the expiration of an earlier transient
+            if (time_event_is_armed(&ao.debounce_)) {
+                return HSM_HANDLED;
+            }
+            return hsm_transition(hsm, &TO_HELD);
+        default:
+            return HSM_UNHANDLED;
+        }
+    }
+
+    /// @brief The key is held (a bounce on release does not leave this state): a new gesture starts on entry.
+    static HSMStatus state_held(HSM* hsm, const HSMSignal signal, const void*)
+    {
+        Button& ao = self(hsm);
+
+        switch (signal) {
+        case HSM_SIGNAL_ENTRY:
+            ao.current_event_ = EVENT_INITIAL;
+            time_event_arm(&ao.gesture_, pdMS_TO_TICKS(GESTURE_THRESHOLDS_MS[EVENT_SHORT]), 0);
+            return HSM_HANDLED;
+        case HSM_SIGNAL_EXIT:
+            time_event_disarm(&ao.gesture_);
+            return HSM_HANDLED;
+        case BUTTON_SIGNAL_GESTURE:
+            if (time_event_is_armed(&ao.gesture_)) {
+                return HSM_HANDLED; // Stale expiration of an earlier gesture
+            }
+            ao.next_gesture();
+            return HSM_HANDLED;
+        default:
+            return HSM_UNHANDLED;
+        }
+    }
+
+    /// @brief Key pressed, waiting to be released.
+    static HSMStatus state_pressed(HSM* hsm, const HSMSignal signal, const void*)
+    {
+        switch (signal) {
+        case BUTTON_SIGNAL_RELEASED:
+            button_edge_detected();
+            return hsm_transition(hsm, &TO_DEBOUNCING_RELEASE);
+        default:
+            return HSM_UNHANDLED;
+        }
+    }
+
+    /// @brief The key has been released, so we need to filter the debouncing.
+    static HSMStatus state_debouncing_release(HSM* hsm, const HSMSignal signal, const void*)
+    {
+        Button& ao = self(hsm);
+
+        switch (signal) {
+        case HSM_SIGNAL_ENTRY:
+            time_event_arm(&ao.debounce_, pdMS_TO_TICKS(DEBOUNCE_PERIOD_MS), 0);
+            return HSM_HANDLED;
+        case HSM_SIGNAL_EXIT:
+            time_event_disarm(&ao.debounce_);
+            return HSM_HANDLED;
+        case BUTTON_SIGNAL_PRESSED:
+            // A bounce: the gesture goes on where it was
+            return hsm_transition(hsm, &TO_PRESSED);
+        case BUTTON_SIGNAL_DEBOUNCED:
+            if (time_event_is_armed(&ao.debounce_)) {
+                return HSM_HANDLED; // Stale expiration of an earlier transient
+            }
+            button_gesture_released(ao.current_event_);
+            return hsm_transition(hsm, &TO_RELEASED);
+        default:
+            return HSM_UNHANDLED;
+        }
+    }
+
+    /// @brief Process the "gesture threshold reached" action, which happens whenever the button has been held for
+    ///        EVENT_SHORT_THRESHOLD_MIN_MS, EVENT_LONG_THRESHOLD_MIN_MS and EVENT_BLOCKED_THRESHOLD_MIN_MS. The current
+    ///        event moves to the next gesture, and the next threshold gets armed.
+    void next_gesture()
+    {
+        if (current_event_ >= EVENT_BLOCKED) {
+            return;
+        }
+
+        // Gestures only move forward while the button is held, so the next threshold is the only one worth a timeout
+        current_event_ = static_cast<ButtonEvent>(current_event_ + 1);
+        if (current_event_ < EVENT_BLOCKED) {
+            const std::uint32_t NEXT_MS =
+                    GESTURE_THRESHOLDS_MS[current_event_ + 1] - GESTURE_THRESHOLDS_MS[current_event_];
+            time_event_arm(&gesture_, pdMS_TO_TICKS(NEXT_MS), 0);
+        }
+
+        button_gesture_reached(current_event_);
+    }
+
+    static const HSMState STATE_TOP;
+    static const HSMState STATE_RELEASED;
+    static const HSMState STATE_DEBOUNCING_PRESS;
+    static const HSMState STATE_HELD;
+    static const HSMState STATE_PRESSED;
+    static const HSMState STATE_DEBOUNCING_RELEASE;
+
+    static const HSMTransition TO_RELEASED;
+    static const HSMTransition TO_DEBOUNCING_PRESS;
+    static const HSMTransition TO_HELD;
+    static const HSMTransition TO_PRESSED;
+    static const HSMTransition TO_DEBOUNCING_RELEASE;
+
+    HSM hsm_;                   ///< Debouncer states
+    BoardButtons button_;       ///< Button instance associated to the AO
+    ButtonEvent current_event_; ///< Gesture detected so far while the button is held
+    TimeEvent sample_;          ///< Periodic: polls the button level
+    TimeEvent debounce_;        ///< One-shot: end of a debouncing transient
+    TimeEvent gesture_;         ///< One-shot: next gesture threshold while the button is held
+};
+
+const HSMState Button::STATE_TOP = {"top", nullptr, state_top, nullptr};
+const HSMState Button::STATE_RELEASED = {"released", &STATE_TOP, state_released, nullptr};
+const HSMState Button::STATE_DEBOUNCING_PRESS = {"debouncing press", &STATE_TOP, state_debouncing_press, nullptr};
+const HSMState Button::STATE_HELD = {"held", &STATE_TOP, state_held, &STATE_PRESSED};
+const HSMState Button::STATE_PRESSED = {"pressed", &STATE_HELD, state_pressed, nullptr};
+const HSMState Button::STATE_DEBOUNCING_RELEASE = {"debouncing release", &STATE_HELD, state_debouncing_release,
+                                                   nullptr};
+
+const HSMTransition Button::TO_RELEASED = HSM_TRANSITION_TO(&STATE_RELEASED);
+const HSMTransition Button::TO_DEBOUNCING_PRESS = HSM_TRANSITION_TO(&STATE_DEBOUNCING_PRESS);
+const HSMTransition Button::TO_HELD = HSM_TRANSITION_TO(&STATE_HELD);
+const HSMTransition Button::TO_PRESSED = HSM_TRANSITION_TO(&STATE_PRESSED);
+const HSMTransition Button::TO_DEBOUNCING_RELEASE = HSM_TRANSITION_TO(&STATE_DEBOUNCING_RELEASE);
+
+} // namespace
+
+/// | Private variables ---------------------------------------------------------
+
+/// @brief Zero initialized like any other static object: its constructor does nothing, so it needs no startup code.
+static Button button_ao_instance;
+
+/// | Exported functions --------------------------------------------------------
+
+void button_initialize_ao(const char* ao_task_name, const BoardButtons button, AOQueueSet* host)
+{
+    configASSERT((host != NULL) == (BUTTON_AO_QUEUE_SET_HOSTED != 0));
+    button_ao_instance.begin(ao_task_name, button, host);
+}
+
+ActiveObject* button_ao()
+{
+    return button_ao_instance.core();
+}
+
+#endif
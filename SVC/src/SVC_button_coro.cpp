@@ -0,0 +1,87 @@
+// ------ inclusions ---------------------------------------------------
+#include "SVC_coro.hpp"
+
+extern "C" {
+#include "SVC_button.h"
+}
+
+#if BUTTON_CORO
+
+/// | Private define ------------------------------------------------------------
+
+/// @brief A single coroutine: the debouncer.
+#define BUTTON_CORO_MAX_COROUTINES 1
+
+/// | Private variables ---------------------------------------------------------
+
+namespace
+{
+
+/// @brief Pressed time at which each gesture is detected, in ms.
+constexpr std::uint32_t GESTURE_THRESHOLDS_MS[] = {
+    0,
+    EVENT_SHORT_THRESHOLD_MIN_MS,
+    EVENT_LONG_THRESHOLD_MIN_MS,
+    EVENT_BLOCKED_THRESHOLD_MIN_MS,
+};
+
+/// @brief Same stack and priority as the button AO, so both variants compare on equal terms.
+svc::coro::Executor<BUTTON_CORO_MAX_COROUTINES, BUTTON_AO_STACK_DEPTH, BUTTON_AO_PRIORITY> executor;
+
+/// | Private functions ---------------------------------------------------------
+
+/// @brief Debouncer: the same states as the button HSM (released, debouncing press, held, debouncing release), but
+///        written as straight-line code. The held state samples the button every BUTTON_SAMPLE_PERIOD_MS, which is
+///        also the resolution of the gesture thresholds.
+/// @param button Button to be debounced
+svc::coro::Task debounce(const BoardButtons button)
+{
+    for (;;) {
+        co_await svc::coro::edge(button, BUTTON_PRESSED);
+        button_edge_detected();
+
+        co_await svc::coro::delay(pdMS_TO_TICKS(DEBOUNCE_PERIOD_MS));
+        if (button_read(button) != BUTTON_PRESSED) {
+            continue; // A transient
+        }
+
+        const TickType_t PRESSED_AT = xTaskGetTickCount();
+        ButtonEvent gesture = EVENT_INITIAL;
+
+        for (;;) {
+            co_await svc::coro::delay(pdMS_TO_TICKS(BUTTON_SAMPLE_PERIOD_MS));
+
+            const TickType_t HELD = xTaskGetTickCount() - PRESSED_AT;
+            while (gesture < EVENT_BLOCKED && HELD >= pdMS_TO_TICKS(GESTURE_THRESHOLDS_MS[gesture + 1])) {
+                gesture = static_cast<ButtonEvent>(gesture + 1);
+                button_gesture_reached(gesture);
+            }
+
+            if (button_read(button) == BUTTON_PRESSED) {
+                continue;
+            }
+
+            button_edge_detected();
+            co_await svc::coro::delay(pdMS_TO_TICKS(DEBOUNCE_PERIOD_MS));
+            if (button_read(button) == BUTTON_RELEASED) {
+                break;
+            }
+            // A bounce: the gesture goes on where it was
+        }
+
+        button_gesture_released(gesture);
+    }
+}
+
+} // namespace
+
+/// | Exported functions --------------------------------------------------------
+
+void button_coro_init(const BoardButtons button)
+{
+    executor.start("coro_button");
+    const bool SPAWNED = executor.spawn(debounce(button));
+    configASSERT(SPAWNED && "The debouncer frame does not fit CORO_FRAME_SIZE");
+}
+
+#endif
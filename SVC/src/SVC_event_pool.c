@@ -0,0 +1,230 @@
+// ------ inclusions ---------------------------------------------------
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "SVC_event_pool.h"
+
+/// | Private typedef -----------------------------------------------------------
+
+/// @brief Free blocks are chained through their first word, so a free block costs no extra RAM.
+typedef struct FreeBlock
+{
+    struct FreeBlock* next;
+} FreeBlock;
+
+/// @brief Fixed-block pool. All fields but `storage`, `ref_counts`, `block_size` and `blocks_total` are protected by a
+///        critical section.
+typedef struct
+{
+    uint8_t* const storage;    ///< First byte of the pool storage
+    uint8_t* const ref_counts; ///< Reference count of each block. Zero means the block is free
+    const size_t block_size;   ///< Size of each block, in bytes
+    const size_t blocks_total; ///< Amount of blocks owned by the pool
+    FreeBlock* free_list;      ///< Head of the free blocks list
+    size_t blocks_free;        ///< Amount of blocks in the free list
+    size_t blocks_min_free;    ///< Low-water mark of `blocks_free`
+    uint32_t exhausted;        ///< Times a request for this class found no free block
+} EventPool;
+
+/// | Private define ------------------------------------------------------------
+
+#define EVENT_POOL_ALIGNMENT 8
+#define EVENT_POOL_MAX_REFERENCES UINT8_MAX
+
+/// | Private macro -------------------------------------------------------------
+
+/// @brief true if `block` lays inside the storage of `pool`.
+#define EVENT_POOL_OWNS(pool, block) \
+    (((uint8_t*)(block) >= (pool)->storage) && \
+     ((uint8_t*)(block) < ((pool)->storage + ((pool)->block_size * (pool)->blocks_total))))
+
+/// @brief Index of `block` inside the storage of `pool`.
+#define EVENT_POOL_INDEX(pool, block) (((uint8_t*)(block) - (pool)->storage) / (pool)->block_size)
+
+/// | Private variables ---------------------------------------------------------
+
+static uint8_t small_storage[EVENT_POOL_SMALL_BLOCK_SIZE * EVENT_POOL_SMALL_BLOCKS] __attribute__((aligned(EVENT_POOL_ALIGNMENT)));
+static uint8_t medium_storage[EVENT_POOL_MEDIUM_BLOCK_SIZE * EVENT_POOL_MEDIUM_BLOCKS] __attribute__((aligned(EVENT_POOL_ALIGNMENT)));
+static uint8_t large_storage[EVENT_POOL_LARGE_BLOCK_SIZE * EVENT_POOL_LARGE_BLOCKS] __attribute__((aligned(EVENT_POOL_ALIGNMENT)));
+
+static uint8_t small_ref_counts[EVENT_POOL_SMALL_BLOCKS];
+static uint8_t medium_ref_counts[EVENT_POOL_MEDIUM_BLOCKS];
+static uint8_t large_ref_counts[EVENT_POOL_LARGE_BLOCKS];
+
+/// @brief Available pools, sorted by block size.
+static EventPool EVENT_POOLS[EVENT_POOL_TOTAL] =
+{
+    [EVENT_POOL_SMALL] = {small_storage, small_ref_counts, EVENT_POOL_SMALL_BLOCK_SIZE, EVENT_POOL_SMALL_BLOCKS},
+    [EVENT_POOL_MEDIUM] = {medium_storage, medium_ref_counts, EVENT_POOL_MEDIUM_BLOCK_SIZE, EVENT_POOL_MEDIUM_BLOCKS},
+    [EVENT_POOL_LARGE] = {large_storage, large_ref_counts, EVENT_POOL_LARGE_BLOCK_SIZE, EVENT_POOL_LARGE_BLOCKS},
+};
+
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Take a block from the best fitting pool. Must be called inside a critical section.
+/// @param size Requested size, in bytes.
+/// @return Pointer to the block, or NULL if every fitting pool is exhausted.
+static void* pool_take(const size_t size);
+
+/// @brief Drop one reference of a block, returning it to the pool that owns it when it was the last one.
+///        Must be called inside a critical section.
+/// @param block Block to be released.
+static void pool_give(void* const block);
+
+/// @brief Find the pool that owns a block.
+/// @param block Block previously obtained from any pool.
+/// @return Owner pool. Asserts if there is none.
+static EventPool* pool_owner(const void* const block);
+
+/// | Private functions ---------------------------------------------------------
+
+static void* pool_take(const size_t size)
+{
+    for (size_t i = 0; i < EVENT_POOL_TOTAL; i++) {
+        EventPool* const POOL = &EVENT_POOLS[i];
+
+        if (size > POOL->block_size) {
+            continue;
+        }
+
+        if (POOL->free_list == NULL) {
+            POOL->exhausted++;
+            continue;
+        }
+
+        FreeBlock* const BLOCK = POOL->free_list;
+        POOL->free_list = BLOCK->next;
+        POOL->ref_counts[EVENT_POOL_INDEX(POOL, BLOCK)] = 1;
+        POOL->blocks_free--;
+        if (POOL->blocks_free < POOL->blocks_min_free) {
+            POOL->blocks_min_free = POOL->blocks_free;
+        }
+        return BLOCK;
+    }
+
+    return NULL;
+}
+
+static EventPool* pool_owner(const void* const block)
+{
+    for (size_t i = 0; i < EVENT_POOL_TOTAL; i++) {
+        if (EVENT_POOL_OWNS(&EVENT_POOLS[i], block)) {
+            return &EVENT_POOLS[i];
+        }
+    }
+
+    configASSERT(pdFAIL && "Block does not belong to any event pool");
+    return NULL;
+}
+
+static void pool_give(void* const block)
+{
+    EventPool* const POOL = pool_owner(block);
+    uint8_t* const REF_COUNT = &POOL->ref_counts[EVENT_POOL_INDEX(POOL, block)];
+    configASSERT(*REF_COUNT > 0);
+
+    if (--(*REF_COUNT) > 0) {
+        return;
+    }
+
+    FreeBlock* const BLOCK = (FreeBlock*) block;
+    BLOCK->next = POOL->free_list;
+    POOL->free_list = BLOCK;
+    POOL->blocks_free++;
+}
+
+void event_pool_init()
+{
+    for (size_t i = 0; i < EVENT_POOL_TOTAL; i++) {
+        EventPool* const POOL = &EVENT_POOLS[i];
+        configASSERT((POOL->block_size % sizeof(FreeBlock)) == 0);
+
+        POOL->free_list = NULL;
+        for (size_t block = POOL->blocks_total; block > 0; block--) {
+            FreeBlock* const BLOCK = (FreeBlock*) (POOL->storage + ((block - 1) * POOL->block_size));
+            BLOCK->next = POOL->free_list;
+            POOL->free_list = BLOCK;
+            POOL->ref_counts[block - 1] = 0;
+        }
+
+        POOL->blocks_free = POOL->blocks_total;
+        POOL->blocks_min_free = POOL->blocks_total;
+        POOL->exhausted = 0;
+    }
+}
+
+void* event_pool_get(const size_t size)
+{
+    taskENTER_CRITICAL();
+    void* const BLOCK = pool_take(size);
+    taskEXIT_CRITICAL();
+
+    return BLOCK;
+}
+
+void* event_pool_get_from_isr(const size_t size)
+{
+    const UBaseType_t SAVED_MASK = taskENTER_CRITICAL_FROM_ISR();
+    void* const BLOCK = pool_take(size);
+    taskEXIT_CRITICAL_FROM_ISR(SAVED_MASK);
+
+    return BLOCK;
+}
+
+void event_pool_put(void* const block)
+{
+    if (block == NULL) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    pool_give(block);
+    taskEXIT_CRITICAL();
+}
+
+void event_pool_put_from_isr(void* const block)
+{
+    if (block == NULL) {
+        return;
+    }
+
+    const UBaseType_t SAVED_MASK = taskENTER_CRITICAL_FROM_ISR();
+    pool_give(block);
+    taskEXIT_CRITICAL_FROM_ISR(SAVED_MASK);
+}
+
+void event_pool_retain(void* const block, const uint8_t references)
+{
+    EventPool* const POOL = pool_owner(block);
+    uint8_t* const REF_COUNT = &POOL->ref_counts[EVENT_POOL_INDEX(POOL, block)];
+
+    taskENTER_CRITICAL();
+    configASSERT(*REF_COUNT > 0 && (*REF_COUNT + references) <= EVENT_POOL_MAX_REFERENCES);
+    *REF_COUNT += references;
+    taskEXIT_CRITICAL();
+}
+
+void event_pool_retain_from_isr(void* const block, const uint8_t references)
+{
+    EventPool* const POOL = pool_owner(block);
+    uint8_t* const REF_COUNT = &POOL->ref_counts[EVENT_POOL_INDEX(POOL, block)];
+
+    const UBaseType_t SAVED_MASK = taskENTER_CRITICAL_FROM_ISR();
+    configASSERT(*REF_COUNT > 0 && (*REF_COUNT + references) <= EVENT_POOL_MAX_REFERENCES);
+    *REF_COUNT += references;
+    taskEXIT_CRITICAL_FROM_ISR(SAVED_MASK);
+}
+
+void event_pool_get_stats(const EventPoolClass pool, EventPoolStats* const stats)
+{
+    configASSERT(pool < EVENT_POOL_TOTAL);
+    const EventPool* const POOL = &EVENT_POOLS[pool];
+
+    taskENTER_CRITICAL();
+    stats->block_size = POOL->block_size;
+    stats->blocks_total = POOL->blocks_total;
+    stats->blocks_free = POOL->blocks_free;
+    stats->blocks_max = POOL->blocks_total - POOL->blocks_min_free;
+    stats->exhausted = POOL->exhausted;
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,438 @@
+// ------ inclusions ---------------------------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "SVC_format.h"
+
+#if defined(__arm__)
+/// @brief SWV console (Core/Src/main.c). A plain system call: no newlib stdio, so no `struct _reent` either.
+extern int _write(int file, char* ptr, int len);
+#define FORMAT_CONSOLE_WRITE(data, length) _write(1, (char*)(data), (int)(length))
+#else
+// Host build: the standard output
+#include <unistd.h>
+#define FORMAT_CONSOLE_WRITE(data, length) ((void) write(1, (data), (length)))
+#endif
+
+/// | Private typedef -----------------------------------------------------------
+
+/// @brief Size of the argument, from the length modifier.
+typedef enum
+{
+    FORMAT_LENGTH_INT = 0,
+    FORMAT_LENGTH_CHAR,
+    FORMAT_LENGTH_SHORT,
+    FORMAT_LENGTH_LONG,
+    FORMAT_LENGTH_LONG_LONG,
+    FORMAT_LENGTH_SIZE,
+    FORMAT_LENGTH_MAX,
+    FORMAT_LENGTH_PTRDIFF,
+} FormatLength;
+
+/// @brief A parsed conversion specification.
+typedef struct
+{
+    bool left;            ///< `-`: pad on the right.
+    bool zero;            ///< `0`: pad numbers with zeros.
+    bool alternate;       ///< `#`: 0x prefix for %x, leading zero for %o.
+    char sign;            ///< `+` or ` ` in front of non-negative numbers, or 0.
+    size_t width;         ///< Minimum length.
+    bool has_precision;   ///< Whether a precision was given.
+    size_t precision;     ///< Minimum digits of a number, or maximum characters of a string.
+    FormatLength length;  ///< Size of the argument.
+} FormatSpec;
+
+/// @brief Formatted text on its way out: gathered in `buffer`, and handed to `write` when it fills up. Without a
+///        `write` the text beyond `buffer` is only counted, as snprintf() does.
+typedef struct
+{
+    format_write_t write; ///< Where full buffers go, or NULL.
+    void* context;        ///< Passed to `write`.
+    char* buffer;         ///< Text not written yet.
+    size_t size;          ///< Capacity of `buffer`.
+    size_t used;          ///< Bytes in `buffer`.
+    size_t total;         ///< Length of the whole text so far.
+} FormatOutput;
+
+/// | Private define ------------------------------------------------------------
+
+/// @brief Digits of the longest number: 64 bits in octal.
+#define FORMAT_DIGITS_SIZE 22
+
+/// | Private macro -------------------------------------------------------------
+/// | Private variables ---------------------------------------------------------
+
+static const char LOWER_DIGITS[] = "0123456789abcdef";
+static const char UPPER_DIGITS[] = "0123456789ABCDEF";
+
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Append a character to the output.
+static void put(FormatOutput* const out, const char character);
+
+/// @brief Append a character `count` times.
+static void put_repeated(FormatOutput* const out, const char character, size_t count);
+
+/// @brief Hand the buffered text to the writer.
+static void hand_over(FormatOutput* const out);
+
+/// @brief Append a number.
+/// @param value Absolute value.
+/// @param negative Whether a minus sign goes in front.
+/// @param base 8, 10 or 16.
+/// @param digits LOWER_DIGITS or UPPER_DIGITS.
+static void put_number(FormatOutput* const out, const FormatSpec* const spec, uint64_t value, const bool negative,
+                       const uint8_t base, const char* const digits);
+
+/// @brief Append a string, cut at the precision and padded to the width.
+static void put_string(FormatOutput* const out, const FormatSpec* const spec, const char* string);
+
+/// @brief Format into an output. Shared by every public function.
+static void render(FormatOutput* const out, const char* format, va_list arguments);
+
+/// @brief Writer of `format_printf()`.
+static void write_console(const char* data, const size_t length, void* context);
+
+/// | Private functions ---------------------------------------------------------
+
+static void hand_over(FormatOutput* const out)
+{
+    if (out->write && out->used > 0) {
+        out->write(out->buffer, out->used, out->context);
+        out->used = 0;
+    }
+}
+
+static void put(FormatOutput* const out, const char character)
+{
+    if (out->used == out->size) {
+        if (out->write == NULL) {
+            out->total++;
+            return;
+        }
+        hand_over(out);
+    }
+
+    out->buffer[out->used++] = character;
+    out->total++;
+}
+
+static void put_repeated(FormatOutput* const out, const char character, size_t count)
+{
+    while (count-- > 0) {
+        put(out, character);
+    }
+}
+
+static void put_number(FormatOutput* const out, const FormatSpec* const spec, uint64_t value, const bool negative,
+                       const uint8_t base, const char* const digits)
+{
+    char reversed[FORMAT_DIGITS_SIZE];
+    size_t count = 0;
+    const bool IS_ZERO = (value == 0);
+
+    // Zero with a zero precision prints no digit at all. Values that fit in 32 bits skip the 64-bit division helper.
+    if (!(IS_ZERO && spec->has_precision && spec->precision == 0)) {
+        uint32_t small = (uint32_t) value;
+        while (value > UINT32_MAX) {
+            reversed[count++] = digits[value % base];
+            value /= base;
+            small = (uint32_t) value;
+        }
+        do {
+            reversed[count++] = digits[small % base];
+            small /= base;
+        } while (small > 0);
+    }
+
+    size_t zeros = (spec->has_precision && spec->precision > count) ? spec->precision - count : 0;
+    if (spec->alternate && base == 8 && zeros == 0 && (count == 0 || reversed[count - 1] != '0')) {
+        zeros = 1;
+    }
+
+    char prefix[2];
+    size_t prefix_length = 0;
+    if (negative) {
+        prefix[prefix_length++] = '-';
+    } else if (spec->sign) {
+        prefix[prefix_length++] = spec->sign;
+    } else if (spec->alternate && base == 16 && !IS_ZERO) {
+        prefix[prefix_length++] = '0';
+        prefix[prefix_length++] = (digits == UPPER_DIGITS) ? 'X' : 'x';
+    }
+
+    const size_t LENGTH = prefix_length + zeros + count;
+    size_t padding = (spec->width > LENGTH) ? spec->width - LENGTH : 0;
+    if (spec->zero && !spec->left && !spec->has_precision) {
+        zeros += padding;
+        padding = 0;
+    }
+
+    if (!spec->left) {
+        put_repeated(out, ' ', padding);
+    }
+    for (size_t i = 0; i < prefix_length; i++) {
+        put(out, prefix[i]);
+    }
+    put_repeated(out, '0', zeros);
+    while (count > 0) {
+        put(out, reversed[--count]);
+    }
+    if (spec->left) {
+        put_repeated(out, ' ', padding);
+    }
+}
+
+static void put_string(FormatOutput* const out, const FormatSpec* const spec, const char* string)
+{
+    if (string == NULL) {
+        string = "(null)";
+    }
+
+    size_t length = 0;
+    while (string[length] != '\0' && (!spec->has_precision || length < spec->precision)) {
+        length++;
+    }
+
+    const size_t PADDING = (spec->width > length) ? spec->width - length : 0;
+    if (!spec->left) {
+        put_repeated(out, ' ', PADDING);
+    }
+    for (size_t i = 0; i < length; i++) {
+        put(out, string[i]);
+    }
+    if (spec->left) {
+        put_repeated(out, ' ', PADDING);
+    }
+}
+
+static void render(FormatOutput* const out, const char* format, va_list arguments)
+{
+    while (*format != '\0') {
+        if (*format != '%') {
+            put(out, *format++);
+            continue;
+        }
+
+        const char* const START = format++;
+        FormatSpec spec = {0};
+
+        for (;; format++) {
+            if (*format == '-') {
+                spec.left = true;
+            } else if (*format == '0') {
+                spec.zero = true;
+            } else if (*format == '#') {
+                spec.alternate = true;
+            } else if (*format == '+') {
+                spec.sign = '+';
+            } else if (*format == ' ') {
+                spec.sign = (spec.sign == '+') ? '+' : ' ';
+            } else {
+                break;
+            }
+        }
+
+        if (*format == '*') {
+            const int WIDTH = va_arg(arguments, int);
+            spec.left |= (WIDTH < 0);
+            spec.width = (WIDTH < 0) ? (size_t)(-(long) WIDTH) : (size_t) WIDTH;
+            format++;
+        } else {
+            while (*format >= '0' && *format <= '9') {
+                spec.width = 10 * spec.width + (size_t)(*format++ - '0');
+            }
+        }
+
+        if (*format == '.') {
+            format++;
+            spec.has_precision = true;
+            if (*format == '*') {
+                const int PRECISION = va_arg(arguments, int);
+                // A negative precision counts as none
+                spec.has_precision = (PRECISION >= 0);
+                spec.precision = (PRECISION >= 0) ? (size_t) PRECISION : 0;
+                format++;
+            } else {
+                while (*format >= '0' && *format <= '9') {
+                    spec.precision = 10 * spec.precision + (size_t)(*format++ - '0');
+                }
+            }
+        }
+
+        switch (*format) {
+        case 'h':
+            format++;
+            spec.length = (*format == 'h') ? (format++, FORMAT_LENGTH_CHAR) : FORMAT_LENGTH_SHORT;
+            break;
+        case 'l':
+            format++;
+            spec.length = (*format == 'l') ? (format++, FORMAT_LENGTH_LONG_LONG) : FORMAT_LENGTH_LONG;
+            break;
+        case 'z':
+            format++;
+            spec.length = FORMAT_LENGTH_SIZE;
+            break;
+        case 'j':
+            format++;
+            spec.length = FORMAT_LENGTH_MAX;
+            break;
+        case 't':
+            format++;
+            spec.length = FORMAT_LENGTH_PTRDIFF;
+            break;
+        default:
+            break;
+        }
+
+        const char CONVERSION = *format;
+        if (CONVERSION != '\0') {
+            format++;
+        }
+
+        switch (CONVERSION) {
+        case 'd':
+        case 'i': {
+            int64_t value;
+            switch (spec.length) {
+            case FORMAT_LENGTH_CHAR: value = (signed char) va_arg(arguments, int); break;
+            case FORMAT_LENGTH_SHORT: value = (short) va_arg(arguments, int); break;
+            case FORMAT_LENGTH_LONG: value = va_arg(arguments, long); break;
+            case FORMAT_LENGTH_LONG_LONG: value = va_arg(arguments, long long); break;
+            case FORMAT_LENGTH_SIZE: value = va_arg(arguments, ptrdiff_t); break;
+            case FORMAT_LENGTH_MAX: value = va_arg(arguments, intmax_t); break;
+            case FORMAT_LENGTH_PTRDIFF: value = va_arg(arguments, ptrdiff_t); break;
+            default: value = va_arg(arguments, int); break;
+            }
+            // Negated as unsigned, so INT64_MIN survives
+            const uint64_t MAGNITUDE = (value < 0) ? (0U - (uint64_t) value) : (uint64_t) value;
+            put_number(out, &spec, MAGNITUDE, value < 0, 10, LOWER_DIGITS);
+            break;
+        }
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o': {
+            uint64_t value;
+            switch (spec.length) {
+            case FORMAT_LENGTH_CHAR: value = (unsigned char) va_arg(arguments, unsigned int); break;
+            case FORMAT_LENGTH_SHORT: value = (unsigned short) va_arg(arguments, unsigned int); break;
+            case FORMAT_LENGTH_LONG: value = va_arg(arguments, unsigned long); break;
+            case FORMAT_LENGTH_LONG_LONG: value = va_arg(arguments, unsigned long long); break;
+            case FORMAT_LENGTH_SIZE: value = va_arg(arguments, size_t); break;
+            case FORMAT_LENGTH_MAX: value = va_arg(arguments, uintmax_t); break;
+            case FORMAT_LENGTH_PTRDIFF: value = (uint64_t) va_arg(arguments, ptrdiff_t); break;
+            default: value = va_arg(arguments, unsigned int); break;
+            }
+            spec.sign = 0;
+            const uint8_t BASE = (CONVERSION == 'u') ? 10 : (CONVERSION == 'o') ? 8 : 16;
+            put_number(out, &spec, value, false, BASE, (CONVERSION == 'X') ? UPPER_DIGITS : LOWER_DIGITS);
+            break;
+        }
+        case 'p': {
+            // Always with the 0x prefix, null pointers too (as newlib does)
+            const uintptr_t POINTER = (uintptr_t) va_arg(arguments, void*);
+            spec.alternate = true;
+            spec.sign = 0;
+            if (POINTER == 0) {
+                spec.has_precision = false;
+                put_string(out, &spec, "0x0");
+            } else {
+                put_number(out, &spec, POINTER, false, 16, LOWER_DIGITS);
+            }
+            break;
+        }
+        case 'c': {
+            // Not through put_string(), as the character may be a '\0'
+            const char CHARACTER = (char) va_arg(arguments, int);
+            const size_t PADDING = (spec.width > 1) ? spec.width - 1 : 0;
+            if (!spec.left) {
+                put_repeated(out, ' ', PADDING);
+            }
+            put(out, CHARACTER);
+            if (spec.left) {
+                put_repeated(out, ' ', PADDING);
+            }
+            break;
+        }
+        case 's':
+            put_string(out, &spec, va_arg(arguments, const char*));
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            (void) va_arg(arguments, double);
+            put(out, '?');
+            break;
+        case '%':
+            put(out, '%');
+            break;
+        default:
+            // Unknown conversion: printed as is, so the mistake shows
+            for (const char* character = START; character < format; character++) {
+                put(out, *character);
+            }
+            break;
+        }
+    }
+}
+
+size_t format_vwrite(format_write_t write, void* context, const char* format, va_list arguments)
+{
+    char chunk[FORMAT_CHUNK_SIZE];
+    FormatOutput out =
+    {
+        .write = write,
+        .context = context,
+        .buffer = chunk,
+        .size = sizeof(chunk),
+    };
+
+    render(&out, format, arguments);
+    hand_over(&out);
+    return out.total;
+}
+
+int format_vsnprintf(char* buffer, const size_t size, const char* format, va_list arguments)
+{
+    FormatOutput out =
+    {
+        .buffer = buffer,
+        .size = (size > 0) ? size - 1 : 0,
+    };
+
+    render(&out, format, arguments);
+    if (size > 0) {
+        buffer[out.used] = '\0';
+    }
+    return (int) out.total;
+}
+
+int format_snprintf(char* buffer, const size_t size, const char* format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    const int LENGTH = format_vsnprintf(buffer, size, format, arguments);
+    va_end(arguments);
+    return LENGTH;
+}
+
+static void write_console(const char* data, const size_t length, void* context)
+{
+    (void) context;
+    FORMAT_CONSOLE_WRITE(data, length);
+}
+
+int format_printf(const char* format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    const size_t LENGTH = format_vwrite(write_console, NULL, format, arguments);
+    va_end(arguments);
+    return (int) LENGTH;
+}
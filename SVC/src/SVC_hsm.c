@@ -0,0 +1,196 @@
+// ------ inclusions ---------------------------------------------------
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "HAL_cycles.h"
+#include "SVC_hsm.h"
+
+/// | Private typedef -----------------------------------------------------------
+/// | Private define ------------------------------------------------------------
+/// | Private macro -------------------------------------------------------------
+/// | Private variables ---------------------------------------------------------
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Depth of a state inside its tree. The top state has depth 1, and NULL has depth 0.
+static uint8_t state_depth(const HSMState* state);
+
+/// @brief Fill the entry path of a transition: every state below `path->ancestor` down to `path->target`, followed by
+///        the chain of initial children of the target.
+/// @param path Path whose `entry_path`, `entry_count` and `initial_index` will be filled.
+static void compute_entry_path(HSMPath* path);
+
+/// @brief Compute the path of a transition. This is the only place where the state tree is searched.
+/// @param path Where the path will be stored.
+/// @param source State whose handler requested the transition.
+/// @param target Target state.
+static void compute_path(HSMPath* path, const HSMState* source, const HSMState* target);
+
+/// @brief Path of a transition, from the cache of the state machine, computing it on a miss.
+/// @param source State whose handler requested the transition.
+/// @param target Target state.
+static const HSMPath* find_path(HSM* hsm, const HSMState* source, const HSMState* target);
+
+/// @brief Execute a transition, from the current leaf state.
+static void execute_transition(HSM* hsm, const HSMPath* path);
+
+/// | Private functions ---------------------------------------------------------
+
+static uint8_t state_depth(const HSMState* state)
+{
+    uint8_t depth = 0;
+
+    for (; state; state = state->parent) {
+        depth++;
+    }
+
+    configASSERT(depth <= HSM_MAX_DEPTH);
+    return depth;
+}
+
+static void compute_entry_path(HSMPath* path)
+{
+    const uint8_t COUNT = state_depth(path->target) - state_depth(path->ancestor);
+    const HSMState* state = path->target;
+
+    // Ancestors of the target, stored outermost first
+    for (uint8_t i = COUNT; i > 0; i--) {
+        path->entry_path[i - 1] = state;
+        state = state->parent;
+    }
+
+    path->entry_count = COUNT;
+    path->initial_index = COUNT;
+
+    // Initial children chain
+    for (state = path->target->initial; state; state = state->initial) {
+        configASSERT(path->entry_count < HSM_MAX_DEPTH);
+        path->entry_path[path->entry_count++] = state;
+    }
+}
+
+static void compute_path(HSMPath* path, const HSMState* source, const HSMState* target)
+{
+    const HSMState* a = source;
+    const HSMState* b = target;
+    uint8_t depth_a = state_depth(a);
+    uint8_t depth_b = state_depth(b);
+
+    // Least common ancestor of the source and the target
+    for (; depth_a > depth_b; depth_a--) {
+        a = a->parent;
+    }
+    for (; depth_b > depth_a; depth_b--) {
+        b = b->parent;
+    }
+    while (a != b) {
+        a = a->parent;
+        b = b->parent;
+    }
+
+    // Transitions are external: if the source contains the target (or the other way around) it is exited too
+    path->source = source;
+    path->target = target;
+    path->ancestor = (a == source || a == target) ? a->parent : a;
+    compute_entry_path(path);
+}
+
+static const HSMPath* find_path(HSM* hsm, const HSMState* source, const HSMState* target)
+{
+    for (uint8_t i = 0; i < HSM_PATH_CACHE_SIZE; i++) {
+        const HSMPath* const PATH = &hsm->paths[i];
+        if (PATH->source == source && PATH->target == target) {
+            return PATH;
+        }
+    }
+
+    // Free slots are taken in order, so the oldest path is the next one to go
+    HSMPath* const PATH = &hsm->paths[hsm->paths_next];
+    hsm->paths_next = (hsm->paths_next + 1) % HSM_PATH_CACHE_SIZE;
+    compute_path(PATH, source, target);
+    hsm->stats.cache_misses++;
+    return PATH;
+}
+
+static void execute_transition(HSM* hsm, const HSMPath* path)
+{
+    // The source state is the leaf state or one of its ancestors, so the ancestor is always reached
+    for (const HSMState* state = hsm->state; state != path->ancestor; state = state->parent) {
+        state->handler(hsm, HSM_SIGNAL_EXIT, NULL);
+    }
+
+    for (uint8_t i = 0; i < path->entry_count; i++) {
+        if (i >= path->initial_index) {
+            path->entry_path[i - 1]->handler(hsm, HSM_SIGNAL_INIT, NULL);
+        }
+        path->entry_path[i]->handler(hsm, HSM_SIGNAL_ENTRY, NULL);
+    }
+
+    hsm->state = path->entry_path[path->entry_count - 1];
+}
+
+void hsm_initialize(HSM* hsm, const HSMState* initial, void* context)
+{
+    // Entered from outside the tree: nothing to exit, every state down to `initial` to enter
+    HSMPath initial_path = {.source = NULL, .target = initial, .ancestor = NULL};
+
+    hsm->state = NULL;
+    hsm->pending = NULL;
+    hsm->context = context;
+    hsm->stats = (HSMStats){0};
+    for (uint8_t i = 0; i < HSM_PATH_CACHE_SIZE; i++) {
+        hsm->paths[i] = (HSMPath){0};
+    }
+    hsm->paths_next = 0;
+
+    compute_entry_path(&initial_path);
+    execute_transition(hsm, &initial_path);
+}
+
+void hsm_dispatch(HSM* hsm, const HSMSignal signal, const void* event)
+{
+    configASSERT(signal >= HSM_SIGNAL_USER);
+    const uint32_t START = cycles_now();
+
+    // Bubble the signal up, starting at the leaf state. The tree depth bounds the amount of handlers invoked.
+    for (const HSMState* state = hsm->state; state; state = state->parent) {
+        const HSMStatus STATUS = state->handler(hsm, signal, event);
+
+        if (STATUS == HSM_HANDLED) {
+            break;
+        }
+
+        if (STATUS == HSM_TRANSITION) {
+            const HSMTransition* const TRANSITION = hsm->pending;
+            hsm->pending = NULL;
+            configASSERT(TRANSITION);
+
+            execute_transition(hsm, find_path(hsm, state, TRANSITION->target));
+            break;
+        }
+    }
+
+    hsm->stats.dispatches++;
+    hsm->stats.cycles_last = cycles_now() - START;
+    if (hsm->stats.cycles_last > hsm->stats.cycles_max) {
+        hsm->stats.cycles_max = hsm->stats.cycles_last;
+    }
+}
+
+HSMStatus hsm_transition(HSM* hsm, const HSMTransition* transition)
+{
+    hsm->pending = transition;
+    return HSM_TRANSITION;
+}
+
+bool hsm_is_in(const HSM* hsm, const HSMState* state)
+{
+    for (const HSMState* current = hsm->state; current; current = current->parent) {
+        if (current == state) {
+            return true;
+        }
+    }
+
+    return false;
+}
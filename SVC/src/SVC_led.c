@@ -1,88 +1,105 @@
 // ------ inclusions ---------------------------------------------------
-#include <stdio.h>
-
-#include "app_resources.h"
-
+// Batching of the LED AO (SVC_led_ao.cpp). Kept in C, next to the HAL it drives.
 #include "HAL_led.h"
 #include "SVC_led.h"
 
 /// | Private typedef -----------------------------------------------------------
 /// | Private define ------------------------------------------------------------
 
-#define LED_AO_QUEUE_LENGTH 16
+#if TRACE_ENABLED
+// Both lanes can be full while a batch is pending: every one of those events needs its own trace record
+_Static_assert(TRACE_RECORDS >= LED_AO_QUEUE_LENGTH + LED_AO_URGENT_QUEUE_LENGTH + LED_BATCH_MAX_EVENTS,
+               "TRACE_RECORDS can not hold every LED event in flight");
+#endif
 
 /// | Private macro -------------------------------------------------------------
-/// | Private variables ---------------------------------------------------------
 /// | Private function prototypes -----------------------------------------------
+/// | Private variables ---------------------------------------------------------
+/// | Private functions ---------------------------------------------------------
 
-/// @brief Process events received on the AO queue
-/// @param event
-static void execute_event(const LEDEvent* const event);
+bool led_batch_add(LEDBatch* batch, const LEDEvent* const event)
+{
+    const bool COALESCED = (batch->events > 0);
+    batch->events++;
 
-/// @brief LED Active object task.
-/// @param parameters should be a reference to the AO.
-static void ao_led_task(void* parameters);
+    if (event->deadline != AO_DEADLINE_NONE && batch->deadlined < LED_BATCH_MAX_EVENTS) {
+        batch->deadlines[batch->deadlined++] = event->deadline;
+    }
 
-/// | Private functions ---------------------------------------------------------
-static void ao_led_task(void* parameters)
+#if TRACE_ENABLED
+    TRACE_STAMP(event->trace_id, TRACE_STAGE_DISPATCHED);
+    if (event->trace_id != TRACE_ID_NONE && batch->traced < LED_BATCH_MAX_EVENTS) {
+        batch->trace_ids[batch->traced++] = event->trace_id;
+    }
+#endif
+
+    return COALESCED;
+}
+
+uint8_t led_batch_fold(LEDBatch* batch, const uint8_t leds, const LEDEventType type)
 {
-    LEDActiveObject* const AO = (LEDActiveObject*) (parameters);
+    uint8_t folded = 0;
 
-    LEDEvent* event = NULL;
-    printf("[%s] Task Created\n", pcTaskGetName(NULL));
+    for (BoardLEDs led = LED1; led < LEDS_TOTAL; led++) {
+        const uint8_t BIT = LED_MASK(led);
+        if (!(leds & BIT)) {
+            continue;
+        }
 
-    while (1) {
-        if (xQueueReceive(AO->queue, &event, portMAX_DELAY) == pdPASS && event) {
-            execute_event(event);
-        	vPortFree(event);
+        switch (type) {
+        case LED_EVENT_ON:
+            batch->on |= BIT;
+            batch->off &= ~BIT;
+            batch->toggle &= ~BIT;
+            break;
+        case LED_EVENT_OFF:
+            batch->off |= BIT;
+            batch->on &= ~BIT;
+            batch->toggle &= ~BIT;
+            break;
+        case LED_EVENT_TOGGLE:
+            if (batch->on & BIT) {
+                batch->on &= ~BIT;
+                batch->off |= BIT;
+            } else if (batch->off & BIT) {
+                batch->off &= ~BIT;
+                batch->on |= BIT;
+            } else {
+                batch->toggle ^= BIT;
+            }
+            break;
+        default:
+            continue;
         }
+        folded++;
     }
-}
 
-void led_initialize_ao(LEDActiveObject* ao, const char* ao_task_name)
-{
-    BaseType_t ret;
-
-    ret = xTaskCreate(
-            ao_led_task,
-            ao_task_name,
-            (2 * configMINIMAL_STACK_SIZE),
-            (void*) ao,
-            (tskIDLE_PRIORITY + 1UL),
-            ao->task);
-    configASSERT(ret == pdPASS);
-
-    ao->queue = xQueueCreate(LED_AO_QUEUE_LENGTH, sizeof(LEDEvent*));
-    configASSERT(ao->queue);
+    return folded;
 }
 
-static void execute_event(const LEDEvent* const event)
+uint8_t led_batch_write(LEDBatch* batch, ActiveObject* ao)
 {
-    printf("[%s] Event Received: ", pcTaskGetName(NULL));
-    const BoardLEDs LED = event->led;
-
-    switch (event->type) {
-    case LED_EVENT_ON:
-        printf("LED_EVENT_ON\n");
-        led_set(LED);
-        break;
-    case LED_EVENT_OFF:
-        printf("LED_EVENT_OFF\n");
-        led_clear(LED);
-        break;
-    case LED_EVENT_TOGGLE:
-        printf("LED_EVENT_TOGGLE\n");
-        led_toggle(LED);
-        break;
-    default:
-        configASSERT(pdFAIL && "Invalid LED event");
-        break;
+    uint8_t writes = 0;
+
+    // Toggles are resolved against the current status, so the write itself needs no read-modify-write
+    const uint8_t CURRENT = batch->toggle ? led_read_mask() : 0;
+    const uint8_t ON = batch->on | (batch->toggle & ~CURRENT);
+    const uint8_t OFF = batch->off | (batch->toggle & CURRENT);
+
+    if (ON | OFF) {
+        writes = led_write_mask(ON, OFF);
     }
-}
 
-void led_ao_send_event(LEDActiveObject* ao, LEDEvent* const event)
-{
-    if (xQueueSend(ao->queue, (void*)(&event), portMAX_DELAY) != pdPASS) {
-        printf("Error sending LED event\n");
+    for (uint8_t i = 0; i < batch->deadlined; i++) {
+        ao_deadline_done(ao, batch->deadlines[i]);
     }
+
+#if TRACE_ENABLED
+    for (uint8_t i = 0; i < batch->traced; i++) {
+        TRACE_STAMP(batch->trace_ids[i], TRACE_STAGE_APPLIED);
+    }
+#endif
+
+    *batch = (LEDBatch){0};
+    return writes;
 }
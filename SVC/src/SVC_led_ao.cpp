@@ -0,0 +1,172 @@
+// ------ inclusions ---------------------------------------------------
+#define LOG_MODULE_LEVEL LOG_LEVEL_LED
+
+#include "SVC_ao.hpp"
+
+extern "C" {
+#include "SVC_led.h"
+#include "SVC_log.h"
+}
+
+/// | Private typedef -----------------------------------------------------------
+
+namespace
+{
+
+/// @brief Printable names of every LEDEventType. Used for debugging purposes.
+constexpr const char* LED_EVENT_NAMES[] = {
+    "LED_EVENT_ON",
+    "LED_EVENT_OFF",
+    "LED_EVENT_TOGGLE",
+    "LED_EVENT_BLOCK",
+    "LED_EVENT_UNBLOCK",
+};
+
+/// @brief Stack of the LED AO, in words. Hosted AOs run on the stack of their host.
+constexpr std::size_t STACK_WORDS = LED_AO_QUEUE_SET_HOSTED ? 0 : LED_AO_STACK_DEPTH;
+
+/// @brief LED Active Object, on top of the C++ layer: ON/OFF/TOGGLE are folded into a batch (SVC_led.c) written once
+///        the queues are empty (or once it is full), and BLOCK holds its LEDs on until UNBLOCK. Blocked mode only has
+///        two states, so a flag does the job of a state machine.
+class LEDs : public svc::ActiveObject<LEDs, LEDEvent, LED_AO_QUEUE_LENGTH, STACK_WORDS, LED_AO_PRIORITY,
+                                      LED_AO_URGENT_QUEUE_LENGTH>
+{
+public:
+    /// @brief Event handler.
+    void on(const LEDEvent& event)
+    {
+        if (event.type > LED_EVENT_UNBLOCK) {
+            configASSERT(pdFAIL && "Invalid LED event");
+            return;
+        }
+
+        LOG_DEBUG("Event Received: %s", LED_EVENT_NAMES[event.type]);
+
+        if (led_batch_add(&batch_, &event)) {
+            stats_.events_coalesced++;
+        }
+
+        switch (event.type) {
+        case LED_EVENT_BLOCK:
+            if (!blocked_) {
+                blocked_ = true;
+                blocked_leds_ = event.leds;
+                fold(blocked_leds_, LED_EVENT_ON);
+            }
+            break;
+        case LED_EVENT_UNBLOCK:
+            if (blocked_) {
+                fold(blocked_leds_, LED_EVENT_OFF);
+                blocked_ = false;
+                blocked_leds_ = 0;
+            }
+            break;
+        default:
+            // Blocked LEDs stay on, even for commands queued before LED_EVENT_BLOCK overtook them in the urgent lane
+            fold(event.leds & ~blocked_leds_, static_cast<LEDEventType>(event.type));
+            break;
+        }
+
+        // The AO only flushes once its queues are empty, which sustained traffic may never allow
+        if (batch_.events >= LED_BATCH_MAX_EVENTS) {
+            taskENTER_CRITICAL();
+            stats_.flushes_capped++;
+            taskEXIT_CRITICAL();
+            flush();
+        }
+    }
+
+    /// @brief Batch handler: write the pending batch with a single write per GPIO port.
+    void flush()
+    {
+        if (batch_.events == 0) {
+            return;
+        }
+
+        const std::uint8_t WRITES = led_batch_write(&batch_, core());
+
+        taskENTER_CRITICAL();
+        stats_.gpio_writes += WRITES;
+        stats_.gpio_writes_avoided -= WRITES;
+        taskEXIT_CRITICAL();
+    }
+
+    /// @brief The LEDs only change when the batch is written, so that is when the deadlines are met or missed.
+    static constexpr bool COMPLETES_DEADLINES = true;
+
+    /// @brief Event type handler, for introspection.
+    static std::uint8_t event_type(const LEDEvent& event)
+    {
+        return event.type;
+    }
+
+    /// @brief Deadline handler.
+    static AODeadline deadline(const LEDEvent& event)
+    {
+        return event.deadline;
+    }
+
+    /// @brief Snapshot of the batching statistics.
+    LEDBatchStats stats()
+    {
+        taskENTER_CRITICAL();
+        const LEDBatchStats SNAPSHOT = stats_;
+        taskEXIT_CRITICAL();
+        return SNAPSHOT;
+    }
+
+private:
+    void fold(const std::uint8_t leds, const LEDEventType type)
+    {
+        const std::uint8_t WRITES = led_batch_fold(&batch_, leds, type);
+
+        // Each of these used to be a GPIO write of its own. `flush()` takes back the port writes it actually performs.
+        taskENTER_CRITICAL();
+        stats_.gpio_writes_avoided += WRITES;
+        taskEXIT_CRITICAL();
+    }
+
+    bool blocked_;              ///< true while in blocked mode
+    std::uint8_t blocked_leds_; ///< LEDs held on while in blocked mode
+    LEDBatch batch_;            ///< LED actions pending to be written
+    LEDBatchStats stats_;       ///< Batching statistics
+};
+
+} // namespace
+
+/// | Private variables ---------------------------------------------------------
+
+/// @brief Zero initialized like any other static object: its constructor does nothing, so it needs no startup code.
+static LEDs leds;
+
+/// | Exported functions --------------------------------------------------------
+
+void led_initialize_ao(const char* ao_task_name, AOQueueSet* host)
+{
+    configASSERT((host != NULL) == (LED_AO_QUEUE_SET_HOSTED != 0));
+
+    // LED commands are user feedback: the latest ones matter, and the button loop must never wait for them
+    leds.start(ao_task_name, AO_OVERFLOW_DROP_OLDEST, host);
+}
+
+ActiveObject* led_ao()
+{
+    return leds.core();
+}
+
+void led_ao_get_batch_stats(LEDBatchStats* const stats)
+{
+    *stats = leds.stats();
+}
+
+void led_ao_send_event(const LEDEvent* const event)
+{
+    if (!leds.post(*event, 0)) {
+        LOG_WARNING("Error sending LED event");
+    }
+}
+
+bool led_ao_send_event_from_isr(const LEDEvent* const event, BaseType_t* const woken)
+{
+    return leds.post_from_isr(*event, woken);
+}
@@ -0,0 +1,569 @@
+// ------ inclusions ---------------------------------------------------
+#define LOG_MODULE_LEVEL LOG_LEVEL_LOG
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "HAL_cycles.h"
+#include "HAL_irq.h"
+#include "SVC_log.h"
+
+#if LOG_ENABLED
+
+/// | Private typedef -----------------------------------------------------------
+
+/// @brief Single-producer, single-consumer record ring. Only its writer moves `head`, and only the drain task moves
+///        `tail`, so neither side needs a lock: each publishes its index after touching the words it covers.
+typedef struct
+{
+    uint32_t* words;    ///< Storage. Its length is a power of two.
+    uint32_t mask;      ///< Length of `words` minus one.
+    uint32_t head;      ///< Next word to write. Free running, masked on every access.
+    uint32_t tail;      ///< Next word to drain. Free running, masked on every access.
+    uint16_t sequence;  ///< Sequence number of the next record. Lost records show up as gaps.
+    uint32_t written;   ///< Records stored. Only updated by the writer.
+    uint32_t dropped;   ///< Records lost because the ring was full. Only updated by the writer.
+    size_t used_max;    ///< High-water mark, in words. Only updated by the writer.
+    TaskHandle_t owner; ///< Writing task. NULL for "boot" and for interrupt levels.
+    bool retired;       ///< Set when the owner is deleted. Cleared by the task taking the ring over.
+    bool renamed;       ///< Set when a task ring opens or changes owner, until the drain task has announced its name.
+    uint8_t source;     ///< Record source.
+    bool ready;         ///< Set, last, once the ring is initialized.
+    /// @brief Copied, so it outlives a deleted task. Whole words, so it can be shipped as record arguments.
+    char name[4 * ((configMAX_TASK_NAME_LEN + 3) / 4)];
+} LogRing;
+
+/// | Private define ------------------------------------------------------------
+
+/// @brief Words of a record before its arguments: header, format address and timestamp.
+#define LOG_RECORD_HEADER_WORDS 3
+
+/// @brief Position of the timestamp in a record.
+#define LOG_RECORD_TIMESTAMP 2
+
+/// @brief Words of the longest record. Source names take as many words as the longest task name.
+#define LOG_RECORD_MAX_WORDS (LOG_RECORD_HEADER_WORDS + LOG_MAX_ARGS)
+#define LOG_NAME_WORDS ((configMAX_TASK_NAME_LEN + 3) / 4)
+
+/// @brief COBS adds one byte every 254, plus the leading code byte and the delimiter.
+#define LOG_FRAME_SIZE (4 * LOG_RECORD_MAX_WORDS + 2 + 1)
+
+/// @brief Source names and the clock are shipped again this often, so a decoder attached late learns them too.
+#define LOG_ANNOUNCE_PERIOD_MS 10000
+
+/// @brief Ring slot of an interrupt level that has none yet.
+#define LOG_NO_RING UINT8_MAX
+
+/// | Private macro -------------------------------------------------------------
+
+/// @brief Record header: argument count, kind, level, source and sequence number (lost records show up as gaps).
+#define LOG_HEADER(count, kind, level, source) \
+    ((uint32_t)(count) | ((uint32_t)(kind) << 4) | ((uint32_t)(level) << 6) | ((uint32_t)(source) << 8))
+#define LOG_HEADER_COUNT(header) ((header) & 0x0FU)
+
+/// @brief Index shared between a ring writer and the drain task. Stores are ordered after the words they publish, and
+///        loads before the words they guard.
+#define LOG_PUBLISH(index, value) __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+#define LOG_OBSERVE(index) __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+
+/// | Private variables ---------------------------------------------------------
+
+_Static_assert((LOG_TASK_RING_WORDS & (LOG_TASK_RING_WORDS - 1)) == 0, "LOG_TASK_RING_WORDS must be a power of two");
+_Static_assert((LOG_ISR_RING_WORDS & (LOG_ISR_RING_WORDS - 1)) == 0, "LOG_ISR_RING_WORDS must be a power of two");
+_Static_assert(LOG_ISR_RING_WORDS >= LOG_RECORD_MAX_WORDS, "Rings must fit the longest record");
+_Static_assert(LOG_NAME_WORDS <= LOG_MAX_ARGS, "Task names must fit in a record");
+_Static_assert(LOG_MAX_TASKS <= LOG_SOURCE_ISR_BASE && IRQ_LEVELS <= 0x10, "Sources must fit in 8 bits");
+
+static uint32_t task_words[LOG_MAX_TASKS][LOG_TASK_RING_WORDS];
+static uint32_t isr_words[LOG_MAX_ISR_LEVELS][LOG_ISR_RING_WORDS];
+
+/// @brief Rings are handed out on first use by an atomic increment of the count, so taking one needs no lock either.
+static LogRing task_rings[LOG_MAX_TASKS];
+static uint32_t task_rings_count = 0;
+static LogRing isr_rings[LOG_MAX_ISR_LEVELS];
+static uint32_t isr_rings_count = 0;
+
+/// @brief Ring slot of each interrupt level. Only written at that level, which cannot preempt itself.
+static uint8_t isr_ring_of_level[IRQ_LEVELS] = {[0 ... IRQ_LEVELS - 1] = LOG_NO_RING};
+
+static uint32_t unregistered = 0;
+static uint32_t drained = 0;
+
+volatile uint8_t log_threshold = LOG_THRESHOLD_DEFAULT;
+
+static log_sink_t sink = NULL;
+static log_flush_t flush = NULL;
+static TickType_t period = 0;
+static TaskHandle_t drain_task = NULL;
+
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Drain task: ship every stored record through the sink, oldest first, then sleep for a period.
+/// @param parameters Unused.
+static void log_drain_task(void* parameters);
+
+/// @brief Claim the next free slot of a ring table.
+/// @param count Amount of slots claimed so far.
+/// @param max Length of the table.
+/// @return Index of the claimed slot, or `max` if the table is full.
+static uint32_t claim(uint32_t* const count, const uint32_t max);
+
+/// @brief Initialize a claimed ring and make it visible to the drain task.
+static void open_ring(LogRing* const ring, uint32_t* const words, const size_t size, const uint8_t source,
+                      TaskHandle_t const owner, const char* const name);
+
+/// @brief Take over the ring of a deleted task, once the drain task has emptied it.
+/// @param task Calling task.
+/// @return The ring, or NULL if there is none.
+static LogRing* reuse_ring(TaskHandle_t const task);
+
+/// @brief Ring of the calling task, taking one on its first log.
+/// @return The ring, or NULL if every ring is taken.
+static LogRing* task_ring();
+
+/// @brief Ring of the running interrupt level, taking one on its first log.
+/// @return The ring, or NULL if every ring is taken or the level is not a configurable one.
+static LogRing* isr_ring();
+
+/// @brief Amount of rings of a table visible to the drain task.
+static uint32_t rings_in_use(uint32_t* const count, const uint32_t max);
+
+/// @brief Store a record in a ring, or count it as dropped. Only called by the writer of the ring.
+static void store(LogRing* const ring, const uint8_t level, const char* format, const uint32_t* args,
+                  const uint8_t count);
+
+/// @brief Ring holding the oldest record, by timestamp.
+/// @return The ring, or NULL if every ring is empty.
+static LogRing* oldest_ring();
+
+/// @brief Take the oldest record out of a ring that is not empty.
+/// @param record Where the record will be stored. At least LOG_RECORD_MAX_WORDS long.
+/// @return Length of the record, in words.
+static size_t take(LogRing* const ring, uint32_t* const record);
+
+/// @brief COBS encode a record and hand it to the sink.
+static void ship(const uint32_t* const record, const size_t words);
+
+/// @brief Ship the name of a task ring.
+/// @param record Scratch record. At least LOG_RECORD_MAX_WORDS long.
+static void announce_ring(const LogRing* const ring, uint32_t* const record);
+
+/// @brief Ship the timestamp frequency (when `first` is 0) and the name of every task ring from `first` on.
+/// @return Index of the first ring left unannounced, because it is still being opened or does not exist yet.
+static uint32_t announce(const uint32_t first);
+
+/// | Private functions ---------------------------------------------------------
+
+void log_initialize(const LogConfig* const config)
+{
+    configASSERT(config && config->sink && config->stack && config->task_buffer && config->period_ms > 0);
+
+    sink = config->sink;
+    flush = config->flush;
+    period = pdMS_TO_TICKS(config->period_ms);
+
+    drain_task = xTaskCreateStatic(
+            log_drain_task,
+            "Log Drain",
+            config->stack_depth,
+            NULL,
+            config->priority,
+            config->stack,
+            config->task_buffer);
+    configASSERT(drain_task);
+}
+
+static uint32_t claim(uint32_t* const count, const uint32_t max)
+{
+    // Checked first, so a full table does not keep counting up on every log
+    if (LOG_OBSERVE(*count) >= max) {
+        return max;
+    }
+
+    const uint32_t SLOT = __atomic_fetch_add(count, 1, __ATOMIC_RELAXED);
+    return (SLOT < max) ? SLOT : max;
+}
+
+static void open_ring(LogRing* const ring, uint32_t* const words, const size_t size, const uint8_t source,
+                      TaskHandle_t const owner, const char* const name)
+{
+    ring->words = words;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->sequence = 0;
+    ring->owner = owner;
+    ring->source = source;
+    strncpy(ring->name, name, sizeof(ring->name) - 1);
+    // A task ring opened in the middle of a drain round ships its name before its first record, like a renamed one
+    ring->renamed = (source < LOG_SOURCE_ISR_BASE);
+    LOG_PUBLISH(ring->ready, true);
+}
+
+static LogRing* reuse_ring(TaskHandle_t const task)
+{
+    const uint32_t COUNT = rings_in_use(&task_rings_count, LOG_MAX_TASKS);
+    for (uint32_t i = 0; i < COUNT; i++) {
+        LogRing* const RING = &task_rings[i];
+
+        // Records of the former owner must be shipped under its name. The head no longer moves: its writer is gone.
+        if (!LOG_OBSERVE(RING->ready) || !LOG_OBSERVE(RING->retired) || LOG_OBSERVE(RING->tail) != RING->head) {
+            continue;
+        }
+
+        // Several new tasks may race for the same ring: only one clears the flag
+        bool expected = true;
+        if (!__atomic_compare_exchange_n(&RING->retired, &expected, false, false, __ATOMIC_ACQ_REL,
+                                         __ATOMIC_RELAXED)) {
+            continue;
+        }
+
+        // The indexes keep running, so the drain task never sees them move backwards. The sequence number too: the
+        // decoder tells owners apart by the announcement in between.
+        memset(RING->name, 0, sizeof(RING->name));
+        strncpy(RING->name, pcTaskGetName(task), sizeof(RING->name) - 1);
+        RING->owner = task;
+        LOG_PUBLISH(RING->renamed, true);
+        return RING;
+    }
+
+    return NULL;
+}
+
+static LogRing* task_ring()
+{
+    TaskHandle_t const TASK = (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) ? NULL : xTaskGetCurrentTaskHandle();
+
+    // A task is the only one taking its own ring, so rings that are not ready yet belong to other tasks
+    const uint32_t COUNT = rings_in_use(&task_rings_count, LOG_MAX_TASKS);
+    for (uint32_t i = 0; i < COUNT; i++) {
+        if (LOG_OBSERVE(task_rings[i].ready) && !LOG_OBSERVE(task_rings[i].retired) && task_rings[i].owner == TASK) {
+            return &task_rings[i];
+        }
+    }
+
+    if (TASK) {
+        LogRing* const REUSED = reuse_ring(TASK);
+        if (REUSED) {
+            return REUSED;
+        }
+    }
+
+    const uint32_t SLOT = claim(&task_rings_count, LOG_MAX_TASKS);
+    if (SLOT == LOG_MAX_TASKS) {
+        return NULL;
+    }
+
+    open_ring(&task_rings[SLOT], task_words[SLOT], LOG_TASK_RING_WORDS, (uint8_t) SLOT, TASK,
+              TASK ? pcTaskGetName(TASK) : "boot");
+    return &task_rings[SLOT];
+}
+
+static LogRing* isr_ring()
+{
+    const uint8_t LEVEL = irq_active_level();
+    if (LEVEL == IRQ_LEVEL_NONE) {
+        return NULL;
+    }
+
+    if (isr_ring_of_level[LEVEL] != LOG_NO_RING) {
+        return &isr_rings[isr_ring_of_level[LEVEL]];
+    }
+
+    const uint32_t SLOT = claim(&isr_rings_count, LOG_MAX_ISR_LEVELS);
+    if (SLOT == LOG_MAX_ISR_LEVELS) {
+        return NULL;
+    }
+
+    char name[] = "ISR..";
+    name[3] = (char)('0' + ((LEVEL < 10) ? LEVEL : LEVEL / 10));
+    name[4] = (LEVEL < 10) ? '\0' : (char)('0' + LEVEL % 10);
+    open_ring(&isr_rings[SLOT], isr_words[SLOT], LOG_ISR_RING_WORDS, LOG_SOURCE_ISR(LEVEL), NULL, name);
+    isr_ring_of_level[LEVEL] = (uint8_t) SLOT;
+    return &isr_rings[SLOT];
+}
+
+static uint32_t rings_in_use(uint32_t* const count, const uint32_t max)
+{
+    const uint32_t COUNT = LOG_OBSERVE(*count);
+    return (COUNT < max) ? COUNT : max;
+}
+
+static void store(LogRing* const ring, const uint8_t level, const char* format, const uint32_t* args,
+                  const uint8_t count)
+{
+    const uint32_t TIMESTAMP = cycles_now();
+    const uint32_t WORDS = LOG_RECORD_HEADER_WORDS + count;
+    const uint32_t HEAD = ring->head;
+    const uint32_t USED = HEAD - LOG_OBSERVE(ring->tail);
+
+    if (USED + WORDS > ring->mask + 1) {
+        // The sequence number still moves on, so the decoder can tell where records are missing
+        ring->sequence++;
+        ring->dropped++;
+        return;
+    }
+
+    uint32_t* const STORAGE = ring->words;
+    const uint32_t MASK = ring->mask;
+    STORAGE[HEAD & MASK] = LOG_HEADER(count, LOG_RECORD_MESSAGE, level, ring->source) |
+                           ((uint32_t) ring->sequence++ << 16);
+    STORAGE[(HEAD + 1) & MASK] = (uint32_t)(uintptr_t) format;
+    STORAGE[(HEAD + LOG_RECORD_TIMESTAMP) & MASK] = TIMESTAMP;
+    for (uint8_t i = 0; i < count; i++) {
+        STORAGE[(HEAD + LOG_RECORD_HEADER_WORDS + i) & MASK] = args[i];
+    }
+    LOG_PUBLISH(ring->head, HEAD + WORDS);
+
+    ring->written++;
+    if (USED + WORDS > ring->used_max) {
+        ring->used_max = USED + WORDS;
+    }
+}
+
+void log_write(const uint8_t level, const char* format, const uint32_t* args, const uint8_t count)
+{
+    // A plain LOG_*() reached from a handler (e.g. a function shared with an ISR) would otherwise pick the ring of the
+    // preempted task, and race with its writer
+    if (irq_active()) {
+        log_write_from_isr(level, format, args, count);
+        return;
+    }
+
+    LogRing* const RING = task_ring();
+    if (RING == NULL) {
+        __atomic_fetch_add(&unregistered, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    store(RING, level, format, args, count);
+}
+
+void log_write_from_isr(const uint8_t level, const char* format, const uint32_t* args, const uint8_t count)
+{
+    LogRing* const RING = isr_ring();
+    if (RING == NULL) {
+        __atomic_fetch_add(&unregistered, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    store(RING, level, format, args, count);
+}
+
+void log_set_threshold(const uint8_t level)
+{
+    configASSERT(level <= LOG_LEVEL_OFF);
+    log_threshold = level;
+}
+
+static LogRing* oldest_ring()
+{
+    LogRing* const TABLES[] = {task_rings, isr_rings};
+    const uint32_t COUNTS[] =
+    {
+        rings_in_use(&task_rings_count, LOG_MAX_TASKS),
+        rings_in_use(&isr_rings_count, LOG_MAX_ISR_LEVELS),
+    };
+
+    LogRing* oldest = NULL;
+    uint32_t oldest_timestamp = 0;
+
+    for (size_t table = 0; table < 2; table++) {
+        for (uint32_t i = 0; i < COUNTS[table]; i++) {
+            LogRing* const RING = &TABLES[table][i];
+            if (!LOG_OBSERVE(RING->ready) || LOG_OBSERVE(RING->head) == RING->tail) {
+                continue;
+            }
+
+            // Timestamps wrap around, so they are compared by their difference
+            const uint32_t TIMESTAMP = RING->words[(RING->tail + LOG_RECORD_TIMESTAMP) & RING->mask];
+            if (oldest == NULL || (int32_t)(TIMESTAMP - oldest_timestamp) < 0) {
+                oldest = RING;
+                oldest_timestamp = TIMESTAMP;
+            }
+        }
+    }
+
+    return oldest;
+}
+
+static size_t take(LogRing* const ring, uint32_t* const record)
+{
+    const uint32_t TAIL = ring->tail;
+    const size_t WORDS = LOG_RECORD_HEADER_WORDS + LOG_HEADER_COUNT(ring->words[TAIL & ring->mask]);
+
+    for (size_t i = 0; i < WORDS; i++) {
+        record[i] = ring->words[(TAIL + i) & ring->mask];
+    }
+    LOG_PUBLISH(ring->tail, TAIL + WORDS);
+    drained++;
+
+    return WORDS;
+}
+
+static void ship(const uint32_t* const record, const size_t words)
+{
+    const uint8_t* const BYTES = (const uint8_t*) record;
+    const size_t SIZE = 4 * words;
+    uint8_t frame[LOG_FRAME_SIZE];
+    size_t code_index = 0;
+    size_t length = 1;
+    uint8_t code = 1;
+
+    // COBS: zeros are replaced by the distance to the next one, so 0x00 is left free as the frame delimiter
+    for (size_t i = 0; i < SIZE; i++) {
+        if (BYTES[i] == 0) {
+            frame[code_index] = code;
+            code_index = length++;
+            code = 1;
+        } else {
+            frame[length++] = BYTES[i];
+            code++;
+        }
+    }
+    frame[code_index] = code;
+    frame[length++] = 0;
+
+    sink(frame, length);
+}
+
+static void announce_ring(const LogRing* const ring, uint32_t* const record)
+{
+    record[0] = LOG_HEADER(LOG_NAME_WORDS, LOG_RECORD_SOURCE, 0, ring->source);
+    record[1] = 0;
+    record[2] = cycles_now();
+    memcpy(&record[LOG_RECORD_HEADER_WORDS], ring->name, LOG_NAME_WORDS * 4);
+    ship(record, LOG_RECORD_HEADER_WORDS + LOG_NAME_WORDS);
+}
+
+static uint32_t announce(const uint32_t first)
+{
+    uint32_t record[LOG_RECORD_MAX_WORDS];
+
+    if (first == 0) {
+        record[0] = LOG_HEADER(1, LOG_RECORD_CLOCK, 0, 0);
+        record[1] = 0;
+        record[2] = cycles_now();
+        record[3] = cycles_from_us(1000000U);
+        ship(record, LOG_RECORD_HEADER_WORDS + 1);
+    }
+
+    // Interrupt levels need no name: the decoder derives it from the source
+    const uint32_t COUNT = rings_in_use(&task_rings_count, LOG_MAX_TASKS);
+    uint32_t i = first;
+    for (; i < COUNT && LOG_OBSERVE(task_rings[i].ready); i++) {
+        // Announced now, so the drain loop need not do it again. Cleared first, as in `log_drain_task()`.
+        (void) __atomic_exchange_n(&task_rings[i].renamed, false, __ATOMIC_ACQ_REL);
+        announce_ring(&task_rings[i], record);
+    }
+
+    return i;
+}
+
+static void log_drain_task(void* parameters)
+{
+    (void) parameters;
+    uint32_t record[LOG_RECORD_MAX_WORDS];
+    uint32_t announced = 0;
+    TickType_t last_announce = xTaskGetTickCount();
+
+    LOG_INFO("Task Created");
+
+    while (1) {
+        if (xTaskGetTickCount() - last_announce >= pdMS_TO_TICKS(LOG_ANNOUNCE_PERIOD_MS)) {
+            last_announce = xTaskGetTickCount();
+            announced = 0;
+        }
+
+        // Names go out before the records that refer to them. A ring still being opened is announced next round.
+        const uint32_t DRAINED_BEFORE = drained;
+        bool announcing = false;
+        if (announced == 0 || announced < rings_in_use(&task_rings_count, LOG_MAX_TASKS)) {
+            announced = announce(announced);
+            announcing = true;
+        }
+
+        LogRing* ring;
+        while ((ring = oldest_ring()) != NULL) {
+            // A ring taken over announces its new owner before its first record. The flag is cleared before the name
+            // is read, so a name changing meanwhile is announced again.
+            if (__atomic_exchange_n(&ring->renamed, false, __ATOMIC_ACQ_REL)) {
+                announce_ring(ring, record);
+                announcing = true;
+            }
+            ship(record, take(ring, record));
+        }
+
+        if (flush && (announcing || drained != DRAINED_BEFORE)) {
+            flush();
+        }
+
+        vTaskDelay(period);
+    }
+}
+
+void log_get_stats(LogStats* const snapshot)
+{
+    LogRingStats rings[LOG_MAX_TASKS + LOG_MAX_ISR_LEVELS];
+    const size_t COUNT = log_get_ring_stats(rings, LOG_MAX_TASKS + LOG_MAX_ISR_LEVELS);
+
+    *snapshot = (LogStats){
+        .drained = drained,
+        .unregistered = LOG_OBSERVE(unregistered),
+    };
+    for (size_t i = 0; i < COUNT; i++) {
+        snapshot->written += rings[i].written;
+        snapshot->dropped += rings[i].dropped;
+    }
+}
+
+size_t log_get_ring_stats(LogRingStats* const stats, const size_t max)
+{
+    LogRing* const TABLES[] = {task_rings, isr_rings};
+    const uint32_t COUNTS[] =
+    {
+        rings_in_use(&task_rings_count, LOG_MAX_TASKS),
+        rings_in_use(&isr_rings_count, LOG_MAX_ISR_LEVELS),
+    };
+
+    // Counters are single words, each written by a single writer: reading them needs no lock
+    size_t count = 0;
+    for (size_t table = 0; table < 2; table++) {
+        for (uint32_t i = 0; i < COUNTS[table] && count < max; i++) {
+            const LogRing* const RING = &TABLES[table][i];
+            if (!LOG_OBSERVE(RING->ready)) {
+                continue;
+            }
+            stats[count++] = (LogRingStats){
+                .name = RING->name,
+                .source = RING->source,
+                .written = RING->written,
+                .dropped = RING->dropped,
+                .used_max = RING->used_max,
+                .size = RING->mask + 1,
+            };
+        }
+    }
+
+    return count;
+}
+
+void log_task_deleted(void* task)
+{
+    // Called by vTaskDelete(), inside a critical section: just flag the ring, the next new task takes it over
+    const uint32_t COUNT = rings_in_use(&task_rings_count, LOG_MAX_TASKS);
+    for (uint32_t i = 0; i < COUNT; i++) {
+        if (LOG_OBSERVE(task_rings[i].ready) && task_rings[i].owner == (TaskHandle_t) task) {
+            LOG_PUBLISH(task_rings[i].retired, true);
+        }
+    }
+}
+
+#else
+
+void log_task_deleted(void* task)
+{
+    (void) task;
+}
+
+#endif // LOG_ENABLED
@@ -0,0 +1,191 @@
+// ------ inclusions ---------------------------------------------------
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "HAL_cycles.h"
+#include "SVC_lz.h"
+
+/// | Private typedef -----------------------------------------------------------
+/// | Private define ------------------------------------------------------------
+
+/// @brief Farthest match. Distance 0 is kept for the flush marker.
+#define LZ_MAX_DISTANCE (LZ_WINDOW_SIZE - 1)
+
+/// | Private macro -------------------------------------------------------------
+/// | Private variables ---------------------------------------------------------
+
+_Static_assert(LZ_BUFFER_SIZE >= LZ_MAX_DISTANCE + LZ_MAX_MATCH, "The buffer must fit the window and a match");
+
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Append bits to the stream, handing whole output buffers over as they fill up.
+/// @param value Bits, right aligned.
+/// @param count Amount of bits. Up to 16.
+static void put_bits(LzEncoder* encoder, const uint32_t value, const uint8_t count);
+
+/// @brief Hand the compressed bytes gathered so far to the output.
+static void hand_over(LzEncoder* encoder);
+
+/// @brief Encode the input at `start` as a literal or as a copy from the history.
+/// @param available Bytes of input that may be part of the match.
+static void encode_next(LzEncoder* encoder, const size_t available);
+
+/// @brief Drop the oldest input, keeping a whole window of history, to make room at the end of the buffer.
+static void slide(LzEncoder* encoder);
+
+/// | Private functions ---------------------------------------------------------
+
+void lz_encoder_initialize(LzEncoder* encoder, lz_output_t output)
+{
+    configASSERT(encoder && output);
+
+    encoder->output = output;
+    encoder->start = 0;
+    encoder->end = 0;
+    encoder->bits = 0;
+    encoder->bit_count = 0;
+    encoder->pending_size = 0;
+    encoder->stats = (LzStats){0};
+}
+
+static void hand_over(LzEncoder* encoder)
+{
+    if (encoder->pending_size == 0) {
+        return;
+    }
+
+    // The output (e.g. a blocking UART) is not the encoder time
+    const uint32_t START = cycles_now();
+    encoder->output(encoder->pending, encoder->pending_size);
+    encoder->stats.cycles -= cycles_now() - START;
+
+    encoder->stats.bytes_out += encoder->pending_size;
+    encoder->pending_size = 0;
+}
+
+static void put_bits(LzEncoder* encoder, const uint32_t value, const uint8_t count)
+{
+    encoder->bits = (encoder->bits << count) | value;
+    encoder->bit_count += count;
+
+    while (encoder->bit_count >= 8) {
+        encoder->bit_count -= 8;
+        encoder->pending[encoder->pending_size++] = (uint8_t)(encoder->bits >> encoder->bit_count);
+        if (encoder->pending_size == LZ_OUTPUT_SIZE) {
+            hand_over(encoder);
+        }
+    }
+    encoder->bits &= (1U << encoder->bit_count) - 1;
+}
+
+static void encode_next(LzEncoder* encoder, const size_t available)
+{
+    const uint8_t* const BUFFER = encoder->buffer;
+    const size_t START = encoder->start;
+    const size_t LIMIT = (available < LZ_MAX_MATCH) ? available : LZ_MAX_MATCH;
+    const size_t FIRST = (START > LZ_MAX_DISTANCE) ? (START - LZ_MAX_DISTANCE) : 0;
+    size_t best_length = 0;
+    size_t best_distance = 0;
+
+    // Nearest candidates first, so ties keep the shortest distance. Matches may run into the input being encoded:
+    // the decoder copies byte by byte, so it rebuilds those too.
+    if (LIMIT >= LZ_MIN_MATCH) {
+        for (size_t candidate = START; candidate-- > FIRST;) {
+            if (BUFFER[candidate] != BUFFER[START] || BUFFER[candidate + 1] != BUFFER[START + 1]) {
+                continue;
+            }
+
+            size_t length = 2;
+            while (length < LIMIT && BUFFER[candidate + length] == BUFFER[START + length]) {
+                length++;
+            }
+
+            if (length > best_length) {
+                best_length = length;
+                best_distance = START - candidate;
+                if (length == LIMIT) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (best_length >= LZ_MIN_MATCH) {
+        put_bits(encoder, best_distance, 1 + LZ_WINDOW_BITS);
+        put_bits(encoder, best_length - LZ_MIN_MATCH, LZ_LENGTH_BITS);
+        encoder->start += best_length;
+    } else {
+        put_bits(encoder, 0x100U | BUFFER[START], 1 + 8);
+        encoder->start++;
+    }
+}
+
+static void slide(LzEncoder* encoder)
+{
+    if (encoder->start <= LZ_MAX_DISTANCE) {
+        return;
+    }
+
+    const size_t SHIFT = encoder->start - LZ_MAX_DISTANCE;
+    memmove(encoder->buffer, &encoder->buffer[SHIFT], encoder->end - SHIFT);
+    encoder->start -= SHIFT;
+    encoder->end -= SHIFT;
+}
+
+void lz_encoder_write(LzEncoder* encoder, const uint8_t* data, const size_t size)
+{
+    const uint32_t START = cycles_now();
+    size_t written = 0;
+
+    while (written < size) {
+        if (encoder->end == LZ_BUFFER_SIZE) {
+            slide(encoder);
+        }
+
+        size_t chunk = LZ_BUFFER_SIZE - encoder->end;
+        if (chunk > size - written) {
+            chunk = size - written;
+        }
+        memcpy(&encoder->buffer[encoder->end], &data[written], chunk);
+        encoder->end += chunk;
+        written += chunk;
+
+        // The last bytes wait for more input, as they could still extend a match
+        while (encoder->end - encoder->start >= LZ_MAX_MATCH) {
+            encode_next(encoder, encoder->end - encoder->start);
+        }
+    }
+
+    encoder->stats.bytes_in += size;
+    encoder->stats.cycles += cycles_now() - START;
+}
+
+void lz_encoder_flush(LzEncoder* encoder)
+{
+    if (encoder->start == encoder->end && encoder->bit_count == 0 && encoder->pending_size == 0) {
+        return;
+    }
+
+    const uint32_t START = cycles_now();
+
+    while (encoder->start < encoder->end) {
+        encode_next(encoder, encoder->end - encoder->start);
+    }
+
+    // Flush marker, then padding up to the byte boundary
+    put_bits(encoder, 0, 1 + LZ_WINDOW_BITS + LZ_LENGTH_BITS);
+    if (encoder->bit_count > 0) {
+        put_bits(encoder, 0, 8 - encoder->bit_count);
+    }
+
+    hand_over(encoder);
+    encoder->stats.flushes++;
+    encoder->stats.cycles += cycles_now() - START;
+}
+
+void lz_encoder_get_stats(LzEncoder* encoder, LzStats* const stats)
+{
+    *stats = encoder->stats;
+}
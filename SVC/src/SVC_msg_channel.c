@@ -0,0 +1,228 @@
+// ------ inclusions ---------------------------------------------------
+#include "SVC_msg_channel.h"
+#include "task.h"
+
+/// | Private typedef -----------------------------------------------------------
+/// | Private define ------------------------------------------------------------
+/// | Private macro -------------------------------------------------------------
+
+/// @brief Round a size up to the payload alignment.
+#define MSG_CHANNEL_ALIGN(size) (((size) + MSG_CHANNEL_ALIGNMENT - 1) & ~((size_t) MSG_CHANNEL_ALIGNMENT - 1))
+
+/// | Private variables ---------------------------------------------------------
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Claim contiguous payload space. Must be called inside a critical section.
+/// @param channel Channel.
+/// @param size Requested size, already aligned.
+/// @return Claimed space, or NULL if the channel is full.
+static uint8_t* claim(MsgChannel* channel, const size_t size);
+
+/// @brief Resolve the pending reservation: shrink it to the committed length, or give it back if nothing was
+///        committed. Must be called inside a critical section.
+/// @return Descriptor of the committed message. Zero length if the reservation was cancelled.
+static MsgChannelDescriptor settle(MsgChannel* channel, const size_t length);
+
+/// @brief Payload storage currently in use, in bytes. Must be called inside a critical section.
+static size_t used_bytes(MsgChannel* channel);
+
+/// | Private functions ---------------------------------------------------------
+
+void msg_channel_initialize(MsgChannel* channel, const MsgChannelConfig* const config)
+{
+    configASSERT(channel && config && config->storage && config->descriptors_storage);
+    configASSERT(((uintptr_t) config->storage % MSG_CHANNEL_ALIGNMENT) == 0);
+    configASSERT(config->size > 0 && (config->size % MSG_CHANNEL_ALIGNMENT) == 0);
+    configASSERT(config->max_messages > 0);
+
+    channel->storage = config->storage;
+    channel->size = config->size;
+    channel->max_messages = config->max_messages;
+    channel->head = 0;
+    channel->tail = 0;
+    channel->in_flight = 0;
+    channel->reserved = NULL;
+    channel->is_reading = false;
+    channel->stats = (MsgChannelStats){0};
+
+    channel->descriptors = xMessageBufferCreateStatic(
+            MSG_CHANNEL_DESCRIPTORS_SIZE(config->max_messages),
+            config->descriptors_storage,
+            &channel->descriptors_buffer);
+    configASSERT(channel->descriptors);
+}
+
+static size_t used_bytes(MsgChannel* channel)
+{
+    if (channel->in_flight == 0) {
+        return 0;
+    }
+
+    // Once wrapped, the bytes skipped at the end of the storage stay in use until the consumer gets past them
+    return (channel->head > channel->tail) ? (channel->head - channel->tail)
+                                           : (channel->size - channel->tail + channel->head);
+}
+
+static uint8_t* claim(MsgChannel* channel, const size_t size)
+{
+    if (channel->in_flight == channel->max_messages || size > channel->size) {
+        return NULL;
+    }
+
+    if (channel->in_flight == 0) {
+        // Empty: start over, so the whole storage is contiguous again
+        channel->head = 0;
+        channel->tail = 0;
+    }
+
+    // head == tail only ever means empty: the strict comparisons below keep a full channel from looking like one
+    size_t offset;
+    if (channel->head >= channel->tail) {
+        // In use: [tail, head). Free: [head, size) and [0, tail).
+        if (channel->head + size <= channel->size) {
+            offset = channel->head;
+        } else if (size < channel->tail) {
+            offset = 0;
+        } else {
+            return NULL;
+        }
+    } else {
+        // Wrapped. In use: [tail, size) and [0, head). Free: [head, tail).
+        if (channel->head + size < channel->tail) {
+            offset = channel->head;
+        } else {
+            return NULL;
+        }
+    }
+
+    channel->reserved_head = channel->head;
+    channel->head = offset + size;
+    channel->in_flight++;
+
+    const size_t USED = used_bytes(channel);
+    if (USED > channel->stats.used_max) {
+        channel->stats.used_max = USED;
+    }
+
+    return &channel->storage[offset];
+}
+
+void* msg_channel_reserve(MsgChannel* channel, const size_t size)
+{
+    configASSERT(size > 0);
+    configASSERT(channel->reserved == NULL && "Only one reservation can be pending");
+
+    taskENTER_CRITICAL();
+    uint8_t* const SPACE = claim(channel, MSG_CHANNEL_ALIGN(size));
+    if (SPACE == NULL) {
+        channel->stats.full++;
+    }
+    taskEXIT_CRITICAL();
+
+    channel->reserved = SPACE;
+    channel->reserved_size = size;
+    return SPACE;
+}
+
+void* msg_channel_reserve_from_isr(MsgChannel* channel, const size_t size)
+{
+    configASSERT(size > 0);
+    configASSERT(channel->reserved == NULL && "Only one reservation can be pending");
+
+    const UBaseType_t SAVED_MASK = taskENTER_CRITICAL_FROM_ISR();
+    uint8_t* const SPACE = claim(channel, MSG_CHANNEL_ALIGN(size));
+    if (SPACE == NULL) {
+        channel->stats.full++;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(SAVED_MASK);
+
+    channel->reserved = SPACE;
+    channel->reserved_size = size;
+    return SPACE;
+}
+
+static MsgChannelDescriptor settle(MsgChannel* channel, const size_t length)
+{
+    configASSERT(channel->reserved && length <= channel->reserved_size);
+
+    const MsgChannelDescriptor DESCRIPTOR =
+    {
+        .offset = (uint32_t)(channel->reserved - channel->storage),
+        .length = (uint32_t) length,
+    };
+
+    if (length == 0) {
+        channel->head = channel->reserved_head;
+        channel->in_flight--;
+    } else {
+        // Nothing was claimed after the reservation, so its unused tail can go back right away
+        channel->head = DESCRIPTOR.offset + MSG_CHANNEL_ALIGN(length);
+        channel->stats.messages++;
+        channel->stats.bytes += length;
+    }
+
+    channel->reserved = NULL;
+    return DESCRIPTOR;
+}
+
+void msg_channel_commit(MsgChannel* channel, const size_t length)
+{
+    taskENTER_CRITICAL();
+    const MsgChannelDescriptor DESCRIPTOR = settle(channel, length);
+    taskEXIT_CRITICAL();
+
+    if (DESCRIPTOR.length > 0) {
+        // Descriptors are bounded by `max_messages`, so there is always room for this one
+        const size_t SENT = xMessageBufferSend(channel->descriptors, &DESCRIPTOR, sizeof(DESCRIPTOR), 0);
+        configASSERT(SENT == sizeof(DESCRIPTOR));
+    }
+}
+
+void msg_channel_commit_from_isr(MsgChannel* channel, const size_t length, BaseType_t* const woken)
+{
+    configASSERT(woken);
+
+    const UBaseType_t SAVED_MASK = taskENTER_CRITICAL_FROM_ISR();
+    const MsgChannelDescriptor DESCRIPTOR = settle(channel, length);
+    taskEXIT_CRITICAL_FROM_ISR(SAVED_MASK);
+
+    if (DESCRIPTOR.length > 0) {
+        const size_t SENT = xMessageBufferSendFromISR(channel->descriptors, &DESCRIPTOR, sizeof(DESCRIPTOR), woken);
+        configASSERT(SENT == sizeof(DESCRIPTOR));
+    }
+}
+
+const void* msg_channel_receive(MsgChannel* channel, size_t* const length, const TickType_t timeout)
+{
+    configASSERT(!channel->is_reading && "Release the previous message first");
+
+    const size_t RECEIVED = xMessageBufferReceive(channel->descriptors, &channel->reading, sizeof(channel->reading),
+                                                  timeout);
+    if (RECEIVED != sizeof(channel->reading)) {
+        return NULL;
+    }
+
+    channel->is_reading = true;
+    *length = channel->reading.length;
+    return &channel->storage[channel->reading.offset];
+}
+
+void msg_channel_release(MsgChannel* channel)
+{
+    configASSERT(channel->is_reading);
+
+    // Messages are released in commit order, so the end of this one is the new start of the space in use
+    taskENTER_CRITICAL();
+    channel->tail = channel->reading.offset + MSG_CHANNEL_ALIGN(channel->reading.length);
+    channel->in_flight--;
+    taskEXIT_CRITICAL();
+
+    channel->is_reading = false;
+}
+
+void msg_channel_get_stats(MsgChannel* channel, MsgChannelStats* const stats)
+{
+    taskENTER_CRITICAL();
+    *stats = channel->stats;
+    taskEXIT_CRITICAL();
+}
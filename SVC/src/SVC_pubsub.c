@@ -0,0 +1,146 @@
+// ------ inclusions ---------------------------------------------------
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "SVC_event_pool.h"
+#include "SVC_pubsub.h"
+
+/// | Private typedef -----------------------------------------------------------
+
+/// @brief Subscribers of a topic: one bit per AO id.
+typedef uint32_t SubscriberMask;
+
+/// @brief Where a publish comes from. Both contexts share the fan-out: only the FreeRTOS and pool calls differ.
+typedef struct
+{
+    BaseType_t* woken;  ///< NULL in task context. From an ISR, set to pdTRUE if a higher priority task woke up.
+    TickType_t timeout; ///< Task context only: maximum amount of ticks to wait on each subscriber queue.
+} PublishContext;
+
+/// | Private define ------------------------------------------------------------
+/// | Private macro -------------------------------------------------------------
+
+#define AO_BIT(ao) ((SubscriberMask)1U << (ao)->id)
+
+/// | Private variables ---------------------------------------------------------
+
+/// @brief Subscribers of every topic. Only modified inside a critical section.
+static SubscriberMask subscribers[TOPICS_TOTAL];
+
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Publish an event to every subscriber of a topic, from task or interrupt context.
+/// @return true if every subscriber got the event, false otherwise.
+static bool publish(const PubSubTopic topic, const void* const event, const size_t event_size, const AOLane lane,
+        const PublishContext* const context);
+
+/// | Private functions ---------------------------------------------------------
+
+void pubsub_subscribe(const PubSubTopic topic, ActiveObject* const ao)
+{
+    configASSERT(topic < TOPICS_TOTAL);
+    configASSERT(ao->id < (sizeof(SubscriberMask) * 8));
+
+    taskENTER_CRITICAL();
+    subscribers[topic] |= AO_BIT(ao);
+    taskEXIT_CRITICAL();
+}
+
+void pubsub_unsubscribe(const PubSubTopic topic, ActiveObject* const ao)
+{
+    configASSERT(topic < TOPICS_TOTAL);
+
+    taskENTER_CRITICAL();
+    subscribers[topic] &= ~AO_BIT(ao);
+    taskEXIT_CRITICAL();
+}
+
+static bool publish(const PubSubTopic topic, const void* const event, const size_t event_size, const AOLane lane,
+        const PublishContext* const context)
+{
+    configASSERT(topic < TOPICS_TOTAL);
+
+    BaseType_t* const WOKEN = context->woken;
+    bool delivered = true;
+    SubscriberMask shared_subscribers = 0;
+    uint8_t shared_count = 0;
+
+    // Work on a snapshot, so (un)subscribing while publishing is safe
+    SubscriberMask snapshot;
+    if (WOKEN) {
+        const UBaseType_t SAVED_MASK = taskENTER_CRITICAL_FROM_ISR();
+        snapshot = subscribers[topic];
+        taskEXIT_CRITICAL_FROM_ISR(SAVED_MASK);
+    } else {
+        taskENTER_CRITICAL();
+        snapshot = subscribers[topic];
+        taskEXIT_CRITICAL();
+    }
+
+    // First pass: by value subscribers get their own copy inside their queue. The rest are counted.
+    for (SubscriberMask pending = snapshot; pending; pending &= (pending - 1)) {
+        ActiveObject* const AO = ao_registry_get((uint8_t)__builtin_ctz(pending));
+        configASSERT(AO && AO->event_size == event_size);
+
+        if (AO->by_value) {
+            delivered &= WOKEN ? ao_post_lane_from_isr(AO, event, lane, WOKEN)
+                               : ao_post_lane(AO, event, lane, context->timeout);
+        } else {
+            shared_subscribers |= AO_BIT(AO);
+            shared_count++;
+        }
+    }
+
+    if (shared_count == 0) {
+        return delivered;
+    }
+
+    // Second pass: a single block, holding one reference per subscriber, is shared by every other subscriber
+    void* const BLOCK = WOKEN ? event_pool_get_from_isr(event_size) : event_pool_get(event_size);
+    if (BLOCK == NULL) {
+        return false;
+    }
+
+    memcpy(BLOCK, event, event_size);
+    if (shared_count > 1) {
+        if (WOKEN) {
+            event_pool_retain_from_isr(BLOCK, shared_count - 1);
+        } else {
+            event_pool_retain(BLOCK, shared_count - 1);
+        }
+    }
+
+    for (SubscriberMask pending = shared_subscribers; pending; pending &= (pending - 1)) {
+        ActiveObject* const AO = ao_registry_get((uint8_t)__builtin_ctz(pending));
+        const bool POSTED = WOKEN ? ao_post_reference_from_isr(AO, BLOCK, lane, WOKEN)
+                                  : ao_post_reference(AO, BLOCK, lane, context->timeout);
+
+        if (!POSTED) {
+            // This subscriber will never drop its reference, so do it on its behalf
+            if (WOKEN) {
+                event_pool_put_from_isr(BLOCK);
+            } else {
+                event_pool_put(BLOCK);
+            }
+            delivered = false;
+        }
+    }
+
+    return delivered;
+}
+
+bool pubsub_publish(const PubSubTopic topic, const void* const event, const size_t event_size, const AOLane lane, const TickType_t timeout)
+{
+    const PublishContext CONTEXT = {.woken = NULL, .timeout = timeout};
+    return publish(topic, event, event_size, lane, &CONTEXT);
+}
+
+bool pubsub_publish_from_isr(const PubSubTopic topic, const void* const event, const size_t event_size, const AOLane lane, BaseType_t* const woken)
+{
+    const PublishContext CONTEXT = {.woken = woken, .timeout = 0};
+
+    configASSERT(woken);
+    return publish(topic, event, event_size, lane, &CONTEXT);
+}
@@ -0,0 +1,277 @@
+// ------ inclusions ---------------------------------------------------
+#include <stdarg.h>
+#include <string.h>
+
+#include "HAL_cycles.h"
+#include "SVC_format.h"
+#include "SVC_recorder.h"
+#include "task.h"
+
+#if RECORDER_ENABLED
+
+/// | Private typedef -----------------------------------------------------------
+/// | Private define ------------------------------------------------------------
+
+#define RECORDER_MASK ((uint32_t)RECORDER_RECORDS - 1U)
+
+/// @brief Longest dump line, including the terminator.
+#define RECORDER_LINE_SIZE 96
+
+/// @brief Longest wait for a dump line to go out over UART, in ms.
+#define RECORDER_UART_TIMEOUT_MS 100
+
+/// @brief Version of the dump format. Bump it on every change, so the host tool can refuse what it can not parse.
+#define RECORDER_DUMP_VERSION 1
+
+#define FNV_OFFSET_BASIS 2166136261UL
+#define FNV_PRIME 16777619UL
+
+/// | Private macro -------------------------------------------------------------
+/// | Private variables ---------------------------------------------------------
+
+_Static_assert((RECORDER_RECORDS & (RECORDER_RECORDS - 1)) == 0, "RECORDER_RECORDS must be a power of two");
+
+/// @brief Record ring. The record of sequence N lives at N & RECORDER_MASK.
+static RecorderRecord records[RECORDER_RECORDS];
+
+/// @brief Sequence of the next record.
+static uint32_t next_sequence = 0;
+
+/// @brief Posting tasks seen so far. Names are copied, so they outlive deleted tasks.
+static TaskHandle_t sources[RECORDER_MAX_SOURCES];
+static char source_names[RECORDER_MAX_SOURCES][configMAX_TASK_NAME_LEN];
+static uint8_t sources_count = 0;
+
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief FNV-1a digest of a buffer.
+static uint32_t digest(const void* const data, const size_t size);
+
+/// @brief Source index of a task, learning it on its first post. Must be called inside a critical section.
+/// @param task Posting task. NULL before the scheduler starts.
+static uint8_t source_of(TaskHandle_t task);
+
+/// @brief Store a record in the ring. Must be called inside a critical section.
+static void store(ActiveObject* ao, const void* const event, const AOLane lane, const uint8_t source,
+                  const uint32_t event_digest, const uint32_t timestamp);
+
+/// @brief Format a line and hand it to the dump sink. Lines that do not fit are truncated.
+static void emit(recorder_write_t write, void* context, const char* format, ...);
+
+/// @brief Dump the ring, for `recorder_dump()` and `recorder_dump_halted()`.
+/// @param write Line sink.
+/// @param context Argument of `write`.
+/// @param halted `true` once the system has stopped for good: nothing can preempt the dump any more, so the ring is
+///        read without critical sections (whose nesting may be broken, and which are not allowed in a fault handler).
+static void dump(recorder_write_t write, void* context, const bool halted);
+
+/// @brief Dump sink of `recorder_dump_uart()`.
+static void write_uart(const char* line, const size_t length, void* context);
+
+/// @brief Dump sink of `recorder_dump_halted()`.
+static void write_uart_polled(const char* line, const size_t length, void* context);
+
+/// @brief Dump sink of `recorder_print()`.
+static void write_stdout(const char* line, const size_t length, void* context);
+
+/// | Private functions ---------------------------------------------------------
+
+static uint32_t digest(const void* const data, const size_t size)
+{
+    const uint8_t* const BYTES = (const uint8_t*) data;
+    uint32_t hash = FNV_OFFSET_BASIS;
+
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ BYTES[i]) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static uint8_t source_of(TaskHandle_t task)
+{
+    for (uint8_t i = 0; i < sources_count; i++) {
+        if (sources[i] == task) {
+            return i;
+        }
+    }
+
+    if (sources_count == RECORDER_MAX_SOURCES) {
+        return RECORDER_SOURCE_OTHER;
+    }
+
+    sources[sources_count] = task;
+    strncpy(source_names[sources_count], task ? pcTaskGetName(task) : "boot", configMAX_TASK_NAME_LEN - 1);
+    return sources_count++;
+}
+
+static void store(ActiveObject* ao, const void* const event, const AOLane lane, const uint8_t source,
+                  const uint32_t event_digest, const uint32_t timestamp)
+{
+    RecorderRecord* const RECORD = &records[next_sequence & RECORDER_MASK];
+    const size_t PAYLOAD_SIZE = (ao->event_size < RECORDER_PAYLOAD_SIZE) ? ao->event_size : RECORDER_PAYLOAD_SIZE;
+
+    RECORD->sequence = next_sequence++;
+    RECORD->timestamp = timestamp;
+    RECORD->digest = event_digest;
+    RECORD->source = source;
+    RECORD->destination = ao->id;
+    RECORD->lane = (uint8_t) lane;
+    RECORD->size = (ao->event_size < UINT8_MAX) ? (uint8_t) ao->event_size : UINT8_MAX;
+    memset(RECORD->payload, 0, sizeof(RECORD->payload));
+    memcpy(RECORD->payload, event, PAYLOAD_SIZE);
+}
+
+void recorder_record(ActiveObject* ao, const void* const event, const AOLane lane)
+{
+    const uint32_t TIMESTAMP = cycles_now();
+    // The digest walks the whole event, so it stays out of the critical section
+    const uint32_t DIGEST = digest(event, ao->event_size);
+    TaskHandle_t const TASK = (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) ? NULL : xTaskGetCurrentTaskHandle();
+
+    taskENTER_CRITICAL();
+    store(ao, event, lane, source_of(TASK), DIGEST, TIMESTAMP);
+    taskEXIT_CRITICAL();
+}
+
+void recorder_record_from_isr(ActiveObject* ao, const void* const event, const AOLane lane)
+{
+    const uint32_t TIMESTAMP = cycles_now();
+    const uint32_t DIGEST = digest(event, ao->event_size);
+
+    const UBaseType_t SAVED_MASK = taskENTER_CRITICAL_FROM_ISR();
+    store(ao, event, lane, RECORDER_SOURCE_ISR, DIGEST, TIMESTAMP);
+    taskEXIT_CRITICAL_FROM_ISR(SAVED_MASK);
+}
+
+size_t recorder_snapshot(RecorderRecord* const snapshot, const size_t max_records)
+{
+    taskENTER_CRITICAL();
+    const uint32_t END = next_sequence;
+    taskEXIT_CRITICAL();
+
+    const uint32_t AVAILABLE = (END < RECORDER_RECORDS) ? END : RECORDER_RECORDS;
+    size_t copied = 0;
+
+    // One record per critical section, so a snapshot never holds the interrupts off for long. Records overwritten
+    // in the meantime are skipped.
+    for (uint32_t sequence = END - AVAILABLE; sequence != END && copied < max_records; sequence++) {
+        taskENTER_CRITICAL();
+        snapshot[copied] = records[sequence & RECORDER_MASK];
+        taskEXIT_CRITICAL();
+
+        if (snapshot[copied].sequence == sequence) {
+            copied++;
+        }
+    }
+
+    return copied;
+}
+
+static void emit(recorder_write_t write, void* context, const char* format, ...)
+{
+    char line[RECORDER_LINE_SIZE];
+    va_list arguments;
+
+    va_start(arguments, format);
+    const int LENGTH = format_vsnprintf(line, sizeof(line), format, arguments);
+    va_end(arguments);
+
+    if (LENGTH > 0) {
+        write(line, ((size_t) LENGTH < sizeof(line)) ? (size_t) LENGTH : sizeof(line) - 1, context);
+    }
+}
+
+static void dump(recorder_write_t write, void* context, const bool halted)
+{
+    if (!halted) {
+        taskENTER_CRITICAL();
+    }
+    const uint32_t END = next_sequence;
+    const uint8_t SOURCES = sources_count;
+    if (!halted) {
+        taskEXIT_CRITICAL();
+    }
+
+    const uint32_t AVAILABLE = (END < RECORDER_RECORDS) ? END : RECORDER_RECORDS;
+
+    // The log UART may be in the middle of a binary log frame: the header must start a line of its own
+    emit(write, context, "\n#REC %u %lu %lu\n", RECORDER_DUMP_VERSION, (unsigned long) cycles_from_us(1000000U),
+            (unsigned long) AVAILABLE);
+
+    for (ActiveObject* ao = ao_registry_get(0); ao; ao = ao_registry_get(ao->id + 1)) {
+        emit(write, context, "#AO %u %lu %s\n", ao->id, (unsigned long) ao->event_size, ao->name ? ao->name : "?");
+    }
+
+    for (uint8_t i = 0; i < SOURCES; i++) {
+        emit(write, context, "#SRC %u %s\n", i, source_names[i]);
+    }
+
+    for (uint32_t sequence = END - AVAILABLE; sequence != END; sequence++) {
+        RecorderRecord record;
+        if (!halted) {
+            taskENTER_CRITICAL();
+        }
+        record = records[sequence & RECORDER_MASK];
+        if (!halted) {
+            taskEXIT_CRITICAL();
+        }
+
+        if (record.sequence != sequence) {
+            continue; // Overwritten while dumping
+        }
+
+        char payload[2 * RECORDER_PAYLOAD_SIZE + 1];
+        for (size_t i = 0; i < RECORDER_PAYLOAD_SIZE; i++) {
+            format_snprintf(&payload[2 * i], 3, "%02x", record.payload[i]);
+        }
+
+        emit(write, context, "R %lu %lu %u %u %u %u %08lx %s\n",
+                (unsigned long) record.sequence, (unsigned long) record.timestamp, record.source,
+                record.destination, record.lane, record.size, (unsigned long) record.digest, payload);
+    }
+
+    emit(write, context, "#END\n");
+}
+
+void recorder_dump(recorder_write_t write, void* context)
+{
+    dump(write, context, false);
+}
+
+static void write_uart(const char* line, const size_t length, void* context)
+{
+    const UARTInstance INSTANCE = *(const UARTInstance*) context;
+    uart_send_blocking(INSTANCE, (const uint8_t*) line, length, RECORDER_UART_TIMEOUT_MS);
+}
+
+void recorder_dump_uart(const UARTInstance instance)
+{
+    UARTInstance context = instance;
+    recorder_dump(write_uart, &context);
+}
+
+static void write_uart_polled(const char* line, const size_t length, void* context)
+{
+    const UARTInstance INSTANCE = *(const UARTInstance*) context;
+    uart_send_polled(INSTANCE, (const uint8_t*) line, length);
+}
+
+void recorder_dump_halted(const UARTInstance instance)
+{
+    UARTInstance context = instance;
+    dump(write_uart_polled, &context, true);
+}
+
+static void write_stdout(const char* line, const size_t length, void* context)
+{
+    (void) context;
+    format_printf("%.*s", (int) length, line);
+}
+
+void recorder_print()
+{
+    recorder_dump(write_stdout, NULL);
+}
+
+#endif // RECORDER_ENABLED
@@ -0,0 +1,200 @@
+// ------ inclusions ---------------------------------------------------
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#include "SVC_time_event.h"
+
+/// | Private typedef -----------------------------------------------------------
+
+/// @brief Hashed timing wheel. A time event that expires in `delay` ticks lives in slot `(cursor + delay) % SLOTS`,
+///        and waits `(delay - 1) / SLOTS` extra revolutions there. Every field is protected by suspending the
+///        scheduler, since the wheel is only touched from task context (including the timer task).
+typedef struct
+{
+    TimeEvent* slots[TIME_EVENT_WHEEL_SLOTS]; ///< Time events of every slot (doubly linked, unsorted).
+    uint16_t cursor;                          ///< Slot processed by the last tick.
+    uint32_t armed;                           ///< Amount of armed time events.
+} TimingWheel;
+
+/// | Private define ------------------------------------------------------------
+
+#define WHEEL_MASK (TIME_EVENT_WHEEL_SLOTS - 1)
+
+#define TIME_EVENT_TICK_PERIOD 1 // In RTOS ticks
+
+/// | Private macro -------------------------------------------------------------
+/// | Private variables ---------------------------------------------------------
+
+static TimingWheel wheel;
+
+static TimerHandle_t wheel_timer;
+static StaticTimer_t wheel_timer_buffer;
+
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Insert a time event in the wheel. The scheduler must be suspended.
+static void wheel_insert(TimeEvent* te, const TickType_t delay);
+
+/// @brief Remove a time event from the wheel. The scheduler must be suspended.
+static void wheel_remove(TimeEvent* te);
+
+/// @brief Start the wheel timer when the first time event gets armed, and stop it when the last one is gone, so the
+///        timer task is not woken up every tick for nothing. The scheduler must be suspended.
+/// @param armed_before Amount of armed time events before the last wheel update.
+static void wheel_sync_timer(const uint32_t armed_before);
+
+/// @brief Timer callback: advance the wheel one slot and expire its due time events.
+static void wheel_tick(TimerHandle_t timer);
+
+/// | Private functions ---------------------------------------------------------
+
+static void wheel_insert(TimeEvent* te, const TickType_t delay)
+{
+    const uint16_t SLOT = (uint16_t)((wheel.cursor + delay) & WHEEL_MASK);
+
+    te->slot = SLOT;
+    te->rounds = (delay - 1) / TIME_EVENT_WHEEL_SLOTS;
+    te->prev = NULL;
+    te->next = wheel.slots[SLOT];
+    if (te->next) {
+        te->next->prev = te;
+    }
+    wheel.slots[SLOT] = te;
+    te->armed = true;
+    wheel.armed++;
+}
+
+static void wheel_remove(TimeEvent* te)
+{
+    if (te->prev) {
+        te->prev->next = te->next;
+    } else {
+        wheel.slots[te->slot] = te->next;
+    }
+
+    if (te->next) {
+        te->next->prev = te->prev;
+    }
+
+    te->next = NULL;
+    te->prev = NULL;
+    te->armed = false;
+    wheel.armed--;
+}
+
+static void wheel_sync_timer(const uint32_t armed_before)
+{
+    if (armed_before == 0 && wheel.armed > 0) {
+        xTimerStart(wheel_timer, 0);
+    } else if (armed_before > 0 && wheel.armed == 0) {
+        xTimerStop(wheel_timer, 0);
+    }
+}
+
+static void wheel_tick(TimerHandle_t timer)
+{
+    (void) timer;
+    TimeEvent* fired = NULL;
+
+    vTaskSuspendAll();
+
+    const uint32_t ARMED_BEFORE = wheel.armed;
+    wheel.cursor = (wheel.cursor + 1) & WHEEL_MASK;
+
+    TimeEvent* te = wheel.slots[wheel.cursor];
+    while (te) {
+        TimeEvent* const NEXT = te->next;
+
+        if (te->rounds > 0) {
+            te->rounds--;
+        } else {
+            wheel_remove(te);
+            if (te->period > 0) {
+                wheel_insert(te, te->period);
+            }
+
+            // Posted once the scheduler runs again: the receiver may preempt the timer task, or be woken through a
+            // queue set, neither of which is allowed while the scheduler is suspended
+            te->fired = fired;
+            fired = te;
+        }
+
+        te = NEXT;
+    }
+
+    wheel_sync_timer(ARMED_BEFORE);
+    xTaskResumeAll();
+
+    for (te = fired; te; te = te->fired) {
+        // Never block the timer task: if the queue is full the expiration is lost
+        ao_post(te->ao, te->event, 0);
+    }
+}
+
+void time_event_init()
+{
+    for (size_t i = 0; i < TIME_EVENT_WHEEL_SLOTS; i++) {
+        wheel.slots[i] = NULL;
+    }
+    wheel.cursor = 0;
+    wheel.armed = 0;
+
+    wheel_timer = xTimerCreateStatic(
+            "Time Events",
+            TIME_EVENT_TICK_PERIOD,
+            pdTRUE,
+            NULL,
+            wheel_tick,
+            &wheel_timer_buffer);
+    configASSERT(wheel_timer);
+}
+
+void time_event_create(TimeEvent* te, ActiveObject* ao, const void* event)
+{
+    configASSERT(te && ao && event);
+
+    te->next = NULL;
+    te->prev = NULL;
+    te->fired = NULL;
+    te->ao = ao;
+    te->event = event;
+    te->period = 0;
+    te->rounds = 0;
+    te->slot = 0;
+    te->armed = false;
+}
+
+void time_event_arm(TimeEvent* te, const TickType_t delay, const TickType_t period)
+{
+    configASSERT(delay > 0);
+
+    vTaskSuspendAll();
+    const uint32_t ARMED_BEFORE = wheel.armed;
+    if (te->armed) {
+        wheel_remove(te);
+    }
+    te->period = period;
+    wheel_insert(te, delay);
+    wheel_sync_timer(ARMED_BEFORE);
+    xTaskResumeAll();
+}
+
+bool time_event_disarm(TimeEvent* te)
+{
+    vTaskSuspendAll();
+    const uint32_t ARMED_BEFORE = wheel.armed;
+    const bool WAS_ARMED = te->armed;
+    if (WAS_ARMED) {
+        wheel_remove(te);
+    }
+    wheel_sync_timer(ARMED_BEFORE);
+    xTaskResumeAll();
+
+    return WAS_ARMED;
+}
+
+bool time_event_is_armed(const TimeEvent* te)
+{
+    return te->armed;
+}
@@ -0,0 +1,146 @@
+// ------ inclusions ---------------------------------------------------
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "SVC_trace.h"
+
+#if TRACE_ENABLED
+
+#include "HAL_cycles.h"
+#include "SVC_format.h"
+
+/// | Private typedef -----------------------------------------------------------
+
+/// @brief Timestamps of an event in flight.
+typedef struct
+{
+    TraceId id;                            ///< Event stamped in this record. TRACE_ID_NONE if free.
+    uint8_t stamped;                       ///< Bit N set: stage N was stamped
+    uint32_t stamps[TRACE_STAGES_TOTAL];   ///< Cycle counter at each stage
+} TraceRecord;
+
+/// | Private define ------------------------------------------------------------
+/// | Private macro -------------------------------------------------------------
+
+#define STAGE_BIT(stage) ((uint8_t)(1U << (stage)))
+#define ALL_STAGES ((uint8_t)((1U << TRACE_STAGES_TOTAL) - 1U))
+
+/// | Private variables ---------------------------------------------------------
+
+/// @brief Sequence id of the last traced event.
+static TraceId last_id = TRACE_ID_NONE;
+
+/// @brief Events in flight, indexed by `id % TRACE_RECORDS`.
+static TraceRecord records[TRACE_RECORDS];
+
+/// @brief Latency histogram of each stage.
+static TraceHistogram histograms[TRACE_STAGES_TOTAL];
+
+/// @brief Printable names of every TraceStage.
+static const char* const TRACE_STAGE_NAMES[TRACE_STAGES_TOTAL] =
+{
+    [TRACE_STAGE_EDGE] = "edge->applied",
+    [TRACE_STAGE_CLASSIFIED] = "edge->classified",
+    [TRACE_STAGE_POSTED] = "classified->posted",
+    [TRACE_STAGE_DISPATCHED] = "posted->dispatched",
+    [TRACE_STAGE_APPLIED] = "dispatched->applied",
+};
+
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Add a latency to a histogram. Must be called inside a critical section.
+static void histogram_add(TraceHistogram* const histogram, const uint32_t cycles);
+
+/// | Private functions ---------------------------------------------------------
+
+static void histogram_add(TraceHistogram* const histogram, const uint32_t cycles)
+{
+    const uint32_t BUCKET = 31U - (uint32_t)__builtin_clz(cycles | 1U);
+
+    if (histogram->count == 0 || cycles < histogram->min) {
+        histogram->min = cycles;
+    }
+    if (cycles > histogram->max) {
+        histogram->max = cycles;
+    }
+    histogram->count++;
+    histogram->total += cycles;
+    histogram->buckets[BUCKET]++;
+}
+
+TraceId trace_begin(const uint32_t edge_cycles)
+{
+    const uint32_t NOW = cycles_now();
+
+    taskENTER_CRITICAL();
+    if (++last_id == TRACE_ID_NONE) {
+        last_id++;
+    }
+    const TraceId ID = last_id;
+
+    TraceRecord* const RECORD = &records[ID % TRACE_RECORDS];
+    RECORD->id = ID;
+    RECORD->stamps[TRACE_STAGE_EDGE] = edge_cycles;
+    RECORD->stamps[TRACE_STAGE_CLASSIFIED] = NOW;
+    RECORD->stamped = STAGE_BIT(TRACE_STAGE_EDGE) | STAGE_BIT(TRACE_STAGE_CLASSIFIED);
+    taskEXIT_CRITICAL();
+
+    return ID;
+}
+
+void trace_stamp(const TraceId id, const TraceStage stage)
+{
+    if (id == TRACE_ID_NONE || stage >= TRACE_STAGES_TOTAL) {
+        return;
+    }
+
+    const uint32_t NOW = cycles_now();
+    TraceRecord* const RECORD = &records[id % TRACE_RECORDS];
+
+    taskENTER_CRITICAL();
+    if (RECORD->id == id) {
+        RECORD->stamps[stage] = NOW;
+        RECORD->stamped |= STAGE_BIT(stage);
+
+        if (RECORD->stamped == ALL_STAGES) {
+            for (size_t i = TRACE_STAGE_CLASSIFIED; i < TRACE_STAGES_TOTAL; i++) {
+                histogram_add(&histograms[i], RECORD->stamps[i] - RECORD->stamps[i - 1]);
+            }
+            histogram_add(&histograms[TRACE_STAGE_EDGE], RECORD->stamps[TRACE_STAGE_APPLIED] - RECORD->stamps[TRACE_STAGE_EDGE]);
+            RECORD->id = TRACE_ID_NONE;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+void trace_get_histogram(const TraceStage stage, TraceHistogram* const histogram)
+{
+    configASSERT(stage < TRACE_STAGES_TOTAL);
+
+    taskENTER_CRITICAL();
+    *histogram = histograms[stage];
+    taskEXIT_CRITICAL();
+}
+
+void trace_print()
+{
+    format_printf("[trace] stage                count    min        avg        max (cycles)\n");
+
+    for (TraceStage stage = TRACE_STAGE_EDGE; stage < TRACE_STAGES_TOTAL; stage++) {
+        TraceHistogram histogram;
+        trace_get_histogram(stage, &histogram);
+
+        const uint32_t AVG = histogram.count ? (uint32_t)(histogram.total / histogram.count) : 0;
+        format_printf("[trace] %-20s %-8lu %-10lu %-10lu %lu\n", TRACE_STAGE_NAMES[stage], (unsigned long)histogram.count,
+                (unsigned long)histogram.min, (unsigned long)AVG, (unsigned long)histogram.max);
+
+        for (size_t bucket = 0; bucket < TRACE_HISTOGRAM_BUCKETS; bucket++) {
+            if (histogram.buckets[bucket]) {
+                format_printf("[trace] \t[2^%u, 2^%u): %lu\n", (unsigned)bucket, (unsigned)bucket + 1,
+                        (unsigned long)histogram.buckets[bucket]);
+            }
+        }
+    }
+}
+
+#endif // TRACE_ENABLED
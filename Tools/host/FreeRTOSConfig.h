@@ -0,0 +1,71 @@
+/*
+ * FreeRTOS configuration of the host builds (Tools/host). Mirrors Core/Inc/FreeRTOSConfig.h wherever the application
+ * can tell the difference (tick rate, priorities, names, sizes, enabled APIs), and drops what only makes sense on the
+ * target (interrupt priorities, run time stats, newlib).
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <stdint.h>
+
+extern void vAssertCalled(const char* file, unsigned long line);
+extern void log_task_deleted(void* task);
+
+#define configUSE_PREEMPTION                     1
+#define configSUPPORT_STATIC_ALLOCATION          1
+#define configSUPPORT_DYNAMIC_ALLOCATION         1
+#define configUSE_IDLE_HOOK                      1 /* Virtual time: the idle task advances the tick (port.c) */
+#define configUSE_TICK_HOOK                      0
+#define configCPU_CLOCK_HZ                       ((unsigned long)100000000)
+#define configTICK_RATE_HZ                       ((TickType_t)1000)
+#define configMAX_PRIORITIES                     ( 56 )
+#define configMINIMAL_STACK_SIZE                 ((uint16_t)128)
+#define configTOTAL_HEAP_SIZE                    ((size_t)(256 * 1024))
+#define configMAX_TASK_NAME_LEN                  ( 16 )
+#define configGENERATE_RUN_TIME_STATS            0
+#define configUSE_TRACE_FACILITY                 1
+#define configUSE_STATS_FORMATTING_FUNCTIONS     0
+#define configUSE_16_BIT_TICKS                   0
+#define configUSE_MUTEXES                        1
+#define configQUEUE_REGISTRY_SIZE                8
+#define configUSE_RECURSIVE_MUTEXES              1
+#define configUSE_MALLOC_FAILED_HOOK             1
+#define configUSE_COUNTING_SEMAPHORES            1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+#define configRECORD_STACK_HIGH_ADDRESS          1
+#define configCHECK_FOR_STACK_OVERFLOW           0 /* Task stacks are unused: every task runs on a thread */
+#define configMESSAGE_BUFFER_LENGTH_TYPE         size_t
+#define configUSE_NEWLIB_REENTRANT               0
+#define configUSE_QUEUE_SETS                     1
+#define configUSE_TASK_NOTIFICATIONS             1
+
+#define configUSE_CO_ROUTINES                    0
+#define configMAX_CO_ROUTINE_PRIORITIES          ( 2 )
+
+#define configUSE_TIMERS                         1
+#define configTIMER_TASK_PRIORITY                ( 2 )
+#define configTIMER_QUEUE_LENGTH                 10
+#define configTIMER_TASK_STACK_DEPTH             256
+
+#define INCLUDE_vTaskPrioritySet                 1
+#define INCLUDE_uxTaskPriorityGet                1
+#define INCLUDE_vTaskDelete                      1
+#define INCLUDE_vTaskCleanUpResources            0
+#define INCLUDE_vTaskSuspend                     1
+#define INCLUDE_vTaskDelayUntil                  1
+#define INCLUDE_vTaskDelay                       1
+#define INCLUDE_xTaskGetSchedulerState           1
+#define INCLUDE_xTimerPendFunctionCall           1
+#define INCLUDE_xQueueGetMutexHolder             1
+#define INCLUDE_uxTaskGetStackHighWaterMark      1
+#define INCLUDE_xTaskGetCurrentTaskHandle        1
+#define INCLUDE_eTaskGetState                    1
+
+/* A failed assertion reports where, and aborts (host_hooks.c) */
+#define configASSERT( x ) if ((x) == 0) {vAssertCalled(__FILE__, __LINE__);}
+
+/* Same hook as the target (SVC_log.h) */
+#define traceTASK_DELETE( pxTaskToDelete )       log_task_deleted( pxTaskToDelete )
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,51 @@
+// ------ inclusions ---------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/// | Private typedef -----------------------------------------------------------
+/// | Private define ------------------------------------------------------------
+/// | Private macro -------------------------------------------------------------
+/// | Private variables ---------------------------------------------------------
+
+static StaticTask_t idle_task_buffer;
+static StackType_t idle_stack[configMINIMAL_STACK_SIZE];
+static StaticTask_t timer_task_buffer;
+static StackType_t timer_stack[configTIMER_TASK_STACK_DEPTH];
+
+/// | Private function prototypes -----------------------------------------------
+/// | Private functions ---------------------------------------------------------
+
+// Host builds have no debugger to halt into: a failed assertion is a failed run
+void vAssertCalled(const char* file, unsigned long line)
+{
+    fprintf(stderr, "Assertion failed at %s:%lu\n", file, line);
+    abort();
+}
+
+// Virtual time: the tick only moves once every other task is blocked (see port.c)
+void vApplicationIdleHook(void)
+{
+    vPortAdvanceTime();
+}
+
+void vApplicationMallocFailedHook(void)
+{
+    configASSERT(pdFALSE && "FreeRTOS heap exhausted");
+}
+
+void vApplicationGetIdleTaskMemory(StaticTask_t** task_buffer, StackType_t** stack, uint32_t* stack_depth)
+{
+    *task_buffer = &idle_task_buffer;
+    *stack = idle_stack;
+    *stack_depth = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t** task_buffer, StackType_t** stack, uint32_t* stack_depth)
+{
+    *task_buffer = &timer_task_buffer;
+    *stack = timer_stack;
+    *stack_depth = configTIMER_TASK_STACK_DEPTH;
+}
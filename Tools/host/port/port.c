@@ -0,0 +1,188 @@
+/*
+ * FreeRTOS port for host builds (Tools/host): a single, simulated CPU on top of POSIX threads.
+ *
+ * Every task gets a thread of its own, but only the thread of pxCurrentTCB ever runs: the others wait for their
+ * turn, so the kernel and the application see one CPU and never run in parallel. There are no interrupts, so a task
+ * only gives the CPU away when it yields (blocking calls included).
+ *
+ * Time is virtual. The tick count only moves when the idle task runs (see vPortAdvanceTime()), i.e. once every other
+ * task is blocked, so delays and timeouts take no wall-clock time and a run always takes the same path. Tasks that
+ * never block starve time too: host builds are meant for event driven code.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Thread of a task. Allocated on its own, so it outlives the stack of a deleted task. */
+typedef struct
+{
+    pthread_t thread;
+    pthread_cond_t resume;  /* Signalled when `running` is set. */
+    bool running;           /* Set while the task holds the CPU. Guarded by `cpu`. */
+    TaskFunction_t code;
+    void *parameters;
+} PortThread;
+
+/* The running task, from tasks.c. Its first member is the top of its stack. */
+extern void * volatile pxCurrentTCB;
+
+static pthread_mutex_t cpu = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t scheduler_ended = PTHREAD_COND_INITIALIZER;
+static bool ended = false;
+static bool scheduler_running = false;
+
+/* Only the running task touches these, and it only switches with no critical section open. */
+static UBaseType_t critical_nesting = 0;
+static bool yield_pending = false;
+
+/*-----------------------------------------------------------*/
+
+static PortThread *thread_of( void *tcb )
+{
+    StackType_t *const TOP = *( StackType_t ** ) tcb;
+    return ( PortThread * ) *TOP;
+}
+
+static void wait_turn( PortThread *thread )
+{
+    pthread_mutex_lock( &cpu );
+    while( !thread->running )
+    {
+        pthread_cond_wait( &thread->resume, &cpu );
+    }
+    pthread_mutex_unlock( &cpu );
+}
+
+static void *thread_main( void *parameter )
+{
+    PortThread *const THREAD = ( PortThread * ) parameter;
+
+    wait_turn( THREAD );
+    THREAD->code( THREAD->parameters );
+
+    /* Tasks must not return: the target asserts here. */
+    configASSERT( pdFALSE );
+    return NULL;
+}
+
+static void switch_context( void )
+{
+    PortThread *const FROM = thread_of( pxCurrentTCB );
+    vTaskSwitchContext();
+    PortThread *const TO = thread_of( pxCurrentTCB );
+
+    if( TO == FROM )
+    {
+        return;
+    }
+
+    /* A deleted task hands the CPU over and waits forever. */
+    pthread_mutex_lock( &cpu );
+    FROM->running = false;
+    TO->running = true;
+    pthread_cond_signal( &TO->resume );
+    while( !FROM->running )
+    {
+        pthread_cond_wait( &FROM->resume, &cpu );
+    }
+    pthread_mutex_unlock( &cpu );
+}
+
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+    PortThread *const THREAD = ( PortThread * ) calloc( 1, sizeof( PortThread ) );
+    configASSERT( THREAD );
+
+    THREAD->code = pxCode;
+    THREAD->parameters = pvParameters;
+    pthread_cond_init( &THREAD->resume, NULL );
+
+    pthread_attr_t attributes;
+    pthread_attr_init( &attributes );
+    pthread_attr_setdetachstate( &attributes, PTHREAD_CREATE_DETACHED );
+    const int CREATED = pthread_create( &THREAD->thread, &attributes, thread_main, THREAD );
+    pthread_attr_destroy( &attributes );
+    configASSERT( CREATED == 0 );
+
+    /* The task stack itself is never used: it only tells the kernel where the thread is. */
+    *pxTopOfStack = ( StackType_t ) THREAD;
+    return pxTopOfStack;
+}
+
+BaseType_t xPortStartScheduler( void )
+{
+    PortThread *const FIRST = thread_of( pxCurrentTCB );
+
+    scheduler_running = true;
+
+    pthread_mutex_lock( &cpu );
+    FIRST->running = true;
+    pthread_cond_signal( &FIRST->resume );
+    while( !ended )
+    {
+        pthread_cond_wait( &scheduler_ended, &cpu );
+    }
+    pthread_mutex_unlock( &cpu );
+
+    return pdFALSE;
+}
+
+void vPortEndScheduler( void )
+{
+    PortThread *const SELF = thread_of( pxCurrentTCB );
+
+    /* vTaskStartScheduler() returns to its caller. The calling task never runs again. */
+    pthread_mutex_lock( &cpu );
+    ended = true;
+    SELF->running = false;
+    pthread_cond_signal( &scheduler_ended );
+    while( !SELF->running )
+    {
+        pthread_cond_wait( &SELF->resume, &cpu );
+    }
+    pthread_mutex_unlock( &cpu );
+}
+
+void vPortYield( void )
+{
+    if( !scheduler_running || critical_nesting > 0 )
+    {
+        yield_pending = true;
+        return;
+    }
+
+    yield_pending = false;
+    switch_context();
+}
+
+void vPortEnterCritical( void )
+{
+    critical_nesting++;
+}
+
+void vPortExitCritical( void )
+{
+    configASSERT( critical_nesting > 0 );
+    critical_nesting--;
+
+    if( critical_nesting == 0 && yield_pending )
+    {
+        vPortYield();
+    }
+}
+
+void vPortAdvanceTime( void )
+{
+    vPortEnterCritical();
+    if( xTaskIncrementTick() != pdFALSE )
+    {
+        vPortYield();
+    }
+    vPortExitCritical();
+}
@@ -0,0 +1,347 @@
+// Replay a flight recorder dump (SVC_recorder.h) into a host build of the application.
+//
+//     replay [--burst] capture.txt
+//
+// The application is initialized as on the target (`app_init()`), so AO ids match the ids in the dump. Every
+// recorded post is then issued again through `ao_post_lane()` from a task of its own, at the highest priority,
+// keeping the recorded inter-arrival times (or back to back with --burst). Overflow policies, coalescing, hosting
+// and dispatch run the real code, and time is virtual (see port/port.c), so a replay takes no wall-clock time and
+// always takes the same path. The AO metrics are printed once every queue drained.
+
+// ------ inclusions ---------------------------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app.h"
+#include "HAL_cycles.h"
+#include "SVC_ao.h"
+#include "SVC_ao_metrics.h"
+#include "SVC_format.h"
+#include "SVC_recorder.h"
+
+/// | Private typedef -----------------------------------------------------------
+
+/// @brief A recorded post.
+typedef struct
+{
+    uint32_t timestamp;                     ///< Cycle counter of the target right before the post.
+    uint8_t destination;                    ///< Id of the destination AO.
+    uint8_t lane;                           ///< Destination lane. One of AOLane.
+    uint8_t size;                           ///< Event size, in bytes. Saturated at UINT8_MAX.
+    uint8_t payload[RECORDER_PAYLOAD_SIZE]; ///< First bytes of the event.
+} ReplayEvent;
+
+/// @brief A recorded AO.
+typedef struct
+{
+    bool present;
+    unsigned long event_size;
+    char name[configMAX_TASK_NAME_LEN];
+} ReplayAO;
+
+/// @brief Replay statistics.
+typedef struct
+{
+    uint32_t posted;  ///< Events accepted by their AO.
+    uint32_t refused; ///< Events refused by their AO (full queue, empty event pool...).
+    uint32_t skipped; ///< Events whose AO does not exist or does not match the dump, or whose payload is truncated.
+    uint32_t rebased; ///< Events whose deadline was moved to the replay time line.
+} ReplayStats;
+
+/// | Private define ------------------------------------------------------------
+
+#define REPLAY_DUMP_VERSION 1
+#define REPLAY_MAX_EVENTS 1024
+#define REPLAY_MAX_AOS 32
+#define REPLAY_LINE_SIZE 512
+
+#define REPLAY_STACK_DEPTH (4 * configMINIMAL_STACK_SIZE)
+#define REPLAY_PRIORITY (configMAX_PRIORITIES - 1)
+
+/// @brief Longest wait for the AOs to drain once every event was posted, in ticks.
+#define REPLAY_DRAIN_TIMEOUT_TICKS pdMS_TO_TICKS(10000)
+
+/// | Private macro -------------------------------------------------------------
+/// | Private variables ---------------------------------------------------------
+
+/// @brief The last complete dump of the capture.
+static ReplayEvent events[REPLAY_MAX_EVENTS];
+static size_t events_count = 0;
+static ReplayAO aos[REPLAY_MAX_AOS];
+static unsigned long dump_hz = 0;
+
+static bool burst = false;
+
+static StackType_t replay_stack[REPLAY_STACK_DEPTH];
+static StaticTask_t replay_task_buffer;
+
+/// | Private function prototypes -----------------------------------------------
+
+/// @brief Parse the last complete dump of a capture. Anything else in the capture (printf lines, log frames) is
+///        ignored, as `recorder.py` does.
+/// @param path Capture file.
+/// @return true if a complete dump was found.
+static bool parse(const char* path);
+
+/// @brief Parse a hexadecimal payload, up to RECORDER_PAYLOAD_SIZE bytes.
+static void parse_payload(const char* hex, uint8_t* const payload);
+
+/// @brief true if the AO of the host build is the AO of the dump.
+static bool matches(ActiveObject* ao, const uint8_t id);
+
+/// @brief Move the deadline carried by an event from the target time line to the replay one. The deadline is found
+///        through the deadline handler of the AO: it is the only aligned word of the event equal to it.
+/// @return true if the deadline was moved.
+static bool rebase_deadline(ActiveObject* ao, const ReplayEvent* const event, uint8_t* const payload);
+
+/// @brief Microseconds of a span of target cycles.
+static uint64_t us_of(const uint32_t cycles);
+
+/// @brief Post the whole dump, then wait for the AOs to drain and report.
+static void replay_task(void* parameters);
+
+/// | Private functions ---------------------------------------------------------
+
+static void parse_payload(const char* hex, uint8_t* const payload)
+{
+    memset(payload, 0, RECORDER_PAYLOAD_SIZE);
+    for (size_t i = 0; i < RECORDER_PAYLOAD_SIZE && hex[2 * i] && hex[2 * i + 1]; i++) {
+        unsigned int byte = 0;
+        if (sscanf(&hex[2 * i], "%2x", &byte) != 1) {
+            break;
+        }
+        payload[i] = (uint8_t) byte;
+    }
+}
+
+static bool parse(const char* path)
+{
+    FILE* const CAPTURE = fopen(path, "r");
+    if (!CAPTURE) {
+        return false;
+    }
+
+    // Records of the dump being read: they only replace the complete dump once its #END shows up
+    static ReplayEvent pending[REPLAY_MAX_EVENTS];
+    static ReplayAO pending_aos[REPLAY_MAX_AOS];
+    size_t pending_count = 0;
+    unsigned long pending_hz = 0;
+    bool in_dump = false;
+    bool complete = false;
+
+    char line[REPLAY_LINE_SIZE];
+    while (fgets(line, sizeof(line), CAPTURE)) {
+        // The header may follow binary log frames on the same line (fault dumps share the log UART)
+        const char* text = strstr(line, "#REC");
+        if (!text) {
+            text = line;
+        }
+
+        unsigned int version = 0;
+        unsigned long available = 0;
+        if (sscanf(text, "#REC %u %lu %lu", &version, &pending_hz, &available) == 3) {
+            if (version != REPLAY_DUMP_VERSION) {
+                format_printf("[replay] %s: dump version %u not supported (expected %u)\n", path, version,
+                        REPLAY_DUMP_VERSION);
+                fclose(CAPTURE);
+                exit(EXIT_FAILURE);
+            }
+            memset(pending_aos, 0, sizeof(pending_aos));
+            pending_count = 0;
+            in_dump = true;
+            continue;
+        }
+        if (!in_dump) {
+            continue;
+        }
+
+        unsigned int id = 0;
+        unsigned long event_size = 0;
+        char name[REPLAY_LINE_SIZE];
+        if (sscanf(text, "#AO %u %lu %s", &id, &event_size, name) == 3) {
+            if (id < REPLAY_MAX_AOS) {
+                pending_aos[id].present = true;
+                pending_aos[id].event_size = event_size;
+                strncpy(pending_aos[id].name, name, sizeof(pending_aos[id].name) - 1);
+            }
+            continue;
+        }
+
+        unsigned long sequence = 0;
+        unsigned long timestamp = 0;
+        unsigned int source = 0;
+        unsigned int destination = 0;
+        unsigned int lane = 0;
+        unsigned int size = 0;
+        unsigned long event_digest = 0;
+        char payload[REPLAY_LINE_SIZE];
+        if (sscanf(text, "R %lu %lu %u %u %u %u %lx %s", &sequence, &timestamp, &source, &destination, &lane, &size,
+                &event_digest, payload) == 8) {
+            if (pending_count < REPLAY_MAX_EVENTS) {
+                ReplayEvent* const EVENT = &pending[pending_count++];
+                EVENT->timestamp = (uint32_t) timestamp;
+                EVENT->destination = (uint8_t) destination;
+                EVENT->lane = (uint8_t) lane;
+                EVENT->size = (uint8_t) size;
+                parse_payload(payload, EVENT->payload);
+            }
+            continue;
+        }
+
+        if (strncmp(text, "#END", 4) == 0) {
+            memcpy(events, pending, pending_count * sizeof(ReplayEvent));
+            memcpy(aos, pending_aos, sizeof(aos));
+            events_count = pending_count;
+            dump_hz = pending_hz;
+            in_dump = false;
+            complete = true;
+        }
+    }
+
+    fclose(CAPTURE);
+    return complete && dump_hz > 0;
+}
+
+static bool matches(ActiveObject* ao, const uint8_t id)
+{
+    return ao && id < REPLAY_MAX_AOS && aos[id].present && aos[id].event_size == ao->event_size &&
+            strncmp(aos[id].name, ao->name ? ao->name : "?", sizeof(aos[id].name) - 1) == 0;
+}
+
+static uint64_t us_of(const uint32_t cycles)
+{
+    return ((uint64_t) cycles * 1000000U) / dump_hz;
+}
+
+static bool rebase_deadline(ActiveObject* ao, const ReplayEvent* const event, uint8_t* const payload)
+{
+    if (!ao->deadline) {
+        return false;
+    }
+
+    const AODeadline DEADLINE = ao->deadline(event->payload);
+    if (DEADLINE == AO_DEADLINE_NONE) {
+        return false;
+    }
+
+    size_t found = SIZE_MAX;
+    for (size_t offset = 0; offset + sizeof(AODeadline) <= ao->event_size; offset += sizeof(AODeadline)) {
+        AODeadline word;
+        memcpy(&word, &event->payload[offset], sizeof(word));
+        if (word != DEADLINE) {
+            continue;
+        }
+        if (found != SIZE_MAX) {
+            return false; // Ambiguous: keep the event as recorded
+        }
+        found = offset;
+    }
+    if (found == SIZE_MAX) {
+        return false;
+    }
+
+    // Same slack as on the target. Deadlines already missed when posted stay missed.
+    const int32_t SLACK = (int32_t)(DEADLINE - event->timestamp);
+    const uint32_t SLACK_US = SLACK > 0 ? (uint32_t) us_of((uint32_t) SLACK) : 0;
+    const AODeadline REBASED = ao_deadline_in(cycles_from_us(SLACK_US));
+    memcpy(&payload[found], &REBASED, sizeof(REBASED));
+    return true;
+}
+
+static void replay_task(void* parameters)
+{
+    (void) parameters;
+    ReplayStats stats = {0};
+    uint64_t pending_us = 0;
+
+    for (size_t i = 0; i < events_count; i++) {
+        const ReplayEvent* const EVENT = &events[i];
+        ActiveObject* const AO = ao_registry_get(EVENT->destination);
+
+        // Ticks are coarser than the recorded spacing, so the remainder is carried over to the next post
+        if (!burst && i > 0) {
+            pending_us += us_of(EVENT->timestamp - events[i - 1].timestamp);
+            const TickType_t TICKS = (TickType_t)((pending_us * configTICK_RATE_HZ) / 1000000U);
+            if (TICKS > 0) {
+                vTaskDelay(TICKS);
+                pending_us -= ((uint64_t) TICKS * 1000000U) / configTICK_RATE_HZ;
+            }
+        }
+
+        // Bigger events only kept their first bytes
+        if (!matches(AO, EVENT->destination) || EVENT->size != AO->event_size || EVENT->size > RECORDER_PAYLOAD_SIZE) {
+            format_printf("[replay] Event %lu skipped: AO %u does not match the dump, or the event is truncated\n",
+                    (unsigned long) i, EVENT->destination);
+            stats.skipped++;
+            continue;
+        }
+
+        uint8_t payload[RECORDER_PAYLOAD_SIZE];
+        memcpy(payload, EVENT->payload, sizeof(payload));
+        if (rebase_deadline(AO, EVENT, payload)) {
+            stats.rebased++;
+        }
+
+        if (ao_post_lane(AO, payload, (AOLane) EVENT->lane, 0)) {
+            stats.posted++;
+        } else {
+            stats.refused++;
+        }
+    }
+
+    // Let every AO dispatch what it was given before reporting
+    for (TickType_t waited = 0; waited < REPLAY_DRAIN_TIMEOUT_TICKS; waited++) {
+        UBaseType_t pending = 0;
+        for (ActiveObject* ao = ao_registry_get(0); ao; ao = ao_registry_get(ao->id + 1)) {
+            pending += ao_pending_events(ao);
+        }
+        if (pending == 0) {
+            break;
+        }
+        vTaskDelay(1);
+    }
+
+    ao_metrics_print();
+    format_printf("[replay] %lu posted, %lu refused, %lu skipped, %lu deadlines rebased\n",
+            (unsigned long) stats.posted, (unsigned long) stats.refused, (unsigned long) stats.skipped,
+            (unsigned long) stats.rebased);
+
+    exit(stats.skipped == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--burst") == 0) {
+            burst = true;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (!path) {
+        format_printf("Usage: %s [--burst] capture.txt\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!parse(path)) {
+        format_printf("[replay] %s: no complete recorder dump found\n", path);
+        return EXIT_FAILURE;
+    }
+    format_printf("[replay] %lu events at %lu Hz from %s\n", (unsigned long) events_count, dump_hz, path);
+
+    app_init();
+
+    TaskHandle_t task = xTaskCreateStatic(replay_task, "Replay", REPLAY_STACK_DEPTH, NULL, REPLAY_PRIORITY,
+            replay_stack, &replay_task_buffer);
+    configASSERT(task);
+
+    vTaskStartScheduler();
+    return EXIT_FAILURE;
+}
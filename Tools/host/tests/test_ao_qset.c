@@ -0,0 +1,138 @@
+// Queue set host (SVC_ao_qset.h): a signal given while a hosted AO_OVERFLOW_DROP_OLDEST AO is full must neither be
+// lost nor overflow the set when the next post drops the oldest event.
+
+// ------ inclusions ---------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+
+#include "SVC_ao.h"
+#include "SVC_ao_qset.h"
+
+/// | Private typedef -----------------------------------------------------------
+/// | Private define ------------------------------------------------------------
+
+#define QUEUE_LENGTH 2
+#define SET_LENGTH (QUEUE_LENGTH + 1)
+#define STACK_DEPTH (2 * configMINIMAL_STACK_SIZE)
+
+/// | Private macro -------------------------------------------------------------
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            exit(EXIT_FAILURE);                                                 \
+        }                                                                       \
+    } while (0)
+
+/// | Private variables ---------------------------------------------------------
+
+static AOQueueSet host;
+static uint8_t host_storage[AO_QSET_STORAGE_SIZE(SET_LENGTH)];
+static StackType_t host_stack[STACK_DEPTH];
+static StaticTask_t host_task_buffer;
+
+static ActiveObject ao;
+static uint8_t queue_storage[AO_QUEUE_STORAGE_SIZE(sizeof(uint8_t), QUEUE_LENGTH)];
+
+static SemaphoreHandle_t signal;
+static StaticSemaphore_t signal_buffer;
+
+static StackType_t test_stack[STACK_DEPTH];
+static StaticTask_t test_task_buffer;
+
+static uint8_t dispatched[2 * QUEUE_LENGTH];
+static size_t dispatched_count = 0;
+static size_t signals_count = 0;
+
+/// | Private function prototypes -----------------------------------------------
+
+static void dispatch(ActiveObject* ao, const void* event);
+static void on_signal(void* context);
+static void test_task(void* parameters);
+
+/// | Private functions ---------------------------------------------------------
+
+static void dispatch(ActiveObject* ao, const void* event)
+{
+    (void) ao;
+    CHECK(dispatched_count < sizeof(dispatched));
+    dispatched[dispatched_count++] = *(const uint8_t*) event;
+}
+
+static void on_signal(void* context)
+{
+    (void) context;
+    signals_count++;
+}
+
+static void test_task(void* parameters)
+{
+    (void) parameters;
+
+    // The signal comes first, so its entry is at the front of the set when the AO drops its oldest event
+    CHECK(xSemaphoreGive(signal) == pdPASS);
+    for (uint8_t event = 1; event <= QUEUE_LENGTH + 1; event++) {
+        CHECK(ao_post(&ao, &event, 0));
+    }
+    CHECK(ao.stats[AO_LANE_NORMAL].dropped == 1);
+
+    // Once more with the set full: the signal entry has to survive a second drop too
+    const uint8_t LAST = QUEUE_LENGTH + 2;
+    CHECK(ao_post(&ao, &LAST, 0));
+
+    // Let the host drain everything
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    CHECK(signals_count == 1);
+    CHECK(dispatched_count == QUEUE_LENGTH);
+    CHECK(dispatched[0] == QUEUE_LENGTH + 1 && dispatched[1] == QUEUE_LENGTH + 2);
+    CHECK(uxQueueMessagesWaiting((QueueHandle_t) host.set) == 0);
+
+    printf("test_ao_qset: passed\n");
+    exit(EXIT_SUCCESS);
+}
+
+int main(void)
+{
+    const AOQueueSetConfig HOST_CONFIG =
+    {
+        .name = "Host",
+        .stack_depth = STACK_DEPTH,
+        .stack = host_stack,
+        .task_buffer = &host_task_buffer,
+        .priority = tskIDLE_PRIORITY + 1,
+        .policy = AO_QSET_FAIR,
+        .length = SET_LENGTH,
+        .storage = host_storage,
+    };
+    ao_qset_initialize(&host, &HOST_CONFIG);
+
+    const AOConfig AO_CONFIG =
+    {
+        .name = "ao_test",
+        .dispatch = dispatch,
+        .event_size = sizeof(uint8_t),
+        .queue_length = QUEUE_LENGTH,
+        .queue_storage = queue_storage,
+        .priority = 1,
+        .queue_set = &host,
+        .overflow_policy = AO_OVERFLOW_DROP_OLDEST,
+    };
+    ao_initialize(&ao, &AO_CONFIG);
+
+    signal = xSemaphoreCreateBinaryStatic(&signal_buffer);
+    ao_qset_add_signal(&host, signal, on_signal, NULL);
+
+    // Above the host, so every post lands before the host dispatches anything
+    TaskHandle_t task = xTaskCreateStatic(test_task, "Test", STACK_DEPTH, NULL, tskIDLE_PRIORITY + 2, test_stack,
+            &test_task_buffer);
+    CHECK(task);
+
+    vTaskStartScheduler();
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+"""Rebuild the text of deferred LOG_*() records (SVC_log.h).
+
+The target never formats nor stores the format strings: records carry the address of the string in the .log_fmt
+section of the ELF file, a cycle counter timestamp and the raw arguments. This tool reads the strings (and any
+constant string passed as a %s argument) back from the very ELF file that was flashed.
+
+    log_decode.py firmware.elf capture.bin          # capture of the log UART, e.g. from `cat /dev/ttyACM0`
+    log_decode.py firmware.elf -                    # live, from the standard input
+    log_decode.py --lz firmware.elf capture.bin     # firmware built with LOG_COMPRESSION_ENABLED
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+import lz
+
+FORMAT_SECTION = ".log_fmt"
+
+RECORD_MESSAGE = 0
+RECORD_SOURCE = 1
+RECORD_CLOCK = 2
+
+LEVELS = ("DBG", "INF", "WRN", "ERR")
+
+SOURCE_ISR_BASE = 0xF0
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+SPECIFIER = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+
+
+class Elf:
+    """Just enough of an ELF reader to look strings up by address. Handles 32 and 64-bit little-endian files."""
+
+    def __init__(self, path):
+        with open(path, "rb") as elf:
+            self.data = elf.read()
+
+        if self.data[:4] != b"\x7fELF" or self.data[5] != 1:
+            sys.exit(f"{path}: not a little-endian ELF file")
+
+        is_64 = self.data[4] == 2
+        if is_64:
+            shoff, = struct.unpack_from("<Q", self.data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x3A)
+            entry = "<IIQQQQIIQQ"
+        else:
+            shoff, = struct.unpack_from("<I", self.data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x2E)
+            entry = "<IIIIIIIIII"
+
+        headers = [struct.unpack_from(entry, self.data, shoff + i * shentsize) for i in range(shnum)]
+        names = headers[shstrndx]
+
+        # (name, address, file offset, size, flags, type)
+        self.sections = []
+        for name, kind, flags, address, offset, size, *_ in headers:
+            end = self.data.index(b"\0", names[4] + name)
+            self.sections.append((self.data[names[4] + name:end].decode(), address, offset, size, flags, kind))
+
+        self.formats = next((s for s in self.sections if s[0] == FORMAT_SECTION), None)
+        if self.formats is None:
+            sys.exit(f"{path}: no {FORMAT_SECTION} section. Was it linked with LOG_ENABLED?")
+
+    def _string_in(self, section, address):
+        _, start, offset, size, _, _ = section
+        if not start <= address < start + size:
+            return None
+        begin = offset + address - start
+        end = self.data.index(b"\0", begin)
+        return self.data[begin:end].decode(errors="replace")
+
+    def format_string(self, address):
+        return self._string_in(self.formats, address)
+
+    def constant_string(self, address):
+        for section in self.sections:
+            if section[4] & SHF_ALLOC and section[5] != SHT_NOBITS:
+                text = self._string_in(section, address)
+                if text is not None:
+                    return text
+        return f"<string 0x{address:08x}>"
+
+
+def cobs_decode(frame):
+    data = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        data += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            data.append(0)
+    return bytes(data)
+
+
+def frames(stream, decoder=None):
+    pending = bytearray()
+    while True:
+        chunk = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+        if not chunk:
+            return
+        pending += decoder.feed(chunk) if decoder else chunk
+        while b"\0" in pending:
+            frame, _, rest = pending.partition(b"\0")
+            pending = bytearray(rest)
+            if frame:
+                yield bytes(frame)
+
+
+def render(elf, format_string, args):
+    """printf() on the host: every argument is a raw 32-bit word."""
+    words = iter(args)
+
+    def substitute(match):
+        flags, width, precision, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        word = next(words, 0)
+        if conversion == "s":
+            text = elf.constant_string(word)
+            return f"%{flags}{width}{'.' + precision if precision else ''}s" % text
+        if conversion == "p":
+            return f"0x{word:08x}"
+        if conversion in "di":
+            word = word - (1 << 32) if word & 0x80000000 else word
+            conversion = "d"
+        if conversion == "c":
+            return f"%{flags}{width}c" % chr(word & 0xFF)
+        spec = f"%{flags}{width}{'.' + precision if precision else ''}{conversion}"
+        return spec % word
+
+    return SPECIFIER.sub(substitute, format_string)
+
+
+def decode(elf, stream, out, minimum=0, decoder=None):
+    hz = 0
+    names = {SOURCE_ISR_BASE | level: f"ISR{level}" for level in range(16)}
+    first = None
+    # Every task and interrupt level writes to a ring of its own, numbered on its own
+    last_sequence = {}
+
+    for frame in frames(stream, decoder):
+        record = cobs_decode(frame)
+        if record is None or len(record) < 12 or len(record) % 4:
+            print("<corrupted frame>", file=out)
+            continue
+
+        header, address, timestamp, *args = struct.unpack(f"<{len(record) // 4}I", record)
+        count = header & 0x0F
+        kind = (header >> 4) & 0x03
+        level = (header >> 6) & 0x03
+        source = (header >> 8) & 0xFF
+        sequence = header >> 16
+        if len(args) != count:
+            print("<corrupted frame>", file=out)
+            continue
+
+        if kind == RECORD_CLOCK:
+            hz = args[0]
+            continue
+        if kind == RECORD_SOURCE:
+            names[source] = struct.pack(f"<{count}I", *args).split(b"\0")[0].decode(errors="replace")
+            continue
+
+        name = names.get(source, f"src{source}")
+        last = last_sequence.get(source)
+        if last is not None and sequence != (last + 1) & 0xFFFF:
+            print(f"<{(sequence - last - 1) & 0xFFFF} records of {name} lost>", file=out)
+        last_sequence[source] = sequence
+        if level < minimum:
+            continue
+
+        if first is None:
+            first = timestamp
+        # Signed, as records of different rings can come out slightly out of order
+        elapsed = (timestamp - first) & 0xFFFFFFFF
+        elapsed -= (1 << 32) if elapsed & 0x80000000 else 0
+        stamp = f"{elapsed * 1e6 / hz:12.1f}us" if hz else f"{elapsed:12d}cy"
+
+        format_string = elf.format_string(address)
+        if format_string is None:
+            text = f"<unknown format 0x{address:08x}: is this the flashed ELF file?>"
+        else:
+            text = render(elf, format_string, args)
+        print(f"{stamp} {LEVELS[level]} [{name}] {text}", file=out, flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="ELF file of the running firmware")
+    parser.add_argument("capture", help="raw capture of the log sink, or - for the standard input")
+    parser.add_argument("--level", choices=LEVELS, default=LEVELS[0], help="hide records below this level")
+    parser.add_argument("--lz", action="store_true", help="the capture is an LZ stream (SVC_lz.h), from boot on")
+    arguments = parser.parse_args()
+
+    elf = Elf(arguments.elf)
+    minimum = LEVELS.index(arguments.level)
+    decoder = lz.Decoder() if arguments.lz else None
+    if arguments.capture == "-":
+        decode(elf, sys.stdin.buffer, sys.stdout, minimum, decoder)
+    else:
+        with open(arguments.capture, "rb") as capture:
+            decode(elf, capture, sys.stdout, minimum, decoder)
+
+
+if __name__ == "__main__":
+    main()
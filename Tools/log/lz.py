@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Host side of the LZSS stream of SVC_lz.h.
+
+    lz.py decompress stream.bin capture.bin     # - for the standard input/output
+    lz.py compress capture.bin stream.bin       # same encoder as the target, e.g. to try other window sizes
+    lz.py stats capture.bin                     # compression ratio of an uncompressed log capture
+
+log_decode.py --lz decompresses on the fly, so a compressed log can be read live.
+"""
+
+import argparse
+import sys
+
+WINDOW_BITS = 8
+LENGTH_BITS = 4
+MIN_MATCH = 2
+
+
+class Decoder:
+    """Streaming decoder: feed it any chunks of the stream and it returns the bytes they complete."""
+
+    def __init__(self, window_bits=WINDOW_BITS, length_bits=LENGTH_BITS):
+        self.window_bits = window_bits
+        self.length_bits = length_bits
+        self.history = bytearray()
+        self.bits = 0
+        self.bit_count = 0
+
+    def _take(self, count):
+        self.bit_count -= count
+        value = self.bits >> self.bit_count
+        self.bits &= (1 << self.bit_count) - 1
+        return value
+
+    def feed(self, data):
+        out = bytearray()
+        copy_bits = 1 + self.window_bits + self.length_bits
+        for byte in data:
+            self.bits = (self.bits << 8) | byte
+            self.bit_count += 8
+
+            while self.bit_count >= 9:
+                if self.bits >> (self.bit_count - 1):
+                    self._take(1)
+                    out.append(self._take(8))
+                    continue
+                if self.bit_count < copy_bits:
+                    break
+                self._take(1)
+                distance = self._take(self.window_bits)
+                length = self._take(self.length_bits) + MIN_MATCH
+                if distance == 0:
+                    # Flush marker: the rest of the byte is padding
+                    self._take(self.bit_count % 8)
+                    continue
+                start = len(self.history) + len(out) - distance
+                if start < 0:
+                    raise ValueError("copy from before the start of the stream: was it captured from the start?")
+                for i in range(length):
+                    source = start + i
+                    out.append(self.history[source] if source < len(self.history) else out[source - len(self.history)])
+
+        self.history += out
+        del self.history[:-(1 << self.window_bits)]
+        return bytes(out)
+
+
+def compress(data, window_bits=WINDOW_BITS, length_bits=LENGTH_BITS):
+    """Same choices as lz_encoder_write() followed by a single lz_encoder_flush()."""
+    max_distance = (1 << window_bits) - 1
+    max_match = MIN_MATCH + (1 << length_bits) - 1
+    bits = []
+
+    position = 0
+    while position < len(data):
+        limit = min(len(data) - position, max_match)
+        best_length, best_distance = 0, 0
+        if limit >= MIN_MATCH:
+            for candidate in range(position - 1, max(position - max_distance, 0) - 1, -1):
+                length = 0
+                while length < limit and data[candidate + length] == data[position + length]:
+                    length += 1
+                if length >= MIN_MATCH and length > best_length:
+                    best_length, best_distance = length, position - candidate
+                    if length == limit:
+                        break
+        if best_length >= MIN_MATCH:
+            bits.append(f"0{best_distance:0{window_bits}b}{best_length - MIN_MATCH:0{length_bits}b}")
+            position += best_length
+        else:
+            bits.append(f"1{data[position]:08b}")
+            position += 1
+
+    bits.append("0" * (1 + window_bits + length_bits))
+    stream = "".join(bits)
+    stream += "0" * (-len(stream) % 8)
+    return int(stream, 2).to_bytes(len(stream) // 8, "big") if stream else b""
+
+
+def open_input(path):
+    return sys.stdin.buffer if path == "-" else open(path, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--window-bits", type=int, default=WINDOW_BITS)
+    parser.add_argument("--length-bits", type=int, default=LENGTH_BITS)
+    commands = parser.add_subparsers(dest="command", required=True)
+    decompress_parser = commands.add_parser("decompress", help="rebuild the original bytes of a stream")
+    decompress_parser.add_argument("input")
+    decompress_parser.add_argument("output")
+    compress_parser = commands.add_parser("compress", help="compress a file as the target would")
+    compress_parser.add_argument("input")
+    compress_parser.add_argument("output")
+    stats_parser = commands.add_parser("stats", help="compression ratio of a file")
+    stats_parser.add_argument("input")
+    arguments = parser.parse_args()
+
+    if arguments.command == "decompress":
+        decoder = Decoder(arguments.window_bits, arguments.length_bits)
+        output = sys.stdout.buffer if arguments.output == "-" else open(arguments.output, "wb")
+        with open_input(arguments.input) as stream, output:
+            while chunk := (stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)):
+                output.write(decoder.feed(chunk))
+                output.flush()
+        return
+
+    with open_input(arguments.input) as source:
+        data = source.read()
+    compressed = compress(data, arguments.window_bits, arguments.length_bits)
+
+    if arguments.command == "compress":
+        with open(arguments.output, "wb") as output:
+            output.write(compressed)
+    else:
+        ratio = len(data) / len(compressed) if compressed else 0
+        print(f"{len(data)} -> {len(compressed)} bytes, ratio {ratio:.2f}:1 "
+              f"({8 * len(compressed) / max(len(data), 1):.2f} bits/byte)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""Decode flight recorder dumps (SVC_recorder.h).
+
+The firmware dumps the recorder in two ways:
+
+    - on demand, with the 'r' debug command: the dump is printed on the SWV console;
+    - on a failed assertion or a HardFault, over the log UART, right before halting. Capture it with any terminal,
+      e.g. picocom -b 115200 /dev/ttyACM0 --logfile capture.txt
+
+then:
+
+    recorder.py decode capture.txt             # timeline, gaps and per-AO statistics
+
+To re-post a capture into the real services, with its recorded inter-arrival times, build the host target:
+
+    cmake -S Tools/host -B build-host && cmake --build build-host
+    build-host/replay [--burst] capture.txt    # AO metrics once the replay drained
+"""
+
+import argparse
+import sys
+
+DUMP_VERSION = 1
+SOURCE_ISR = 255
+SOURCE_OTHER = 254
+CYCLES_MASK = 0xFFFFFFFF
+
+FNV_OFFSET_BASIS = 2166136261
+FNV_PRIME = 16777619
+
+
+class Dump:
+    def __init__(self):
+        self.hz = 0
+        self.aos = {}      # id -> (name, event_size)
+        self.sources = {}  # index -> name
+        self.records = []  # dicts, oldest first
+
+
+def fnv1a(data):
+    value = FNV_OFFSET_BASIS
+    for byte in data:
+        value = ((value ^ byte) * FNV_PRIME) & 0xFFFFFFFF
+    return value
+
+
+def parse(path):
+    """Parse the last complete dump found in a capture. Anything else in the capture (printf lines) is ignored."""
+    dump = None
+    last = None
+
+    with open(path, encoding="ascii", errors="replace") as capture:
+        for line in capture:
+            # The header may follow binary log frames on the same line (fault dumps share the log UART)
+            start = line.find("#REC")
+            if start > 0:
+                line = line[start:]
+
+            fields = line.split()
+            if not fields:
+                continue
+
+            if fields[0] == "#REC":
+                if int(fields[1]) != DUMP_VERSION:
+                    sys.exit(f"{path}: dump version {fields[1]} not supported (expected {DUMP_VERSION})")
+                dump = Dump()
+                dump.hz = int(fields[2])
+            elif dump is None:
+                continue
+            elif fields[0] == "#AO":
+                dump.aos[int(fields[1])] = (" ".join(fields[3:]), int(fields[2]))
+            elif fields[0] == "#SRC":
+                dump.sources[int(fields[1])] = " ".join(fields[2:])
+            elif fields[0] == "R" and len(fields) == 9:
+                dump.records.append({
+                    "sequence": int(fields[1]),
+                    "timestamp": int(fields[2]),
+                    "source": int(fields[3]),
+                    "destination": int(fields[4]),
+                    "lane": int(fields[5]),
+                    "size": int(fields[6]),
+                    "digest": int(fields[7], 16),
+                    "payload": bytes.fromhex(fields[8]),
+                })
+            elif fields[0] == "#END":
+                last = dump
+                dump = None
+
+    if last is None:
+        sys.exit(f"{path}: no complete dump found")
+    return last
+
+
+def source_name(dump, source):
+    if source == SOURCE_ISR:
+        return "ISR"
+    if source == SOURCE_OTHER:
+        return "other"
+    return dump.sources.get(source, f"src{source}")
+
+
+def ao_name(dump, destination):
+    return dump.aos.get(destination, (f"ao{destination}", 0))[0]
+
+
+def elapsed_us(dump, start, end):
+    # The cycle counter is 32 bits wide, so deltas are taken modulo 2^32
+    return ((end - start) & CYCLES_MASK) * 1e6 / dump.hz
+
+
+def decode(dump, out):
+    if not dump.records:
+        print("Empty ring", file=out)
+        return
+
+    first = dump.records[0]
+    previous = None
+    per_ao = {}
+
+    print(f"{len(dump.records)} records, cycle counter at {dump.hz} Hz", file=out)
+    print(f"{'seq':>8} {'t [us]':>12} {'dt [us]':>10}  {'source':<12} {'destination':<12} lane size payload", file=out)
+
+    for record in dump.records:
+        if previous and record["sequence"] != previous["sequence"] + 1:
+            print(f"{'':>8} -- {record['sequence'] - previous['sequence'] - 1} records lost --", file=out)
+
+        t = elapsed_us(dump, first["timestamp"], record["timestamp"])
+        dt = elapsed_us(dump, previous["timestamp"], record["timestamp"]) if previous else 0.0
+        size = record["size"]
+        kept = min(size, len(record["payload"]))
+        check = ""
+        if size <= len(record["payload"]) and fnv1a(record["payload"][:size]) != record["digest"]:
+            check = "  DIGEST MISMATCH"
+
+        print(f"{record['sequence']:>8} {t:>12.1f} {dt:>10.1f}  {source_name(dump, record['source']):<12} "
+              f"{ao_name(dump, record['destination']):<12} {record['lane']:>4} {size:>4} "
+              f"{record['payload'][:kept].hex()}{check}", file=out)
+
+        stats = per_ao.setdefault(record["destination"], {"posts": 0, "dt_min": None, "dt_max": 0.0, "last": None})
+        if stats["last"] is not None:
+            gap = elapsed_us(dump, stats["last"], record["timestamp"])
+            stats["dt_min"] = gap if stats["dt_min"] is None else min(stats["dt_min"], gap)
+            stats["dt_max"] = max(stats["dt_max"], gap)
+        stats["posts"] += 1
+        stats["last"] = record["timestamp"]
+        previous = record
+
+    print(file=out)
+    print(f"{'destination':<12} {'posts':>6} {'min gap [us]':>14} {'max gap [us]':>14}", file=out)
+    for destination, stats in sorted(per_ao.items()):
+        dt_min = stats["dt_min"] if stats["dt_min"] is not None else 0.0
+        print(f"{ao_name(dump, destination):<12} {stats['posts']:>6} {dt_min:>14.1f} {stats['dt_max']:>14.1f}",
+              file=out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    decode_parser = commands.add_parser("decode", help="print the captured timeline")
+    decode_parser.add_argument("capture")
+
+    arguments = parser.parse_args()
+    dump = parse(arguments.capture)
+
+    decode(dump, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()